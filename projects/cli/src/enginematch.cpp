@@ -17,6 +17,10 @@
 
 #include "enginematch.h"
 #include <QMultiMap>
+#include <QTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
 #include <chessplayer.h>
 #include <playerbuilder.h>
 #include <chessgame.h>
@@ -24,6 +28,9 @@
 #include <tournament.h>
 #include <gamemanager.h>
 #include <sprt.h>
+#include <tournamentmetrics.h>
+#include <board/syzygytablebase.h>
+#include <jsonserializer.h>
 
 
 EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
@@ -32,11 +39,15 @@ EngineMatch::EngineMatch(Tournament* tournament, QObject* parent)
 	  m_debug(false),
 	  m_ratingInterval(0),
 	  m_outcomeInterval(0),
-	  m_bookMode(OpeningBook::Ram)
+	  m_bookMode(OpeningBook::Ram),
+	  m_metricsFormat(JsonLines),
+	  m_metricsTimer(new QTimer(this))
 {
 	Q_ASSERT(tournament != nullptr);
 
 	m_startTime.start();
+	connect(m_metricsTimer, SIGNAL(timeout()),
+		this, SLOT(writeMetrics()));
 }
 
 EngineMatch::~EngineMatch()
@@ -77,6 +88,9 @@ void EngineMatch::start()
 		connect(m_tournament->gameManager(), SIGNAL(debugMessage(QString)),
 			this, SLOT(print(QString)));
 
+	if (!m_metricsFileName.isEmpty())
+		m_metricsTimer->start();
+
 	QMetaObject::invokeMethod(m_tournament, "start", Qt::QueuedConnection);
 }
 
@@ -107,6 +121,17 @@ void EngineMatch::setBookMode(OpeningBook::AccessMode mode)
 	m_bookMode = mode;
 }
 
+void EngineMatch::setMetricsFile(const QString& fileName,
+				 MetricsFormat format,
+				 int interval)
+{
+	Q_ASSERT(interval > 0);
+
+	m_metricsFileName = fileName;
+	m_metricsFormat = format;
+	m_metricsTimer->setInterval(interval * 1000);
+}
+
 void EngineMatch::onGameStarted(ChessGame* game, int number)
 {
 	Q_ASSERT(game != nullptr);
@@ -159,10 +184,22 @@ void EngineMatch::onTournamentFinished()
 	||  m_tournament->finishedGameCount() % m_outcomeInterval != 0)
 		printOutcomes();
 
+	const quint64 tbHits = SyzygyTablebase::cacheHits();
+	const quint64 tbMisses = SyzygyTablebase::cacheMisses();
+	if (tbHits + tbMisses > 0)
+		qInfo("Tablebase cache: %llu hits, %llu misses",
+		      tbHits, tbMisses);
+
 	QString error = m_tournament->errorString();
 	if (!error.isEmpty())
 		qWarning("%s", qUtf8Printable(error));
 
+	if (!m_metricsFileName.isEmpty())
+	{
+		m_metricsTimer->stop();
+		writeMetrics();
+	}
+
 	qInfo("Finished match");
 	connect(m_tournament->gameManager(), SIGNAL(finished()),
 		this, SIGNAL(finished()));
@@ -183,3 +220,47 @@ void EngineMatch::printOutcomes()
 {
 	qInfo("%s", qUtf8Printable(m_tournament->outcomes()));
 }
+
+void EngineMatch::writeMetrics()
+{
+	const TournamentMetrics* metrics = m_tournament->metrics();
+
+	// A Prometheus text file is replaced as a whole so that scrapers
+	// never see a partial file, JSON lines are appended
+	if (m_metricsFormat == Prometheus)
+	{
+		QSaveFile file(m_metricsFileName);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			qWarning("Can't open metrics file %s",
+				 qUtf8Printable(m_metricsFileName));
+			return;
+		}
+		file.write(metrics->toPrometheus().toUtf8());
+		file.commit();
+		return;
+	}
+
+	QFile file(m_metricsFileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+	{
+		qWarning("Can't open metrics file %s",
+			 qUtf8Printable(m_metricsFileName));
+		return;
+	}
+
+	QString json;
+	QTextStream stream(&json);
+	JsonSerializer serializer(metrics->toVariant());
+	if (!serializer.serialize(stream))
+	{
+		qWarning("%s", qUtf8Printable(serializer.errorString()));
+		return;
+	}
+	stream.flush();
+
+	// Strings have their line breaks and tabs escaped, so dropping
+	// the indentation leaves one object per line
+	json.remove('\n').remove('\t');
+	file.write(json.toUtf8() + '\n');
+}
@@ -25,6 +25,7 @@
 #include <QElapsedTimer>
 #include <openingbook.h>
 
+class QTimer;
 class ChessGame;
 class OpeningBook;
 class Tournament;
@@ -35,6 +36,12 @@ class EngineMatch : public QObject
 	Q_OBJECT
 
 	public:
+		enum MetricsFormat
+		{
+			JsonLines,
+			Prometheus
+		};
+
 		EngineMatch(Tournament* tournament, QObject* parent = nullptr);
 		virtual ~EngineMatch();
 
@@ -43,6 +50,9 @@ class EngineMatch : public QObject
 		void setRatingInterval(int interval);
 		void setOutcomeInterval(int interval);
 		void setBookMode(OpeningBook::AccessMode mode);
+		void setMetricsFile(const QString& fileName,
+				    MetricsFormat format,
+				    int interval);
 
 		void start();
 		void stop();
@@ -55,6 +65,7 @@ class EngineMatch : public QObject
 		void onGameFinished(ChessGame* game, int number);
 		void onTournamentFinished();
 		void print(const QString& msg);
+		void writeMetrics();
 
 	private:
 		void printRanking();
@@ -67,6 +78,9 @@ class EngineMatch : public QObject
 		OpeningBook::AccessMode m_bookMode;
 		QMap<QString, OpeningBook*> m_books;
 		QElapsedTimer m_startTime;
+		QString m_metricsFileName;
+		MetricsFormat m_metricsFormat;
+		QTimer* m_metricsTimer;
 };
 
 #endif // ENGINEMATCH_H
@@ -33,11 +33,13 @@
 #include <gamemanager.h>
 #include <tournament.h>
 #include <tournamentfactory.h>
+#include <spsatournament.h>
 #include <board/boardfactory.h>
 #include <enginefactory.h>
 #include <enginetextoption.h>
 #include <openingsuite.h>
 #include <sprt.h>
+#include <bookbuilder.h>
 #include <board/syzygytablebase.h>
 #include <board/result.h>
 
@@ -48,12 +50,15 @@
 namespace {
 
 EngineMatch* s_match = nullptr;
+BookBuilder* s_bookBuilder = nullptr;
 
 void sigintHandler(int param)
 {
 	Q_UNUSED(param);
 	if (s_match != nullptr)
 		s_match->stop();
+	else if (s_bookBuilder != nullptr)
+		s_bookBuilder->cancel();
 	else
 		abort();
 }
@@ -245,6 +250,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-each", QVariant::StringList, 1);
 	parser.addOption("-variant", QVariant::String, 1, 1);
 	parser.addOption("-concurrency", QVariant::Int, 1, 1);
+	parser.addOption("-enginepool", QVariant::Int, 1, 1);
+	parser.addOption("-gamethreads", QVariant::String, 1, 1);
 	parser.addOption("-draw", QVariant::StringList);
 	parser.addOption("-resign", QVariant::StringList);
 	parser.addOption("-maxmoves", QVariant::Int, 1, 1);
@@ -255,8 +262,10 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	parser.addOption("-games", QVariant::Int, 1, 1);
 	parser.addOption("-rounds", QVariant::Int, 1, 1);
 	parser.addOption("-sprt", QVariant::StringList);
+	parser.addOption("-tune", QVariant::StringList, 1, -1, true);
 	parser.addOption("-ratinginterval", QVariant::Int, 1, 1);
 	parser.addOption("-outcomeinterval", QVariant::Int, 1, 1);
+	parser.addOption("-metrics", QVariant::StringList, 1, 3);
 	parser.addOption("-resultformat", QVariant::String, 1, 1);
 	parser.addOption("-debug", QVariant::Bool, 0, 0);
 	parser.addOption("-openings", QVariant::StringList);
@@ -324,6 +333,24 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 			if (ok)
 				manager->setConcurrency(value.toInt());
 		}
+		else if (name == "-enginepool")
+		{
+			int size = value.toInt(&ok);
+			ok = ok && size >= 0;
+			if (ok)
+				manager->setPlayerPoolSize(size);
+		}
+		else if (name == "-gamethreads")
+		{
+			int count = -1;
+			if (value.toString() != "auto")
+			{
+				count = value.toString().toInt(&ok);
+				ok = ok && count > 0;
+			}
+			if (ok)
+				manager->setWorkerThreadCount(count);
+		}
 		// Threshold for draw adjudication
 		else if (name == "-draw")
 		{
@@ -414,16 +441,50 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// SPRT-based stopping rule
 		else if (name == "-sprt")
 		{
-			QMap<QString, QString> params = option.toMap("elo0|elo1|alpha|beta");
+			QMap<QString, QString> params =
+				option.toMap("elo0|elo1|alpha|beta|model=trinomial");
 			bool sprtOk[4];
 			double elo0 = params["elo0"].toDouble(sprtOk);
 			double elo1 = params["elo1"].toDouble(sprtOk + 1);
 			double alpha = params["alpha"].toDouble(sprtOk + 2);
 			double beta = params["beta"].toDouble(sprtOk + 3);
 
+			Sprt::Model model = Sprt::Trinomial;
+			if (params["model"] == "pentanomial")
+				model = Sprt::Pentanomial;
+			else if (params["model"] != "trinomial")
+			{
+				qWarning("Invalid SPRT model: %s",
+					 qUtf8Printable(params["model"]));
+				sprtOk[0] = false;
+			}
+
 			ok = (sprtOk[0] && sprtOk[1] && sprtOk[2] && sprtOk[3]);
 			if (ok)
-				tournament->sprt()->initialize(elo0, elo1, alpha, beta);
+				tournament->sprt()->initialize(elo0, elo1, alpha, beta,
+							       model);
+		}
+		// SPSA parameter to tune
+		else if (name == "-tune")
+		{
+			auto spsa = qobject_cast<SpsaTournament*>(tournament);
+			QMap<QString, QString> params =
+				option.toMap("name|start|min|max|c|r=0.002");
+			bool tuneOk[5];
+			double start = params["start"].toDouble(tuneOk);
+			double min = params["min"].toDouble(tuneOk + 1);
+			double max = params["max"].toDouble(tuneOk + 2);
+			double c = params["c"].toDouble(tuneOk + 3);
+			double r = params["r"].toDouble(tuneOk + 4);
+
+			ok = (spsa != nullptr && !params["name"].isEmpty()
+			      && tuneOk[0] && tuneOk[1] && tuneOk[2]
+			      && tuneOk[3] && tuneOk[4] && min <= max && c > 0);
+			if (spsa == nullptr)
+				qWarning("Option -tune requires the spsa tournament type");
+			if (ok)
+				spsa->addParameter(params["name"], start,
+						   min, max, c, r);
 		}
 		// Interval for rating list updates
 		else if (name == "-ratinginterval")
@@ -431,6 +492,28 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		// Interval for outcome updates
 		else if (name == "-outcomeinterval")
 			match->setOutcomeInterval(value.toInt());
+		// Periodic throughput and latency statistics
+		else if (name == "-metrics")
+		{
+			QMap<QString, QString> params =
+				option.toMap("file|format=json|interval=10");
+			int interval = params["interval"].toInt(&ok);
+			ok = ok && interval > 0 && !params["file"].isEmpty();
+
+			EngineMatch::MetricsFormat format = EngineMatch::JsonLines;
+			if (params["format"] == "prometheus")
+				format = EngineMatch::Prometheus;
+			else if (params["format"] != "json")
+			{
+				qWarning("Invalid metrics format: %s",
+					 qUtf8Printable(params["format"]));
+				ok = false;
+			}
+
+			if (ok)
+				match->setMetricsFile(params["file"], format,
+						      interval);
+		}
 		// Format of the result list
 		else if (name == "-resultformat")
 		{
@@ -523,7 +606,7 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 								       format,
 								       order,
 								       start - 1);
-				if (order == OpeningSuite::RandomOrder)
+				if (order == OpeningSuite::RandomOrder || start > 1)
 					qInfo("Indexing opening suite...");
 				ok = suite->initialize();
 				if (ok)
@@ -539,6 +622,8 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 				match->setBookMode(OpeningBook::Ram);
 			else if (val == "disk")
 				match->setBookMode(OpeningBook::Disk);
+			else if (val == "mapped")
+				match->setBookMode(OpeningBook::Mapped);
 			else
 				ok = false;
 		}
@@ -696,6 +781,33 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 		ok = false;
 	}
 
+	// Game pairs need both colors of the same opening
+	if (tournament->sprt()->model() == Sprt::Pentanomial
+	&&  (tournament->openingRepetitions() % 2 != 0
+	     || !tournament->swapSides()))
+	{
+		qWarning("The pentanomial SPRT model needs an even number of "
+			 "opening repetitions and side swapping, see -repeat "
+			 "and -noswap");
+		ok = false;
+	}
+
+	auto spsa = qobject_cast<SpsaTournament*>(tournament);
+	if (spsa != nullptr && spsa->parameterCount() == 0)
+	{
+		qWarning("The spsa tournament needs at least one -tune option");
+		ok = false;
+	}
+
+	// Both games of an SPSA iteration use the same opening
+	if (spsa != nullptr
+	&&  (spsa->openingRepetitions() % 2 != 0 || !spsa->swapSides()))
+	{
+		qWarning("The spsa tournament needs an even number of opening "
+			 "repetitions and side swapping, see -repeat and -noswap");
+		ok = false;
+	}
+
 	if (!ok)
 	{
 		delete match;
@@ -708,6 +820,79 @@ EngineMatch* parseMatch(const QStringList& args, QObject* parent)
 	return match;
 }
 
+int makeBook(const QStringList& args)
+{
+	QString fileName;
+	QStringList pgnFiles;
+	int depth = 20;
+	int threads = 0;
+	qint64 memory = 0;
+
+	for (const auto& arg : args)
+	{
+		QString name = arg.section('=', 0, 0);
+		QString val = arg.section('=', 1);
+		bool ok = true;
+
+		if (name == "file")
+			fileName = val;
+		else if (name == "pgnin")
+			pgnFiles.append(val);
+		else if (name == "depth")
+			depth = val.toInt(&ok);
+		else if (name == "threads")
+			threads = val.toInt(&ok);
+		else if (name == "memory")
+			memory = val.toLongLong(&ok) * 1024 * 1024;
+		else
+		{
+			qWarning() << "Invalid makebook option:" << name;
+			return 1;
+		}
+
+		if (!ok)
+		{
+			qWarning() << "Invalid value for makebook option"
+				   << name << ":" << val;
+			return 1;
+		}
+	}
+
+	if (fileName.isEmpty() || pgnFiles.isEmpty() || depth <= 0)
+	{
+		qWarning("Usage: -makebook file=BOOK pgnin=FILE... [depth=N] "
+			 "[threads=N] [memory=MB]");
+		return 1;
+	}
+
+	BookBuilder builder(depth);
+	if (threads > 0)
+		builder.setThreadCount(threads);
+	if (memory > 0)
+		builder.setMemoryLimit(memory);
+	for (const auto& pgnFile : qAsConst(pgnFiles))
+		builder.addFile(pgnFile);
+
+	QTextStream out(stdout);
+	QObject::connect(&builder, &BookBuilder::mergeStarted, [&]()
+	{
+		out << "Parsed " << builder.gameCount() << " games, "
+		    << "writing " << fileName << '\n';
+		out.flush();
+	});
+
+	s_bookBuilder = &builder;
+	const bool ok = builder.build(fileName);
+	s_bookBuilder = nullptr;
+
+	if (!ok)
+	{
+		qWarning() << builder.errorString();
+		return 1;
+	}
+	return 0;
+}
+
 } // anonymous namespace
 
 int main(int argc, char* argv[])
@@ -758,6 +943,12 @@ int main(int argc, char* argv[])
 				out << file.readAll();
 			return 0;
 		}
+		else if (arg == "--makebook" || arg == "-makebook")
+		{
+			// The options are the arguments after -makebook
+			QStringList args = arguments.mid(arguments.indexOf(arg) + 1);
+			return makeBook(args);
+		}
 	}
 
 	s_match = parseMatch(arguments, &app);
@@ -48,7 +48,8 @@ BoardScene::BoardScene(QObject* parent)
 	  m_anim(nullptr),
 	  m_renderer(new QSvgRenderer(QString(":/default.svg"), this)),
 	  m_highlightPiece(nullptr),
-	  m_moveArrows(nullptr)
+	  m_moveArrows(nullptr),
+	  m_lightweight(false)
 {
 }
 
@@ -80,6 +81,16 @@ void BoardScene::setBoard(Chess::Board* board)
 	m_board = board;
 }
 
+bool BoardScene::isLightweight() const
+{
+	return m_lightweight;
+}
+
+void BoardScene::setLightweight(bool enabled)
+{
+	m_lightweight = enabled;
+}
+
 void BoardScene::populate()
 {
 	Q_ASSERT(m_board != nullptr);
@@ -195,8 +206,12 @@ void BoardScene::flip()
 	stopAnimation();
 	m_squares->setFlipped(!m_squares->isFlipped());
 
-	QParallelAnimationGroup* group = new QParallelAnimationGroup;
-	m_anim = group;
+	QParallelAnimationGroup* group = nullptr;
+	if (!m_lightweight)
+	{
+		group = new QParallelAnimationGroup;
+		m_anim = group;
+	}
 
 	for (int y = 0; y < m_board->height(); y++)
 	{
@@ -206,7 +221,10 @@ void BoardScene::flip()
 			auto pc = m_squares->pieceAt(sq);
 			if (!pc)
 				continue;
-			group->addAnimation(pieceAnimation(pc, squarePos(sq)));
+			if (group != nullptr)
+				group->addAnimation(pieceAnimation(pc, squarePos(sq)));
+			else
+				pc->setPos(m_squares->squarePos(sq));
 		}
 	}
 
@@ -216,7 +234,8 @@ void BoardScene::flip()
 		m_moveArrows->setRotation(angle);
 	}
 
-	group->start(QAbstractAnimation::DeleteWhenStopped);
+	if (group != nullptr)
+		group->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
 void BoardScene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
@@ -373,6 +392,13 @@ void BoardScene::onGameFinished(ChessGame* game, Chess::Result result)
 	text->setPos(-x, -y);
 	text->setTransformOriginPoint(x, y);
 
+	// Leave the result on the board instead of flashing it
+	if (m_lightweight)
+	{
+		text->setScale(3.0);
+		return;
+	}
+
 	auto group = new QSequentialAnimationGroup;
 	text->setParent(group);
 	m_anim = group;
@@ -421,10 +447,14 @@ GraphicsPiece* BoardScene::createPiece(const Chess::Piece& piece)
 	if (!piece.isValid() && !piece.isWall())
 		return nullptr;
 
-	return new GraphicsPiece(piece,
-				 s_squareSize,
-				 m_board->representation(piece),
-				 m_renderer);
+	GraphicsPiece* graphicsPiece = new GraphicsPiece(piece,
+							 s_squareSize,
+							 m_board->representation(piece),
+							 m_renderer);
+	if (m_lightweight)
+		graphicsPiece->setSharedPixmap(true);
+
+	return graphicsPiece;
 }
 
 QPropertyAnimation* BoardScene::pieceAnimation(GraphicsPiece* piece,
@@ -565,12 +595,18 @@ void BoardScene::applyTransition(const Chess::BoardTransition& transition,
 	m_transition = transition;
 	m_direction = direction;
 
-	QParallelAnimationGroup* group = new QParallelAnimationGroup;
-	connect(group, SIGNAL(finished()), this, SLOT(onTransitionFinished()));
-	m_anim = group;
+	// Without animations the pieces are moved to their new squares
+	// by onTransitionFinished() right away
+	QParallelAnimationGroup* group = nullptr;
+	if (!m_lightweight)
+	{
+		group = new QParallelAnimationGroup;
+		connect(group, SIGNAL(finished()), this, SLOT(onTransitionFinished()));
+		m_anim = group;
+	}
 
 	const auto drops = transition.drops();
-	if (direction == Backward)
+	if (direction == Backward && group != nullptr)
 	{
 		for (const auto& drop : drops)
 		{
@@ -597,7 +633,8 @@ void BoardScene::applyTransition(const Chess::BoardTransition& transition,
 			piece = createPiece(m_board->pieceAt(target));
 			m_squares->setSquare(source, piece);
 		}
-		group->addAnimation(pieceAnimation(piece, squarePos(target)));
+		if (group != nullptr)
+			group->addAnimation(pieceAnimation(piece, squarePos(target)));
 	}
 
 	if (direction == Forward)
@@ -607,12 +644,17 @@ void BoardScene::applyTransition(const Chess::BoardTransition& transition,
 			addMoveArrow(m_squares->mapFromItem(m_reserve, QPointF()),
 					 m_squares->squarePos(drop.target));
 
+			if (group == nullptr)
+				continue;
 			GraphicsPiece* piece = m_reserve->piece(drop.piece);
 			group->addAnimation(pieceAnimation(piece, squarePos(drop.target)));
 		}
 	}
 
-	group->start(QAbstractAnimation::DeleteWhenStopped);
+	if (group != nullptr)
+		group->start(QAbstractAnimation::DeleteWhenStopped);
+	else
+		onTransitionFinished();
 }
 
 void BoardScene::updateMoves()
@@ -75,6 +75,19 @@ class BoardScene : public QGraphicsScene
 		 */
 		void setBoard(Chess::Board* board);
 
+		/*! Returns true if the scene is in lightweight mode. */
+		bool isLightweight() const;
+		/*!
+		 * If \a enabled is true, the scene is put in lightweight
+		 * mode, which is cheap enough for showing dozens of games
+		 * at once: pieces are painted from shared pre-rendered
+		 * pixmaps, and moves, flips and results are shown without
+		 * animations.
+		 *
+		 * This should be called before populate().
+		 */
+		void setLightweight(bool enabled);
+
 	public slots:
 		/*!
 		 * Clears the scene, creates a new board, and populates
@@ -160,6 +173,7 @@ class BoardScene : public QGraphicsScene
 		Chess::GenericMove m_promotionMove;
 		GraphicsPiece* m_highlightPiece;
 		QGraphicsItemGroup* m_moveArrows;
+		bool m_lightweight;
 		QSettings m_settings;
 };
 
@@ -18,6 +18,8 @@
 
 #include "graphicspiece.h"
 #include <QSvgRenderer>
+#include <QPainter>
+#include <QPixmapCache>
 
 
 GraphicsPiece::GraphicsPiece(const Chess::Piece& piece,
@@ -31,7 +33,8 @@ GraphicsPiece::GraphicsPiece(const Chess::Piece& piece,
 		  squareSize, squareSize),
 	  m_elementId(elementId),
 	  m_renderer(renderer),
-	  m_container(nullptr)
+	  m_container(nullptr),
+	  m_sharedPixmap(false)
 {
 	setAcceptedMouseButtons(Qt::LeftButton);
 	setCacheMode(DeviceCoordinateCache);
@@ -54,6 +57,40 @@ void GraphicsPiece::paint(QPainter* painter,
 	Q_UNUSED(option);
 	Q_UNUSED(widget);
 
+	const QRectF bounds(pictureRect());
+	if (!m_sharedPixmap)
+	{
+		m_renderer->render(painter, m_elementId, bounds);
+		return;
+	}
+
+	const QSize size(painter->deviceTransform().mapRect(bounds)
+			 .size().toSize());
+	if (size.isEmpty())
+		return;
+
+	const QString key(QString("piece:%1:%2x%3")
+			  .arg(m_elementId)
+			  .arg(size.width())
+			  .arg(size.height()));
+	QPixmap pixmap;
+	if (!QPixmapCache::find(key, &pixmap))
+	{
+		pixmap = QPixmap(size);
+		pixmap.fill(Qt::transparent);
+		QPainter pixmapPainter(&pixmap);
+		pixmapPainter.setRenderHint(QPainter::Antialiasing);
+		m_renderer->render(&pixmapPainter, m_elementId,
+				   QRectF(QPointF(0, 0), QSizeF(size)));
+		pixmapPainter.end();
+		QPixmapCache::insert(key, pixmap);
+	}
+
+	painter->drawPixmap(bounds, pixmap, QRectF(pixmap.rect()));
+}
+
+QRectF GraphicsPiece::pictureRect() const
+{
 	QRectF bounds(m_renderer->boundsOnElement(m_elementId));
 	qreal ar = bounds.width() / bounds.height();
 	qreal width = m_rect.width() * 0.8;
@@ -70,7 +107,7 @@ void GraphicsPiece::paint(QPainter* painter,
 	}
 	bounds.moveCenter(m_rect.center());
 
-	m_renderer->render(painter, m_elementId, bounds);
+	return bounds;
 }
 
 Chess::Piece GraphicsPiece::pieceType() const
@@ -88,6 +125,15 @@ void GraphicsPiece::setContainer(QGraphicsItem* item)
 	m_container = item;
 }
 
+void GraphicsPiece::setSharedPixmap(bool shared)
+{
+	m_sharedPixmap = shared;
+
+	// The shared pixmap already is a cache
+	setCacheMode(shared ? NoCache : DeviceCoordinateCache);
+	update();
+}
+
 void GraphicsPiece::restoreParent()
 {
 	if (parentItem() == nullptr && m_container != nullptr)
@@ -76,6 +76,14 @@ class GraphicsPiece : public QGraphicsObject
 		/*! Sets the container to \a item. */
 		void setContainer(QGraphicsItem* item);
 
+		/*!
+		 * If \a shared is true, the piece is painted from a pixmap
+		 * that is rendered once per piece picture and size, and
+		 * shared by all pieces. Otherwise each piece renders its
+		 * own SVG image into its item cache. The default is false.
+		 */
+		void setSharedPixmap(bool shared);
+
 	public slots:
 		/*!
 		 * Restores the parent item (container).
@@ -88,11 +96,14 @@ class GraphicsPiece : public QGraphicsObject
 		void restoreParent();
 
 	private:
+		QRectF pictureRect() const;
+
 		Chess::Piece m_piece;
 		QRectF m_rect;
 		QString m_elementId;
 		QSvgRenderer* m_renderer;
 		QGraphicsItem* m_container;
+		bool m_sharedPixmap;
 };
 
 #endif // GRAPHICSPIECE_H
@@ -158,21 +158,22 @@ void EvalWidget::onEval(const MoveEvaluation& eval)
 		nodeCount = QString::number(eval.nodeCount());
 
 	QString score = eval.scoreText();
+	const QString pv = eval.pv();
 
 	QVector<QTableWidgetItem*> items;
 	items << new QTableWidgetItem(depth)
 	      << new QTableWidgetItem(time)
 	      << new QTableWidgetItem(nodeCount)
 	      << new QTableWidgetItem(score)
-	      << new QTableWidgetItem(eval.pv());
+	      << new QTableWidgetItem(pv);
 
 	for (int i = 0; i < 4; i++)
 		items[i]->setTextAlignment(Qt::AlignVCenter | Qt::AlignRight);
 
-	if (eval.depth() != m_depth || (eval.pv() != m_pv && !m_pv.isEmpty()))
+	if (eval.depth() != m_depth || (pv != m_pv && !m_pv.isEmpty()))
 		m_pvTable->insertRow(0);
 	m_depth = eval.depth();
-	m_pv = eval.pv();
+	m_pv = pv;
 
 	for (int i = 0; i < items.size(); i++)
 		m_pvTable->setItem(0, i, items.at(i));
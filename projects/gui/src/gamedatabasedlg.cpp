@@ -30,7 +30,7 @@
 #include <pgnstream.h>
 #include <pgngame.h>
 #include <pgngameentry.h>
-#include <polyglotbook.h>
+#include <bookbuilder.h>
 
 #include "pgndatabasemodel.h"
 #include "pgngameentrymodel.h"
@@ -127,67 +127,57 @@ class BookExportTask : public ThreadedTask
 	Q_OBJECT
 
 	public:
-		BookExportTask(PgnGameIterator* it,
-			       QFile* file,
-			       int maxDepth,
+		BookExportTask(BookBuilder* builder,
+			       const QString& fileName,
+			       int gameCount,
 			       QWidget* parent);
+		virtual ~BookExportTask();
 
 	protected:
 		virtual void run();
 
 	private:
-		PgnGameIterator* m_it;
-		QFile* m_file;
-		int m_depth;
+		BookBuilder* m_builder;
+		QString m_fileName;
 };
 
-BookExportTask::BookExportTask(PgnGameIterator* it,
-			       QFile* file,
-			       int maxDepth,
+BookExportTask::BookExportTask(BookBuilder* builder,
+			       const QString& fileName,
+			       int gameCount,
 			       QWidget* parent)
 	: ThreadedTask(tr("Export Opening Book"),
-		       tr("Parsing %1 PGN games").arg(it->count()),
-		       0, it->count(),
+		       tr("Parsing %1 PGN games").arg(gameCount),
+		       0, gameCount,
 		       parent),
-	  m_it(it),
-	  m_file(file),
-	  m_depth(maxDepth)
+	  m_builder(builder),
+	  m_fileName(fileName)
 {
-	m_file->moveToThread(this);
+	// The worker threads of the builder report the progress
+	connect(m_builder, &BookBuilder::progressChanged, this, [=](int count)
+	{
+		if (cancelRequested())
+			m_builder->cancel();
+		emit progressValueChanged(count);
+	}, Qt::DirectConnection);
+	connect(m_builder, &BookBuilder::mergeStarted, this, [=]()
+	{
+		emit statusMessageChanged(tr("Writing opening book to disk"));
+	}, Qt::DirectConnection);
 }
 
-void BookExportTask::run()
+BookExportTask::~BookExportTask()
 {
-	QDataStream out(m_file);
-	PolyglotBook openingBook;
-
-	int i = 0;
-	while (m_it->hasNext())
-	{
-		bool ok;
-		PgnGame game(m_it->next(&ok, m_depth));
-
-		if (ok)
-		{
-			openingBook.import(game, m_depth);
-			if (++i % 512 == 0)
-			{
-				if (cancelRequested())
-					break;
-				emit progressValueChanged(i);
-			}
-		}
-	}
+	delete m_builder;
+}
 
-	// Write the already imported games to the book
+void BookExportTask::run()
+{
+	// The already parsed games are written to the book
 	// even if cancel was requested.
-	emit statusMessageChanged(tr("Writing opening book to disk"));
-	out << &openingBook;
-
-	delete m_it;
-	delete m_file;
+	if (!m_builder->build(m_fileName))
+		qWarning("%s", qUtf8Printable(m_builder->errorString()));
 
-	emit progressValueChanged(i);
+	emit progressValueChanged(m_builder->gameCount());
 }
 
 
@@ -335,6 +325,9 @@ GameDatabaseDialog::GameDatabaseDialog(GameDatabaseManager* dbManager, QWidget*
 	connect(ui->m_advancedSearchBtn, SIGNAL(clicked()),
 		this, SLOT(onAdvancedSearch()));
 
+	connect(ui->m_positionSearchBtn, SIGNAL(clicked()),
+		this, SLOT(onPositionSearch()));
+
 	connect(m_pgnGameEntryModel, SIGNAL(modelReset()), this,
 		SLOT(updateUi()));
 	connect(m_pgnGameEntryModel, SIGNAL(rowsInserted(const QModelIndex&, int, int)),
@@ -362,17 +355,18 @@ void GameDatabaseDialog::databaseSelectionChanged(const QItemSelection& selected
 
 	if (m_selectedDatabases.isEmpty())
 	{
-		m_pgnGameEntryModel->setEntries(QList<const PgnGameEntry*>());
+		m_pgnGameEntryModel->setDatabases(QList<const PgnDatabase*>());
 		return;
 	}
 
-	QList<const PgnGameEntry*> entries;
+	QList<const PgnDatabase*> databases;
 	QMap<int, PgnDatabase*>::const_iterator it;
 	for (it = m_selectedDatabases.constBegin(); it != m_selectedDatabases.constEnd(); ++it)
-		entries.append(it.value()->entries());
+		databases << it.value();
 
-	m_pgnGameEntryModel->setEntries(entries);
+	m_pgnGameEntryModel->setDatabases(databases);
 	ui->m_advancedSearchBtn->setEnabled(true);
+	ui->m_positionSearchBtn->setEnabled(true);
 }
 
 void GameDatabaseDialog::gameSelectionChanged(const QModelIndex& current,
@@ -479,6 +473,21 @@ void GameDatabaseDialog::onAdvancedSearch()
 	ui->m_clearBtn->setEnabled(true);
 }
 
+void GameDatabaseDialog::onPositionSearch()
+{
+	const Chess::Board* board = m_gameViewer->board();
+	if (m_game.isNull() || board == nullptr)
+		return;
+
+	PgnGameFilter filter;
+	filter.setPositionKey(board->key(), board->plyCount());
+
+	ui->m_searchEdit->setText(tr("[Position search]"));
+	ui->m_searchEdit->setEnabled(false);
+	m_pgnGameEntryModel->setFilter(filter);
+	ui->m_clearBtn->setEnabled(true);
+}
+
 int GameDatabaseDialog::databaseIndexFromGame(int game) const
 {
 	if (m_selectedDatabases.isEmpty())
@@ -529,18 +538,31 @@ void GameDatabaseDialog::createOpeningBook()
 	if (fileName.isEmpty())
 		return;
 
-	QFile* file = new QFile(fileName);
-	if (!file->open(QIODevice::WriteOnly))
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
 	{
 		QMessageBox::critical(this, tr("File Error"),
 				      tr("Error while saving file %1\n%2")
-				      .arg(fileName, file->errorString()));
-		delete file;
+				      .arg(fileName, file.errorString()));
 		return;
 	}
+	file.close();
+
+	// Collect the file positions of the games in the GUI thread
+	BookBuilder* builder = new BookBuilder(depth);
+	const int count = m_pgnGameEntryModel->entryCount();
+	for (int i = 0; i < count; i++)
+	{
+		const int dbIndex = databaseIndexFromGame(i);
+		const PgnDatabase* db = m_dbManager->databases().at(dbIndex);
+		if (db->status() != PgnDatabase::Ok)
+			continue;
+
+		const PgnGameEntry* entry = m_pgnGameEntryModel->entryAt(i);
+		builder->addGame(db->fileName(), entry->pos(), entry->lineNumber());
+	}
 
-	BookExportTask* task = new BookExportTask(new PgnGameIterator(this),
-						  file, depth, this);
+	BookExportTask* task = new BookExportTask(builder, fileName, count, this);
 	task->start();
 }
 
@@ -59,6 +59,7 @@ class GameDatabaseDialog : public QDialog
 		void updateSearch(const QString& terms = QString());
 		void onSearchTimeout();
 		void onAdvancedSearch();
+		void onPositionSearch();
 		void exportPgn(const QString& filename);
 		void createOpeningBook();
 		void copyGame();
@@ -20,9 +20,16 @@
 
 #include <QFileInfo>
 #include <QDataStream>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QSettings>
 #include <QThreadPool>
+#include <QUuid>
 
 #include <pgngameentry.h>
+#include <pgnpositionindex.h>
+#include <pgntagindex.h>
+#include <pgntagpool.h>
 
 #include "pgndatabase.h"
 #include "pgnimporter.h"
@@ -30,7 +37,65 @@
 #include "cutechessapp.h"
 
 #define GAME_DATABASE_STATE_MAGIC   0xDEADD00D
-#define GAME_DATABASE_STATE_VERSION 1
+#define GAME_DATABASE_STATE_VERSION 4
+
+namespace {
+
+/*
+ * Returns the directory of the position index files, which is
+ * created if needed.
+ */
+QString positionIndexDir()
+{
+	const QString dirName = CuteChessApplication::configPath()
+		+ QLatin1String("/positions");
+	QDir().mkpath(dirName);
+
+	return dirName;
+}
+
+/*
+ * Returns a new position index file name for an import of the PGN
+ * database \a fileName. The same file can be imported more than
+ * once, so every import gets its own index file.
+ */
+QString positionIndexFileName(const QString& fileName)
+{
+	const QByteArray path = QFileInfo(fileName).absoluteFilePath().toUtf8();
+	const QByteArray hash = QCryptographicHash::hash(
+		path, QCryptographicHash::Sha1).toHex();
+	const QString id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+
+	return positionIndexDir() + '/' + QString::fromLatin1(hash)
+		+ '-' + id + ".cpi";
+}
+
+/*
+ * Returns the name of the position index file of the PGN database
+ * \a fileName in version 3 state files, which was shared by all
+ * imports of the file.
+ */
+QString legacyPositionIndexFileName(const QString& fileName)
+{
+	const QByteArray path = QFileInfo(fileName).absoluteFilePath().toUtf8();
+	const QByteArray hash = QCryptographicHash::hash(
+		path, QCryptographicHash::Sha1).toHex();
+
+	return positionIndexDir() + '/' + QString::fromLatin1(hash) + ".cpi";
+}
+
+/*
+ * Removes the position index file \a fileName of a discarded
+ * database from a state file of version \a version.
+ */
+void removePositionIndex(const QString& fileName, quint32 version)
+{
+	// Legacy index files may belong to another import of the file
+	if (version >= 4 && !fileName.isEmpty())
+		QFile::remove(fileName);
+}
+
+} // anonymous namespace
 
 GameDatabaseManager::GameDatabaseManager(QObject* parent)
 	: QObject(parent),
@@ -71,11 +136,15 @@ bool GameDatabaseManager::writeState(const QString& fileName)
 		out << db->fileName();
 		out << db->lastModified();
 		out << db->displayName();
+		db->tagPool()->write(out);
 		out << (qint32)db->entries().count();
 
-		const auto entries = db->entries();
-		for (const PgnGameEntry* entry : entries)
-			entry->write(out);
+		const auto& entries = db->entries();
+		for (const PgnGameEntry& entry : entries)
+			entry.write(out);
+
+		db->tagIndex()->write(out);
+		out << db->positionIndex()->fileName();
 	}
 
 	m_modified = false;
@@ -107,10 +176,9 @@ bool GameDatabaseManager::readState(const QString& fileName)
 	quint32 version;
 	in >> version;
 
-	if (version < GAME_DATABASE_STATE_VERSION ||
-	    version > GAME_DATABASE_STATE_VERSION)
+	// Version 1 files store the tag values in every entry
+	if (version < 1 || version > GAME_DATABASE_STATE_VERSION)
 	{
-		// TODO: Add backward compatibility
 		qWarning("GameDatabaseManager: state file version mismatch");
 		return false;
 	}
@@ -124,6 +192,7 @@ bool GameDatabaseManager::readState(const QString& fileName)
 	QDateTime dbLastModified;
 	QString dbDisplayName;
 	QList<PgnDatabase*> readDatabases;
+	m_modified = false;
 
 	for (int i = 0; i < dbCount; i++)
 	{
@@ -131,10 +200,50 @@ bool GameDatabaseManager::readState(const QString& fileName)
 		in >> dbLastModified;
 		in >> dbDisplayName;
 
+		// Read the entries. They have to be read even if the
+		// database is discarded to get to the next database.
+		PgnDatabase* db = new PgnDatabase(dbFileName);
+		PgnTagPool* tagPool = db->tagPool();
+		bool ok = version < 2 || tagPool->read(in);
+
+		qint32 dbEntryCount = 0;
+		in >> dbEntryCount;
+
+		QVector<PgnGameEntry> entries;
+		entries.reserve(qMax(dbEntryCount, 0));
+		for (int j = 0; ok && j < dbEntryCount; j++)
+		{
+			PgnGameEntry entry(tagPool);
+			if (version < 2)
+				ok = entry.readLegacy(in);
+			else
+				ok = entry.read(in);
+			entries << entry;
+		}
+
+		db->setEntries(entries);
+		if (version >= 3)
+			ok = ok && db->tagIndex()->read(in);
+
+		QString indexFileName;
+		if (version >= 4)
+			in >> indexFileName;
+		else
+			indexFileName = legacyPositionIndexFileName(dbFileName);
+
+		if (!ok)
+		{
+			qWarning("GameDatabaseManager: corrupted state file");
+			delete db;
+			break;
+		}
+
 		// Check if the database exists
 		QFileInfo fileInfo(dbFileName);
 		if (!fileInfo.exists())
 		{
+			removePositionIndex(indexFileName, version);
+			delete db;
 			m_modified = true;
 			continue;
 		}
@@ -142,32 +251,32 @@ bool GameDatabaseManager::readState(const QString& fileName)
 		// Check if the database has been modified
 		if (fileInfo.lastModified() > dbLastModified)
 		{
+			removePositionIndex(indexFileName, version);
+			delete db;
 			m_modified = true;
 			importPgnFile(dbFileName);
 			continue;
 		}
 
-		qint32 dbEntryCount;
-		in >> dbEntryCount;
-
-		// Read the entries
-		QList<const PgnGameEntry*> entries;
-		for (int j = 0; j < dbEntryCount; j++)
-		{
-			PgnGameEntry* entry = new PgnGameEntry;
-			entry->read(in);
-			entries << entry;
-		}
+		// Older state files don't have the index
+		if (version < 3)
+			db->tagIndex()->build(*tagPool, db->entries());
 
-		PgnDatabase* db = new PgnDatabase(dbFileName);
-		db->setEntries(entries);
+		PgnPositionIndex* positionIndex = db->positionIndex();
+		if (!indexFileName.isEmpty()
+		&&  QFile::exists(indexFileName)
+		&&  positionIndex->open(indexFileName)
+		&&  positionIndex->gameCount() != db->entries().size())
+			positionIndex->close();
 		db->setLastModified(dbLastModified);
 		db->setDisplayName(dbDisplayName);
 
 		readDatabases << db;
 	}
 
-	m_modified = false;
+	// Old state files are converted to the current format
+	if (version < GAME_DATABASE_STATE_VERSION)
+		m_modified = true;
 
 	m_databases = readDatabases;
 	emit databasesReset();
@@ -178,6 +287,12 @@ bool GameDatabaseManager::readState(const QString& fileName)
 void GameDatabaseManager::importPgnFile(const QString& fileName)
 {
 	PgnImporter* pgnImporter = new PgnImporter(fileName);
+
+	const int plies = QSettings().value("database/position_index_plies",
+					    20).toInt();
+	if (plies > 0)
+		pgnImporter->setPositionIndex(positionIndexFileName(fileName),
+					      plies);
 	connect(pgnImporter, SIGNAL(databaseRead(PgnDatabase*)),
 		this, SLOT(addDatabase(PgnDatabase*)));
 
@@ -199,6 +314,14 @@ void GameDatabaseManager::addDatabase(PgnDatabase* database)
 void GameDatabaseManager::removeDatabase(int index)
 {
 	emit databaseAboutToBeRemoved(index);
+
+	PgnPositionIndex* positionIndex = m_databases.at(index)->positionIndex();
+	if (positionIndex->isOpen())
+	{
+		const QString indexFileName = positionIndex->fileName();
+		positionIndex->close();
+		QFile::remove(indexFileName);
+	}
 	m_databases.removeAt(index);
 	m_modified = true;
 }
@@ -19,10 +19,12 @@
 #include "gamewall.h"
 
 #include <QPointer>
+#include <QTimer>
 
 #include <chessplayer.h>
 #include <chessgame.h>
 #include <gamemanager.h>
+#include <board/board.h>
 
 #include "tilelayout.h"
 #include "boardview/boardscene.h"
@@ -30,6 +32,13 @@
 #include "chessclock.h"
 #include "cutechessapp.h"
 
+namespace {
+
+// Moves are shown at most this often, in milliseconds
+const int s_updateInterval = 100;
+
+} // anonymous namespace
+
 
 class GameWallWidget : public QWidget
 {
@@ -40,12 +49,19 @@ class GameWallWidget : public QWidget
 		virtual ~GameWallWidget();
 
 		void setGame(ChessGame* game);
+		void updateBoard();
+
+	private slots:
+		void onFenChanged(const QString& fenString);
+		void onMoveMade(const Chess::GenericMove& move);
+		void onGameFinished(ChessGame* game, Chess::Result result);
 
 	private:
 		ChessClock* m_clocks[2];
 		BoardScene* m_scene;
 		BoardView* m_view;
 		QPointer<ChessPlayer> m_players[2];
+		QList<Chess::GenericMove> m_pendingMoves;
 };
 
 GameWallWidget::GameWallWidget(QWidget* parent)
@@ -65,6 +81,7 @@ GameWallWidget::GameWallWidget(QWidget* parent)
 	clockLayout->insertSpacing(1, 20);
 
 	m_scene = new BoardScene(this);
+	m_scene->setLightweight(true);
 	m_view = new BoardView(m_scene);
 
 	QVBoxLayout* mainLayout = new QVBoxLayout();
@@ -81,15 +98,28 @@ GameWallWidget::~GameWallWidget()
 
 void GameWallWidget::setGame(ChessGame* game)
 {
+	m_pendingMoves.clear();
+
+	// The game's thread may be shared with other games, which are
+	// paused too while the lock is held. Only the connections and
+	// copies of the game's state are made under the lock.
+	struct ClockState
+	{
+		QString name;
+		bool infinite;
+		bool thinking;
+		int time;
+	} clocks[2];
+
 	game->lockThread();
 	connect(game, SIGNAL(fenChanged(QString)),
-		m_scene, SLOT(setFenString(QString)));
+		this, SLOT(onFenChanged(QString)));
 	connect(game, SIGNAL(moveMade(Chess::GenericMove, QString, QString)),
-		m_scene, SLOT(makeMove(Chess::GenericMove)));
+		this, SLOT(onMoveMade(Chess::GenericMove)));
 	connect(game, SIGNAL(humanEnabled(bool)),
 		m_view, SLOT(setEnabled(bool)));
 	connect(game, SIGNAL(finished(ChessGame*, Chess::Result)),
-		m_scene, SLOT(onGameFinished(ChessGame*, Chess::Result)));
+		this, SLOT(onGameFinished(ChessGame*, Chess::Result)));
 
 	for (int i = 0; i < 2; i++)
 	{
@@ -103,36 +133,77 @@ void GameWallWidget::setGame(ChessGame* game)
 			connect(m_scene, SIGNAL(humanMove(Chess::GenericMove, Chess::Side)),
 				player, SLOT(onHumanMove(Chess::GenericMove, Chess::Side)));
 
-		m_clocks[i]->setPlayerName(player->name());
+		const TimeControl* tc = player->timeControl();
+		clocks[i].name = player->name();
+		clocks[i].infinite = tc->isInfinite();
+		clocks[i].thinking = (player->state() == ChessPlayer::Thinking);
+		clocks[i].time = clocks[i].thinking ? tc->activeTimeLeft()
+						    : tc->timeLeft();
+
 		connect(player, SIGNAL(nameChanged(QString)),
 			m_clocks[i], SLOT(setPlayerName(QString)));
-
-		m_clocks[i]->setInfiniteTime(player->timeControl()->isInfinite());
-
-		if (player->state() == ChessPlayer::Thinking)
-			m_clocks[i]->start(player->timeControl()->activeTimeLeft());
-		else
-			m_clocks[i]->setTime(player->timeControl()->timeLeft());
-
 		connect(player, SIGNAL(startedThinking(int)),
 			m_clocks[i], SLOT(start(int)));
 		connect(player, SIGNAL(stoppedThinking()),
 			m_clocks[i], SLOT(stop()));
 	}
 
-	m_scene->setBoard(game->pgn()->createBoard());
-	m_scene->populate();
+	// Set up the current position directly instead of replaying the
+	// game's moves. Moves made after unlocking are queued to this
+	// widget, so the scene can be built without holding the lock.
+	Chess::Board* board = game->pgn()->createBoard();
+	const QString fenString = game->board()->fenString();
+	const bool flipped = game->boardShouldBeFlipped();
+	const bool humanToMove = !game->isFinished() &&
+				 game->playerToMove()->isHuman();
+	game->unlockThread();
+
+	for (int i = 0; i < 2; i++)
+	{
+		m_clocks[i]->setPlayerName(clocks[i].name);
+		m_clocks[i]->setInfiniteTime(clocks[i].infinite);
+		if (clocks[i].thinking)
+			m_clocks[i]->start(clocks[i].time);
+		else
+			m_clocks[i]->setTime(clocks[i].time);
+	}
+
+	m_scene->setBoard(board);
+	m_scene->setFenString(fenString);
 
-	if (game->boardShouldBeFlipped())
+	if (flipped)
 		m_scene->flip();
 
-	for (const Chess::Move& move : game->moves())
+	m_view->setEnabled(humanToMove);
+}
+
+void GameWallWidget::updateBoard()
+{
+	if (m_pendingMoves.isEmpty())
+		return;
+
+	const auto moves = m_pendingMoves;
+	m_pendingMoves.clear();
+	for (const auto& move : moves)
 		m_scene->makeMove(move);
+}
 
-	game->unlockThread();
+void GameWallWidget::onFenChanged(const QString& fenString)
+{
+	m_pendingMoves.clear();
+	m_scene->setFenString(fenString);
+}
 
-	m_view->setEnabled(!game->isFinished() &&
-			   game->playerToMove()->isHuman());
+void GameWallWidget::onMoveMade(const Chess::GenericMove& move)
+{
+	// Collect the moves until the next update of the wall
+	m_pendingMoves.append(move);
+}
+
+void GameWallWidget::onGameFinished(ChessGame* game, Chess::Result result)
+{
+	updateBoard();
+	m_scene->onGameFinished(game, result);
 }
 
 
@@ -143,6 +214,11 @@ GameWall::GameWall(GameManager* manager, QWidget *parent)
 
 	setLayout(new TileLayout());
 
+	QTimer* updateTimer = new QTimer(this);
+	updateTimer->setInterval(s_updateInterval);
+	connect(updateTimer, SIGNAL(timeout()), this, SLOT(updateBoards()));
+	updateTimer->start();
+
 	const auto activeGames = manager->activeGames();
 	for (ChessGame* game : activeGames)
 	{
@@ -180,6 +256,12 @@ void GameWall::addGame(ChessGame* game)
 	m_games[game] = widget;
 }
 
+void GameWall::updateBoards()
+{
+	for (GameWallWidget* widget : qAsConst(m_games))
+		widget->updateBoard();
+}
+
 void GameWall::removeGame(ChessGame* game)
 {
 	if (!m_games.contains(game))
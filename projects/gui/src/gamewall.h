@@ -39,6 +39,9 @@ class GameWall : public QWidget
 		void addGame(ChessGame* game);
 		void removeGame(ChessGame* game);
 
+	private slots:
+		void updateBoards();
+
 	private:
 		GameWallWidget* getFreeWidget();
 
@@ -29,16 +29,45 @@ PgnDatabase::PgnDatabase(const QString& fileName, QObject* parent)
 
 PgnDatabase::~PgnDatabase()
 {
-	qDeleteAll(m_entries);
 }
 
-void PgnDatabase::setEntries(const QList<const PgnGameEntry*>& entries)
+PgnTagPool* PgnDatabase::tagPool()
+{
+	return &m_tagPool;
+}
+
+const PgnTagPool* PgnDatabase::tagPool() const
+{
+	return &m_tagPool;
+}
+
+PgnTagIndex* PgnDatabase::tagIndex()
+{
+	return &m_tagIndex;
+}
+
+const PgnTagIndex* PgnDatabase::tagIndex() const
+{
+	return &m_tagIndex;
+}
+
+PgnPositionIndex* PgnDatabase::positionIndex()
+{
+	return &m_positionIndex;
+}
+
+const PgnPositionIndex* PgnDatabase::positionIndex() const
+{
+	return &m_positionIndex;
+}
+
+void PgnDatabase::setEntries(const QVector<PgnGameEntry>& entries)
 {
-	qDeleteAll(m_entries);
 	m_entries = entries;
+	m_tagIndex.clear();
 }
 
-QList<const PgnGameEntry*> PgnDatabase::entries() const
+const QVector<PgnGameEntry>& PgnDatabase::entries() const
 {
 	return m_entries;
 }
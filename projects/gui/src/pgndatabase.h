@@ -20,16 +20,24 @@
 #define PGN_DATABASE_H
 
 #include <QObject>
-#include <QList>
+#include <QVector>
 #include <QDateTime>
 #include <QFile>
 #include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgnpositionindex.h>
+#include <pgntagindex.h>
+#include <pgntagpool.h>
 class PgnStream;
 
 /*!
  * \brief PGN database
  *
+ * The game entries of the database are stored in one contiguous
+ * table, and their tag values are interned in a tag pool that is
+ * shared by all the entries. A tag index over the entries is used
+ * to search the database.
+ *
  * \sa PgnGame
  * \sa PgnGameEntry
  * \sa PgnImporter
@@ -58,21 +66,49 @@ class PgnDatabase : public QObject
 		virtual ~PgnDatabase();
 
 		/*!
-		 * Set the game entries found in this database to \a entries.
+		 * Returns the tag pool of this database.
+		 *
+		 * The entries passed to setEntries() must store their tag
+		 * values in this pool.
+		 */
+		PgnTagPool* tagPool();
+		/*! \overload */
+		const PgnTagPool* tagPool() const;
+
+		/*!
+		 * Returns the tag index of this database.
 		 *
-		 * The database takes ownership of the PgnGameEntry objects
-		 * in \a entries.
+		 * The index is cleared by setEntries(), and it has to be
+		 * built or read again after that.
 		 */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
+		PgnTagIndex* tagIndex();
+		/*! \overload */
+		const PgnTagIndex* tagIndex() const;
+
 		/*!
-		 * Returns the list of game entries in this database.
+		 * Returns the position index of this database.
+		 *
+		 * The position index is optional; it's only usable if it's
+		 * open and its game count matches the number of entries.
+		 */
+		PgnPositionIndex* positionIndex();
+		/*! \overload */
+		const PgnPositionIndex* positionIndex() const;
+
+		/*! Set the game entries found in this database to \a entries. */
+		void setEntries(const QVector<PgnGameEntry>& entries);
+		/*!
+		 * Returns the game entries in this database.
 		 *
 		 * Game entries are light-weight "pointers" to the database. The game()
 		 * method can be used to read the move information.
 		 *
+		 * \note Pointers to the entries stay valid until setEntries()
+		 * is called again or the database is destroyed.
+		 *
 		 * \sa game()
 		 */
-		QList<const PgnGameEntry*> entries() const;
+		const QVector<PgnGameEntry>& entries() const;
 
 		/*! Returns the file name of this database. */
 		QString fileName() const;
@@ -122,7 +158,10 @@ class PgnDatabase : public QObject
 		Status game(const PgnGameEntry* entry, PgnGame* game);
 
 	private:
-		QList<const PgnGameEntry*> m_entries;
+		PgnTagPool m_tagPool;
+		PgnTagIndex m_tagIndex;
+		PgnPositionIndex m_positionIndex;
+		QVector<PgnGameEntry> m_entries;
 		QDateTime m_lastModified;
 		QString m_fileName;
 		QString m_displayName;
@@ -18,23 +18,76 @@
 
 #include "pgngameentrymodel.h"
 #include <QtConcurrentFilter>
+#include <QFile>
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <board/board.h>
+#include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgnpositionindex.h>
+#include <pgnstream.h>
+#include <pgntagindex.h>
+#include "pgndatabase.h"
 
+namespace {
+
+/*
+ * Returns true if the game of \a entry in PGN file \a fileName
+ * reaches the position with Zobrist key \a key.
+ */
+bool reachesPosition(const QString& fileName,
+		     const PgnGameEntry* entry,
+		     quint64 key)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	PgnStream in(&file);
+	PgnGame game;
+	if (!in.seek(entry->pos(), entry->lineNumber())
+	||  !game.read(in, INT_MAX - 1, false))
+		return false;
+
+	for (const auto& md : game.moves())
+	{
+		if (md.key == key)
+			return true;
+	}
+	return in.board()->key() == key;
+}
+
+} // anonymous namespace
 
 struct EntryContains
 {
 	EntryContains(const QList<const PgnGameEntry*>& entries,
+		      const QVector<PgnGameEntryModel::ReplayRange>& replayRanges,
 		      const PgnGameFilter& filter)
-		: m_entries(entries), m_filter(filter) { }
+		: m_entries(entries),
+		  m_replayRanges(replayRanges),
+		  m_filter(filter) { }
 
 	typedef bool result_type;
 
 	inline bool operator()(int index)
 	{
-		return m_entries.at(index)->match(m_filter);
+		const PgnGameEntry* entry = m_entries.at(index);
+		if (!entry->match(m_filter))
+			return false;
+
+		for (const auto& range : m_replayRanges)
+		{
+			if (index >= range.begin && index < range.end)
+				return reachesPosition(range.fileName, entry,
+						       m_filter.positionKey());
+		}
+		return true;
 	}
 
 	const QList<const PgnGameEntry*>& m_entries;
+	const QVector<PgnGameEntryModel::ReplayRange>& m_replayRanges;
 	PgnGameFilter m_filter;
 };
 
@@ -62,18 +115,19 @@ int PgnGameEntryModel::entryCount() const
 	return m_filtered.resultCount();
 }
 
-void PgnGameEntryModel::setEntries(const QList<const PgnGameEntry*>& entries)
+void PgnGameEntryModel::setDatabases(const QList<const PgnDatabase*>& databases)
 {
 	m_watcher.cancel();
 	m_watcher.waitForFinished();
 
-	m_entries = entries;
-
-	if (entries.size() > m_indexes.size())
+	m_databases = databases;
+	m_entries.clear();
+	for (const PgnDatabase* db : databases)
 	{
-		m_indexes.reserve(entries.size());
-		for (int i = m_indexes.size(); i < entries.size(); i++)
-			m_indexes.append(i);
+		const auto& entries = db->entries();
+		m_entries.reserve(m_entries.size() + entries.size());
+		for (const PgnGameEntry& entry : entries)
+			m_entries << &entry;
 	}
 
 	applyFilter(m_filter);
@@ -90,9 +144,74 @@ void PgnGameEntryModel::applyFilter(const PgnGameFilter& filter)
 	beginResetModel();
 	m_entryCount = 0;
 
-	m_filtered = QtConcurrent::filtered(m_indexes.constBegin(),
-					    m_indexes.constBegin() + m_entries.size(),
-					    EntryContains(m_entries, filter));
+	// Narrow the search down to the candidates from the tag indexes
+	m_candidates.clear();
+	m_replayRanges.clear();
+	int offset = 0;
+	for (const PgnDatabase* db : qAsConst(m_databases))
+	{
+		const int count = db->entries().size();
+		const PgnTagIndex* index = db->tagIndex();
+
+		if (filter.hasPositionKey())
+		{
+			// The games that the position index doesn't cover are
+			// replayed, which is much slower
+			const PgnPositionIndex* positionIndex = db->positionIndex();
+			QVector<int> candidates;
+			if (positionIndex->isOpen()
+			&&  positionIndex->gameCount() == count
+			&&  filter.positionPly() <= positionIndex->maxPlies())
+			{
+				candidates = positionIndex->find(filter.positionKey());
+				if (index->entryCount() == count)
+				{
+					const auto tagCandidates = index->find(filter, *db->tagPool());
+					QVector<int> tmp;
+					std::set_intersection(candidates.constBegin(),
+							      candidates.constEnd(),
+							      tagCandidates.constBegin(),
+							      tagCandidates.constEnd(),
+							      std::back_inserter(tmp));
+					candidates = tmp;
+				}
+			}
+			else
+			{
+				if (index->entryCount() == count)
+					candidates = index->find(filter, *db->tagPool());
+				else
+				{
+					candidates.reserve(count);
+					for (int i = 0; i < count; i++)
+						candidates.append(i);
+				}
+				m_replayRanges.append({ offset, offset + count,
+							db->fileName() });
+			}
+			for (int i : qAsConst(candidates))
+				m_candidates.append(offset + i);
+		}
+		else if (index->entryCount() == count)
+		{
+			const auto candidates = index->find(filter, *db->tagPool());
+			m_candidates.reserve(m_candidates.size() + candidates.size());
+			for (int i : candidates)
+				m_candidates.append(offset + i);
+		}
+		else
+		{
+			m_candidates.reserve(m_candidates.size() + count);
+			for (int i = 0; i < count; i++)
+				m_candidates.append(offset + i);
+		}
+		offset += count;
+	}
+
+	m_filtered = QtConcurrent::filtered(m_candidates.constBegin(),
+					    m_candidates.constEnd(),
+					    EntryContains(m_entries, m_replayRanges,
+							  filter));
 
 	m_watcher.setFuture(m_filtered);
 	endResetModel();
@@ -25,9 +25,16 @@
 #include <QFutureWatcher>
 #include <pgngamefilter.h>
 class PgnGameEntry;
+class PgnDatabase;
 
 /*!
  * \brief Supplies PGN game entry information to views.
+ *
+ * The entries matching the filter are first looked up from the tag
+ * indexes of the databases, and only those candidates are matched
+ * against the filter in the background. A position is looked up from
+ * the position indexes, and the games of databases whose index doesn't
+ * cover the position are replayed.
  */
 class PgnGameEntryModel : public QAbstractItemModel
 {
@@ -52,8 +59,11 @@ class PgnGameEntryModel : public QAbstractItemModel
 		 * \a row in the model.
 		 */
 		int sourceIndex(int row) const;
-		/*! Associates a list of PGN game entries with this model. */
-		void setEntries(const QList<const PgnGameEntry*>& entries);
+		/*!
+		 * Associates the game entries of \a databases with this
+		 * model.
+		 */
+		void setDatabases(const QList<const PgnDatabase*>& databases);
 
 		// Inherited from QAbstractItemModel
 		virtual QModelIndex index(int row, int column,
@@ -78,10 +88,23 @@ class PgnGameEntryModel : public QAbstractItemModel
 		void onResultsReady();
 
 	private:
+		friend struct EntryContains;
+
+		// A range of entries whose games are replayed to find
+		// a position
+		struct ReplayRange
+		{
+			int begin;
+			int end;
+			QString fileName;
+		};
+
 		void applyFilter(const PgnGameFilter& filter);
 
+		QList<const PgnDatabase*> m_databases;
 		QList<const PgnGameEntry*> m_entries;
-		QVector<int> m_indexes;
+		QVector<int> m_candidates;
+		QVector<ReplayRange> m_replayRanges;
 		int m_entryCount;
 		QFuture<int> m_filtered;
 		QFutureWatcher<int> m_watcher;
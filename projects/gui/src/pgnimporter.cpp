@@ -20,14 +20,118 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QFuture>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include <pgnstream.h>
+#include <pgngame.h>
 #include <pgngameentry.h>
+#include <pgntagpool.h>
+#include <board/board.h>
 #include "pgndatabase.h"
 
+namespace {
+
+typedef QVector<PgnPositionIndex::Position> PositionList;
+
+// The approximate size of a block of games parsed by a single thread
+const int s_chunkSize = 4 * 1024 * 1024;
+
+struct Chunk
+{
+	QByteArray data;
+	qint64 pos;
+	qint64 lineNumber;
+	int maxPlies;
+};
+
+struct ChunkResult
+{
+	QSharedPointer<PgnTagPool> tagPool;
+	QVector<PgnGameEntry> entries;
+	PositionList positions;
+};
+
+/*
+ * Returns the index of the last game in \a data that begins with
+ * an Event tag after an empty line, or -1 if there isn't one.
+ */
+int lastGameStart(const QByteArray& data)
+{
+	int i = data.size();
+	while (i > 0 && (i = data.lastIndexOf("[Event", i - 1)) > 0)
+	{
+		int j = i - 1;
+		if (data.at(j) != '\n')
+			continue;
+		if (j > 0 && data.at(j - 1) == '\r')
+			j--;
+		if (j > 0 && data.at(j - 1) == '\n')
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * Replays the first \a maxPlies plies of the game at \a entry's
+ * position in \a in, and adds the positions to \a positions.
+ */
+void addPositions(PgnStream& in,
+		  const PgnGameEntry& entry,
+		  quint32 game,
+		  int maxPlies,
+		  PositionList& positions)
+{
+	PgnGame pgn;
+	if (!in.seek(entry.pos(), entry.lineNumber())
+	||  !pgn.read(in, maxPlies, false))
+		return;
+
+	const auto& moves = pgn.moves();
+	if (moves.isEmpty())
+		return;
+
+	for (const auto& md : moves)
+		positions.append({ md.key, game });
+	positions.append({ in.board()->key(), game });
+}
+
+ChunkResult readChunk(const Chunk& chunk)
+{
+	// Each chunk has its own tag pool so that the threads don't
+	// have to synchronize. The pools are merged in file order.
+	ChunkResult result;
+	result.tagPool = QSharedPointer<PgnTagPool>::create();
+	PgnStream in(&chunk.data);
+	PgnStream gameIn(&chunk.data);
+
+	for (;;)
+	{
+		PgnGameEntry game(result.tagPool.data());
+		if (!game.read(in))
+			break;
+
+		if (chunk.maxPlies > 0)
+			addPositions(gameIn, game, result.entries.size(),
+				     chunk.maxPlies, result.positions);
+
+		game.addOffset(chunk.pos, chunk.lineNumber - 1);
+		result.entries << game;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
 PgnImporter::PgnImporter(const QString& fileName)
 	: Worker(QString("PGN import: %1").arg(fileName)),
-	  m_fileName(fileName)
+	  m_fileName(fileName),
+	  m_positionIndexPlies(0)
 {
 }
 
@@ -36,12 +140,16 @@ QString PgnImporter::fileName() const
 	return m_fileName;
 }
 
+void PgnImporter::setPositionIndex(const QString& fileName, int maxPlies)
+{
+	m_positionIndexFile = fileName;
+	m_positionIndexPlies = maxPlies;
+}
+
 void PgnImporter::work()
 {
 	QFile file(m_fileName);
 	QFileInfo fileInfo(m_fileName);
-	static const int updateInterval = 1024;
-	int numReadGames = 0;
 
 	if (!fileInfo.exists())
 	{
@@ -49,22 +157,82 @@ void PgnImporter::work()
 		return;
 	}
 
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	// The positions are spilled to disk in sorted runs, so the
+	// index of a huge database doesn't have to fit in memory
+	QScopedPointer<PgnPositionIndex::Writer> positions;
+	if (m_positionIndexPlies > 0)
+		positions.reset(new PgnPositionIndex::Writer(m_positionIndexFile));
+
+	PgnDatabase* db = new PgnDatabase(m_fileName);
+	QVector<PgnGameEntry> games;
+	bool ok;
+	if (QThread::idealThreadCount() > 1 && fileInfo.size() > s_chunkSize)
+		ok = readParallel(&file, db->tagPool(), games, positions.data());
+	else
+		ok = readSequential(&file, db->tagPool(), games, positions.data());
+
+	if (!ok)
 	{
+		delete db;
 		emit error(PgnImporter::IoError);
 		return;
 	}
 
-	PgnStream pgnStream(&file);
-	QList<const PgnGameEntry*> games;
+	games.squeeze();
+	db->setEntries(games);
+	db->tagIndex()->build(*db->tagPool(), db->entries());
+
+	if (positions)
+	{
+		db->positionIndex()->close();
+		if (!positions->finish(games.size(), m_positionIndexPlies)
+		||  !db->positionIndex()->open(m_positionIndexFile))
+			qWarning("Could not write position index file: %s",
+				 qUtf8Printable(m_positionIndexFile));
+	}
+	db->setLastModified(fileInfo.lastModified());
+
+	emit databaseRead(db);
+}
+
+bool PgnImporter::readSequential(QFile* file,
+				 PgnTagPool* tagPool,
+				 QVector<PgnGameEntry>& games,
+				 PgnPositionIndex::Writer* positions)
+{
+	static const int updateInterval = 1024;
+	int numReadGames = 0;
+
+	if (!file->open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	PgnStream pgnStream(file);
+
+	// The moves are read from a separate stream that follows
+	// the tag stream
+	QFile gameFile(file->fileName());
+	PgnStream gameStream;
+	PositionList gamePositions;
+	if (positions != nullptr)
+	{
+		if (!gameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+			return false;
+		gameStream.setDevice(&gameFile);
+	}
 
 	for (;;)
 	{
-		PgnGameEntry* game = new PgnGameEntry;
-		if (cancelRequested() || !game->read(pgnStream))
-		{
-			delete game;
+		PgnGameEntry game(tagPool);
+		if (cancelRequested() || !game.read(pgnStream))
 			break;
+
+		if (positions != nullptr)
+		{
+			addPositions(gameStream, game, games.size(),
+				     m_positionIndexPlies, gamePositions);
+			for (const auto& position : qAsConst(gamePositions))
+				positions->addPosition(position.key, position.game);
+			gamePositions.resize(0);
 		}
 
 		games << game;
@@ -74,9 +242,98 @@ void PgnImporter::work()
 			emit databaseReadStatus(startTime(), numReadGames,
 			    pgnStream.pos());
 	}
-	PgnDatabase* db = new PgnDatabase(m_fileName);
-	db->setEntries(games);
-	db->setLastModified(fileInfo.lastModified());
 
-	emit databaseRead(db);
+	return true;
+}
+
+bool PgnImporter::readParallel(QFile* file,
+			       PgnTagPool* tagPool,
+			       QVector<PgnGameEntry>& games,
+			       PgnPositionIndex::Writer* positions)
+{
+	/*
+	 * The file is read sequentially in blocks that are cut at game
+	 * boundaries, and the blocks are parsed concurrently. The results
+	 * are collected in file order so that the entries end up in the
+	 * same order as with a sequential import. The number of blocks in
+	 * flight is limited to keep the memory usage bounded.
+	 */
+	if (!file->open(QIODevice::ReadOnly))
+		return false;
+
+	const int maxPending = QThread::idealThreadCount() * 2;
+	QList< QFuture<ChunkResult> > futures;
+	QList<qint64> chunkEnds;
+	int numCollected = 0;
+	int numReadGames = 0;
+
+	auto collect = [&]()
+	{
+		const ChunkResult result = futures.at(numCollected).result();
+		const QVector<quint32> ids = tagPool->merge(*result.tagPool);
+		const quint32 firstGame = games.size();
+		for (const auto& position : result.positions)
+			positions->addPosition(position.key,
+					       position.game + firstGame);
+
+		for (PgnGameEntry game : result.entries)
+		{
+			game.setTagPool(tagPool, ids);
+			games << game;
+		}
+
+		numReadGames = games.size();
+		emit databaseReadStatus(startTime(), numReadGames,
+		    chunkEnds.at(numCollected));
+		futures[numCollected++] = QFuture<ChunkResult>();
+	};
+
+	QByteArray pending;
+	qint64 pos = 0;
+	qint64 lineNumber = 1;
+	bool ok = true;
+
+	while (!cancelRequested())
+	{
+		const QByteArray block = file->read(s_chunkSize);
+		if (block.isEmpty() && !file->atEnd())
+		{
+			ok = false;
+			break;
+		}
+
+		const bool atEnd = block.isEmpty();
+		pending.append(block);
+
+		const int split = atEnd ? pending.size() : lastGameStart(pending);
+		if (split <= 0)
+		{
+			if (atEnd)
+				break;
+			continue;
+		}
+
+		Chunk chunk;
+		chunk.data = pending.left(split);
+		chunk.pos = pos;
+		chunk.lineNumber = lineNumber;
+		chunk.maxPlies = positions != nullptr ? m_positionIndexPlies : 0;
+		pending.remove(0, split);
+
+		pos += split;
+		lineNumber += chunk.data.count('\n');
+
+		futures << QtConcurrent::run(readChunk, chunk);
+		chunkEnds << pos;
+
+		while (futures.size() - numCollected >= maxPending)
+			collect();
+		if (atEnd)
+			break;
+	}
+
+	while (numCollected < futures.size())
+		collect();
+
+	return ok;
 }
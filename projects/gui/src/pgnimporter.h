@@ -19,13 +19,21 @@
 #ifndef PGN_IMPORTER_H
 #define PGN_IMPORTER_H
 
+#include <QVector>
 #include <worker.h>
+#include <pgnpositionindex.h>
 
+class QFile;
 class PgnDatabase;
+class PgnGameEntry;
+class PgnTagPool;
 
 /*!
  * \brief Reads PGN database in a separate thread.
  *
+ * Large files are split into blocks at game boundaries, and the
+ * blocks are parsed concurrently on multi-core systems.
+ *
  * \sa PgnDatabase
  */
 class PgnImporter : public Worker
@@ -47,6 +55,13 @@ class PgnImporter : public Worker
 		PgnImporter(const QString& fileName);
 		/*! Returns the file name of the database to be imported. */
 		QString fileName() const;
+		/*!
+		 * Builds a position index of the first \a maxPlies plies of
+		 * every game to file \a fileName during the import.
+		 *
+		 * By default no position index is built.
+		 */
+		void setPositionIndex(const QString& fileName, int maxPlies);
 
 	protected:
 		void work() override;
@@ -63,7 +78,18 @@ class PgnImporter : public Worker
 		void databaseReadStatus(const QTime& started, int numReadGames, qint64 numReadBytes);
 
 	private:
+		bool readSequential(QFile* file,
+				    PgnTagPool* tagPool,
+				    QVector<PgnGameEntry>& games,
+				    PgnPositionIndex::Writer* positions);
+		bool readParallel(QFile* file,
+				  PgnTagPool* tagPool,
+				  QVector<PgnGameEntry>& games,
+				  PgnPositionIndex::Writer* positions);
+
 		QString m_fileName;
+		QString m_positionIndexFile;
+		int m_positionIndexPlies;
 
 };
 
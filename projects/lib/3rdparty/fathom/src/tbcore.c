@@ -77,9 +77,11 @@ static struct TBEntry_pawn TB_pawn[TBMAX_PAWN];
 
 static struct TBHashEntry TB_hash[1 << TBHASHBITS][HSHMAX];
 
-#define DTZ_ENTRIES 64
-
-static struct DTZTableEntry DTZ_table[DTZ_ENTRIES];
+// DTZ tables are loaded on first use and stay mapped until the next
+// call to init_tablebases(), so they can be probed without locking.
+// The tables are indexed like TB_piece and TB_pawn.
+static struct TBEntry *DTZ_entry[TBMAX_PIECE + TBMAX_PAWN];
+static ubyte DTZ_ready[TBMAX_PIECE + TBMAX_PAWN];
 
 static void init_indices(void);
 static uint64_t calc_key_from_pcs(int *pcs, int mirror);
@@ -351,9 +353,9 @@ void init_tablebases(const char *path)
       entry = (struct TBEntry *)&TB_pawn[i];
       free_wdl_entry(entry);
     }
-    for (i = 0; i < DTZ_ENTRIES; i++)
-      if (DTZ_table[i].entry)
-	free_dtz_entry(DTZ_table[i].entry);
+    for (i = 0; i < TBMAX_PIECE + TBMAX_PAWN; i++)
+      if (DTZ_entry[i])
+	free_dtz_entry(DTZ_entry[i]);
   } else {
     init_indices();
     initialized = 1;
@@ -391,8 +393,10 @@ void init_tablebases(const char *path)
       TB_hash[i][j].ptr = NULL;
     }
 
-  for (i = 0; i < DTZ_ENTRIES; i++)
-    DTZ_table[i].entry = NULL;
+  for (i = 0; i < TBMAX_PIECE + TBMAX_PAWN; i++) {
+    DTZ_entry[i] = NULL;
+    DTZ_ready[i] = 0;
+  }
 
   for (i = 1; i < 6; i++) {
     snprintf(str, 16, "K%cvK", pchr[i]);
@@ -1633,22 +1637,9 @@ static ubyte decompress_pairs(struct PairsData *d, uint64 idx)
   return *(sympat + 3 * sym);
 }
 
-void load_dtz_table(char *str, uint64 key1, uint64 key2)
+static struct TBEntry *load_dtz_table(char *str, struct TBEntry *ptr)
 {
-  int i;
-  struct TBEntry *ptr, *ptr3;
-  struct TBHashEntry *ptr2;
-
-  DTZ_table[0].key1 = key1;
-  DTZ_table[0].key2 = key2;
-  DTZ_table[0].entry = NULL;
-
-  // find corresponding WDL entry
-  ptr2 = TB_hash[key1 >> (64 - TBHASHBITS)];
-  for (i = 0; i < HSHMAX; i++)
-    if (ptr2[i].key == key1) break;
-  if (i == HSHMAX) return;
-  ptr = ptr2[i].ptr;
+  struct TBEntry *ptr3;
 
   ptr3 = (struct TBEntry *)malloc(ptr->has_pawns
 				? sizeof(struct DTZEntry_pawn)
@@ -1667,10 +1658,37 @@ void load_dtz_table(char *str, uint64 key1, uint64 key2)
     struct DTZEntry_piece *entry = (struct DTZEntry_piece *)ptr3;
     entry->enc_type = ((struct TBEntry_piece *)ptr)->enc_type;
   }
-  if (!init_table_dtz(ptr3))
+  if (!init_table_dtz(ptr3)) {
     free(ptr3);
-  else
-    DTZ_table[0].entry = ptr3;
+    return NULL;
+  }
+  return ptr3;
+}
+
+// Returns the DTZ table that belongs to the WDL table ptr, or NULL if
+// the DTZ table isn't available. The table is loaded on first use.
+static struct TBEntry *get_dtz_table(char *str, struct TBEntry *ptr)
+{
+  int i = ptr->has_pawns
+	? TBMAX_PIECE + (int)((struct TBEntry_pawn *)ptr - TB_pawn)
+	: (int)((struct TBEntry_piece *)ptr - TB_piece);
+
+  if (!DTZ_ready[i]) {
+    LOCK(TB_MUTEX);
+    if (!DTZ_ready[i]) {
+      DTZ_entry[i] = load_dtz_table(str, ptr);
+      // Memory barrier to ensure DTZ_ready[i] = 1 is not reordered.
+#ifdef __GNUC__
+      __asm__ __volatile__ ("" ::: "memory");
+#elif defined(_MSC_VER)
+      MemoryBarrier();
+#endif
+      DTZ_ready[i] = 1;
+    }
+    UNLOCK(TB_MUTEX);
+  }
+
+  return DTZ_entry[i];
 }
 
 static void free_wdl_entry(struct TBEntry *entry)
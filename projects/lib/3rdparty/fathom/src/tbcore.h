@@ -17,6 +17,10 @@
 #define FD_ERR INVALID_HANDLE_VALUE
 #endif
 
+#ifndef TB_NO_THREADS
+#define TB_HAVE_THREADS
+#endif
+
 #ifdef TB_HAVE_THREADS
 #ifndef _WIN32
 #define LOCK_T pthread_mutex_t
@@ -163,11 +167,5 @@ struct TBHashEntry {
   struct TBEntry *ptr;
 };
 
-struct DTZTableEntry {
-  uint64 key1;
-  uint64 key2;
-  struct TBEntry *entry;
-};
-
 #endif
 
@@ -808,48 +808,21 @@ static int probe_dtz_table(const struct pos *pos, int wdl, int *success)
     // Obtain the position's material signature key.
     uint64_t key = calc_key(pos, false);
 
-    if (DTZ_table[0].key1 != key && DTZ_table[0].key2 != key)
+    struct TBHashEntry *ptr2 = TB_hash[key >> (64 - TBHASHBITS)];
+    for (i = 0; i < HSHMAX; i++)
     {
-        for (i = 1; i < DTZ_ENTRIES; i++)
-        {
-            if (DTZ_table[i].key1 == key)
-                break;
-        }
-        if (i < DTZ_ENTRIES)
-        {
-            struct DTZTableEntry table_entry = DTZ_table[i];
-            for (; i > 0; i--)
-                DTZ_table[i] = DTZ_table[i - 1];
-            DTZ_table[0] = table_entry;
-        }
-        else
-        {
-            struct TBHashEntry *ptr2 = TB_hash[key >> (64 - TBHASHBITS)];
-            for (i = 0; i < HSHMAX; i++)
-            {
-                if (ptr2[i].key == key)
-                    break;
-            }
-            if (i == HSHMAX)
-            {
-                *success = 0;
-                return 0;
-            }
-            ptr = ptr2[i].ptr;
-            char str[16];
-            int mirror = (ptr->key != key);
-            prt_str(pos, str, mirror);
-            if (DTZ_table[DTZ_ENTRIES - 1].entry)
-                free_dtz_entry(DTZ_table[DTZ_ENTRIES-1].entry);
-            for (i = DTZ_ENTRIES - 1; i > 0; i--)
-                DTZ_table[i] = DTZ_table[i - 1];
-            uint64_t key1 = calc_key(pos, mirror);
-            uint64_t key2 = calc_key(pos, !mirror);
-            load_dtz_table(str, key1, key2);
-        }
+        if (ptr2[i].key == key)
+            break;
+    }
+    if (i == HSHMAX)
+    {
+        *success = 0;
+        return 0;
     }
 
-    ptr = DTZ_table[0].entry;
+    char str[16];
+    prt_str(pos, str, ptr2[i].ptr->key != key);
+    ptr = get_dtz_table(str, ptr2[i].ptr);
     if (!ptr)
     {
         *success = 0;
@@ -35,6 +35,11 @@ QString AndernachBoard::variant() const
 	return "andernach";
 }
 
+bool AndernachBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 Move AndernachBoard::moveFromSanString(const QString& str)
 {
 	// import: ignore redundant move information in brackets: Nxd5(=bN)
@@ -37,6 +37,11 @@ QString AntiBoard::variant() const
 	return "antichess";
 }
 
+bool AntiBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 QString AntiBoard::defaultFenString() const
 {
 	return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w - - 0 1";
@@ -64,6 +64,7 @@ class LIB_EXPORT AntiBoard : public StandardBoard
 	protected:
 		// Inherited from StandardBoard
 		virtual bool hasCastling() const;
+		virtual bool hasStandardMoveRules() const;
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool vSetFenString(const QStringList& fen);
@@ -43,4 +43,9 @@ QString BerolinaBoard::variant() const
 	return "berolina";
 }
 
+bool BerolinaBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 } // namespace Chess
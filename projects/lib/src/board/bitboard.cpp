@@ -0,0 +1,499 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bitboard.h"
+#include <QtAlgorithms>
+
+namespace {
+
+// Piece types, same as WesternBoard::WesternPieceType
+enum PieceType
+{
+	Pawn = 1,
+	Knight,
+	Bishop,
+	Rook,
+	Queen,
+	King
+};
+
+// Ray directions. The first four directions increase the square
+// number, the last four decrease it.
+enum Direction
+{
+	North,
+	East,
+	NorthEast,
+	NorthWest,
+	South,
+	West,
+	SouthWest,
+	SouthEast
+};
+
+const int s_fileSteps[8] = { 0, 1, 1, -1, 0, -1, -1, 1 };
+const int s_rankSteps[8] = { 1, 0, 1, 1, -1, 0, -1, -1 };
+
+inline quint64 bit(int square)
+{
+	return Q_UINT64_C(1) << square;
+}
+
+inline int lsb(quint64 bb)
+{
+	return qCountTrailingZeroBits(bb);
+}
+
+inline int msb(quint64 bb)
+{
+	return 63 - qCountLeadingZeroBits(bb);
+}
+
+inline int popLsb(quint64& bb)
+{
+	int square = lsb(bb);
+	bb &= bb - 1;
+	return square;
+}
+
+struct AttackTables
+{
+	AttackTables();
+
+	quint64 knight[64];
+	quint64 king[64];
+	quint64 pawn[2][64];
+	quint64 ray[8][64];
+	quint64 between[64][64];
+	quint64 line[64][64];
+};
+
+AttackTables::AttackTables()
+{
+	const int knightSteps[8][2] = {
+		{ 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 },
+		{ -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 }
+	};
+
+	for (int sq = 0; sq < 64; sq++)
+	{
+		int file = sq % 8;
+		int rank = sq / 8;
+
+		knight[sq] = 0;
+		king[sq] = 0;
+		pawn[0][sq] = 0;
+		pawn[1][sq] = 0;
+
+		for (int i = 0; i < 8; i++)
+		{
+			int f = file + knightSteps[i][0];
+			int r = rank + knightSteps[i][1];
+			if (f >= 0 && f < 8 && r >= 0 && r < 8)
+				knight[sq] |= bit(r * 8 + f);
+
+			f = file + s_fileSteps[i];
+			r = rank + s_rankSteps[i];
+			if (f >= 0 && f < 8 && r >= 0 && r < 8)
+				king[sq] |= bit(r * 8 + f);
+		}
+
+		for (int df = -1; df <= 1; df += 2)
+		{
+			int f = file + df;
+			if (f < 0 || f >= 8)
+				continue;
+			if (rank < 7)
+				pawn[0][sq] |= bit((rank + 1) * 8 + f);
+			if (rank > 0)
+				pawn[1][sq] |= bit((rank - 1) * 8 + f);
+		}
+
+		for (int target = 0; target < 64; target++)
+		{
+			between[sq][target] = 0;
+			line[sq][target] = 0;
+		}
+
+		for (int dir = 0; dir < 8; dir++)
+		{
+			ray[dir][sq] = 0;
+
+			quint64 squares = 0;
+			int f = file + s_fileSteps[dir];
+			int r = rank + s_rankSteps[dir];
+			while (f >= 0 && f < 8 && r >= 0 && r < 8)
+			{
+				int target = r * 8 + f;
+				between[sq][target] = squares;
+				squares |= bit(target);
+				f += s_fileSteps[dir];
+				r += s_rankSteps[dir];
+			}
+			ray[dir][sq] = squares;
+		}
+	}
+
+	// A line goes through two squares from one edge of the
+	// board to the other, including both squares.
+	for (int sq = 0; sq < 64; sq++)
+	{
+		for (int dir = 0; dir < 4; dir++)
+		{
+			quint64 full = ray[dir][sq] | ray[dir + 4][sq] | bit(sq);
+			quint64 targets = ray[dir][sq] | ray[dir + 4][sq];
+			while (targets)
+				line[sq][popLsb(targets)] = full;
+		}
+	}
+}
+
+const AttackTables& tables()
+{
+	static const AttackTables s_tables;
+	return s_tables;
+}
+
+inline quint64 slidingAttacks(const AttackTables& t,
+			      int square,
+			      quint64 occupied,
+			      int firstDir)
+{
+	quint64 attacks = 0;
+
+	// Directions that increase the square number are blocked by
+	// the least significant blocker, the others by the most
+	// significant one.
+	for (int dir = firstDir; dir < firstDir + 2; dir++)
+	{
+		quint64 ray = t.ray[dir][square];
+		quint64 blockers = ray & occupied;
+		if (blockers)
+			ray ^= t.ray[dir][lsb(blockers)];
+		attacks |= ray;
+
+		ray = t.ray[dir + 4][square];
+		blockers = ray & occupied;
+		if (blockers)
+			ray ^= t.ray[dir + 4][msb(blockers)];
+		attacks |= ray;
+	}
+
+	return attacks;
+}
+
+inline quint64 rookAttacks(const AttackTables& t, int square, quint64 occupied)
+{
+	return slidingAttacks(t, square, occupied, North);
+}
+
+inline quint64 bishopAttacks(const AttackTables& t, int square, quint64 occupied)
+{
+	return slidingAttacks(t, square, occupied, NorthEast);
+}
+
+} // anonymous namespace
+
+namespace Chess {
+
+Bitboard::Bitboard()
+{
+	clear();
+}
+
+void Bitboard::clear()
+{
+	for (int side = 0; side < 2; side++)
+	{
+		for (int type = 0; type < 7; type++)
+			m_pieces[side][type] = 0;
+		m_sidePieces[side] = 0;
+		m_kingSquare[side] = -1;
+
+		for (int cside = 0; cside < 2; cside++)
+		{
+			m_castling[side][cside].rookSquare = -1;
+			m_castling[side][cside].kingTarget = -1;
+			m_castling[side][cside].rookTarget = -1;
+		}
+	}
+
+	m_side = 0;
+	m_enpassantSquare = -1;
+	m_enpassantTarget = -1;
+}
+
+void Bitboard::setPiece(int square, int side, int type)
+{
+	Q_ASSERT(square >= 0 && square < 64);
+	Q_ASSERT(side == 0 || side == 1);
+	Q_ASSERT(type >= Pawn && type <= King);
+
+	m_pieces[side][type] |= bit(square);
+	m_sidePieces[side] |= bit(square);
+	if (type == King)
+		m_kingSquare[side] = square;
+}
+
+void Bitboard::setSideToMove(int side)
+{
+	Q_ASSERT(side == 0 || side == 1);
+	m_side = side;
+}
+
+void Bitboard::setEnpassantSquare(int square, int target)
+{
+	m_enpassantSquare = square;
+	m_enpassantTarget = target;
+}
+
+void Bitboard::setCastling(int side,
+			   int castlingSide,
+			   int rookSquare,
+			   int kingTarget,
+			   int rookTarget)
+{
+	CastlingData& data = m_castling[side][castlingSide];
+	data.rookSquare = rookSquare;
+	data.kingTarget = kingTarget;
+	data.rookTarget = rookTarget;
+}
+
+int Bitboard::boardIndex(int square)
+{
+	return (9 - square / 8) * 10 + 1 + square % 8;
+}
+
+int Bitboard::square(int boardIndex)
+{
+	return (9 - boardIndex / 10) * 8 + boardIndex % 10 - 1;
+}
+
+quint64 Bitboard::attackers(int square, quint64 occupied, int side) const
+{
+	const AttackTables& t = tables();
+	const quint64* pieces = m_pieces[side];
+
+	return (t.pawn[!side][square] & pieces[Pawn])
+	     | (t.knight[square] & pieces[Knight])
+	     | (t.king[square] & pieces[King])
+	     | (bishopAttacks(t, square, occupied) & (pieces[Bishop] | pieces[Queen]))
+	     | (rookAttacks(t, square, occupied) & (pieces[Rook] | pieces[Queen]));
+}
+
+void Bitboard::generateLegalMoves(QVarLengthArray<Move>& moves) const
+{
+	generate(&moves);
+}
+
+bool Bitboard::hasLegalMoves() const
+{
+	return generate(nullptr);
+}
+
+bool Bitboard::generate(QVarLengthArray<Move>* moves) const
+{
+	const AttackTables& t = tables();
+	const int us = m_side;
+	const int them = !m_side;
+	const quint64* pieces = m_pieces[us];
+	const quint64 own = m_sidePieces[us];
+	const quint64 opp = m_sidePieces[them];
+	const quint64 occupied = own | opp;
+	const int kingSq = m_kingSquare[us];
+	bool found = false;
+
+	Q_ASSERT(kingSq != -1);
+
+	// Adds a move, or tells the caller to stop if it only wants
+	// to know whether a legal move exists.
+	auto add = [&](int source, int target, int promotion)
+	{
+		found = true;
+		if (moves != nullptr)
+			moves->append(Move(boardIndex(source),
+					   boardIndex(target),
+					   promotion));
+		return moves != nullptr;
+	};
+
+	// King moves. The king is removed from the occupancy so that
+	// it can't hide behind itself from a sliding attacker.
+	const quint64 noKing = occupied ^ bit(kingSq);
+	quint64 targets = t.king[kingSq] & ~own;
+	while (targets)
+	{
+		int target = popLsb(targets);
+		if (!attackers(target, noKing, them)
+		&&  !add(kingSq, target, 0))
+			return true;
+	}
+
+	// In double check only the king can move
+	const quint64 checkers = attackers(kingSq, occupied, them);
+	if (checkers & (checkers - 1))
+		return found;
+
+	// Squares that block a check or capture the checking piece
+	quint64 checkMask = ~Q_UINT64_C(0);
+	if (checkers)
+		checkMask = t.between[kingSq][lsb(checkers)] | checkers;
+
+	// Own pieces that are pinned to the king
+	const quint64* opPieces = m_pieces[them];
+	quint64 pinned = 0;
+	quint64 snipers =
+		(rookAttacks(t, kingSq, 0) & (opPieces[Rook] | opPieces[Queen]))
+	      | (bishopAttacks(t, kingSq, 0) & (opPieces[Bishop] | opPieces[Queen]));
+	while (snipers)
+	{
+		quint64 blockers = t.between[kingSq][popLsb(snipers)] & occupied;
+		if (blockers && !(blockers & (blockers - 1)) && (blockers & own))
+			pinned |= blockers;
+	}
+
+	// Knight, bishop, rook and queen moves
+	for (int type = Knight; type <= Queen; type++)
+	{
+		quint64 sources = pieces[type];
+		while (sources)
+		{
+			int source = popLsb(sources);
+			switch (type)
+			{
+			case Knight:
+				targets = t.knight[source];
+				break;
+			case Bishop:
+				targets = bishopAttacks(t, source, occupied);
+				break;
+			case Rook:
+				targets = rookAttacks(t, source, occupied);
+				break;
+			default:
+				targets = bishopAttacks(t, source, occupied)
+					| rookAttacks(t, source, occupied);
+				break;
+			}
+
+			targets &= ~own & checkMask;
+			if (pinned & bit(source))
+				targets &= t.line[kingSq][source];
+
+			while (targets)
+			{
+				if (!add(source, popLsb(targets), 0))
+					return true;
+			}
+		}
+	}
+
+	// Pawn moves
+	const int forward = (us == 0) ? 8 : -8;
+	const int promotionRank = (us == 0) ? 7 : 0;
+	quint64 sources = pieces[Pawn];
+	while (sources)
+	{
+		int source = popLsb(sources);
+		quint64 allowed = checkMask;
+		if (pinned & bit(source))
+			allowed &= t.line[kingSq][source];
+
+		targets = t.pawn[us][source] & opp;
+		int push = source + forward;
+		if (push >= 0 && push < 64 && !(occupied & bit(push)))
+		{
+			targets |= bit(push);
+
+			// Pawns on the first two ranks have a double step
+			int rank = (us == 0) ? source / 8 : 7 - source / 8;
+			int push2 = push + forward;
+			if (rank <= 1 && !(occupied & bit(push2)))
+				targets |= bit(push2);
+		}
+		targets &= allowed;
+
+		while (targets)
+		{
+			int target = popLsb(targets);
+			if (target / 8 != promotionRank)
+			{
+				if (!add(source, target, 0))
+					return true;
+				continue;
+			}
+			for (int promotion = Knight; promotion <= Queen; promotion++)
+			{
+				if (!add(source, target, promotion))
+					return true;
+			}
+		}
+
+		// En-passant captures can uncover a check along the rank
+		// of the captured pawn, so they're verified separately.
+		if (m_enpassantSquare != -1
+		&&  (t.pawn[us][source] & bit(m_enpassantSquare)))
+		{
+			quint64 captured = bit(m_enpassantTarget);
+			quint64 occ = (occupied ^ bit(source) ^ captured)
+				    | bit(m_enpassantSquare);
+			if (!(attackers(kingSq, occ, them) & ~captured)
+			&&  !add(source, m_enpassantSquare, 0))
+				return true;
+		}
+	}
+
+	// Castling moves. The king can't castle out of check, and none
+	// of the squares the king passes may be attacked once the king
+	// and the rook are on their target squares.
+	if (checkers)
+		return found;
+	for (int cside = 0; cside < 2; cside++)
+	{
+		const CastlingData& data = m_castling[us][cside];
+		if (data.rookSquare == -1)
+			continue;
+
+		int rookSq = data.rookSquare;
+		int left = qMin(qMin(kingSq, rookSq), qMin(data.kingTarget, data.rookTarget));
+		int right = qMax(qMax(kingSq, rookSq), qMax(data.kingTarget, data.rookTarget));
+		quint64 span = t.between[left][right] | bit(left) | bit(right);
+		quint64 movers = bit(kingSq) | bit(rookSq);
+		if (span & occupied & ~movers)
+			continue;
+
+		quint64 occ = (occupied ^ movers)
+			    | bit(data.kingTarget) | bit(data.rookTarget);
+		quint64 path = t.between[kingSq][data.kingTarget]
+			     | bit(kingSq) | bit(data.kingTarget);
+		bool isLegal = true;
+		while (path)
+		{
+			if (attackers(popLsb(path), occ, them))
+			{
+				isLegal = false;
+				break;
+			}
+		}
+		if (isLegal && !add(kingSq, rookSq, 0))
+			return true;
+	}
+
+	return found;
+}
+
+} // namespace Chess
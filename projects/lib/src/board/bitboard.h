@@ -0,0 +1,107 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <QtGlobal>
+#include <QVarLengthArray>
+#include "move.h"
+
+namespace Chess {
+
+/*!
+ * \brief A bitboard representation of an 8x8 western chess position
+ *
+ * Bitboard generates strictly legal moves for positions where all
+ * pieces move like in standard chess. Instead of making and undoing
+ * every pseudo-legal move, the legality of the moves is resolved with
+ * precomputed attack tables and check and pin masks.
+ *
+ * The squares are numbered from 0 (a1) to 63 (h8). The piece types
+ * are the same as in WesternBoard, and the generated moves use the
+ * square indexes of Board's padded 10x12 board array.
+ *
+ * \sa WesternBoard
+ */
+class LIB_EXPORT Bitboard
+{
+	public:
+		/*! Creates a new empty Bitboard object. */
+		Bitboard();
+
+		/*! Removes all pieces, castling rights and en-passant data. */
+		void clear();
+		/*!
+		 * Puts a piece of type \a type and side \a side at \a square.
+		 *
+		 * \a side is 0 for White and 1 for Black.
+		 */
+		void setPiece(int square, int side, int type);
+		/*! Sets the side to move to \a side. */
+		void setSideToMove(int side);
+		/*!
+		 * Sets the en-passant square to \a square and the square of
+		 * the pawn that can be captured en passant to \a target.
+		 */
+		void setEnpassantSquare(int square, int target);
+		/*!
+		 * Gives \a side the right to castle with the rook at
+		 * \a rookSquare.
+		 *
+		 * \param castlingSide 0 for the queen side, 1 for the king side
+		 * \param kingTarget The king's square after castling
+		 * \param rookTarget The rook's square after castling
+		 */
+		void setCastling(int side,
+				 int castlingSide,
+				 int rookSquare,
+				 int kingTarget,
+				 int rookTarget);
+
+		/*! Appends the legal moves of the side to move to \a moves. */
+		void generateLegalMoves(QVarLengthArray<Move>& moves) const;
+		/*! Returns true if the side to move has any legal moves. */
+		bool hasLegalMoves() const;
+
+		/*! Converts a square number into a board array index. */
+		static int boardIndex(int square);
+		/*! Converts a board array index into a square number. */
+		static int square(int boardIndex);
+
+	private:
+		struct CastlingData
+		{
+			int rookSquare;
+			int kingTarget;
+			int rookTarget;
+		};
+
+		bool generate(QVarLengthArray<Move>* moves) const;
+		quint64 attackers(int square, quint64 occupied, int side) const;
+
+		quint64 m_pieces[2][7];
+		quint64 m_sidePieces[2];
+		int m_side;
+		int m_kingSquare[2];
+		int m_enpassantSquare;
+		int m_enpassantTarget;
+		CastlingData m_castling[2][2];
+};
+
+} // namespace Chess
+#endif // BITBOARD_H
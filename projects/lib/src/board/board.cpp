@@ -857,8 +857,17 @@ int Board::repeatCount() const
 	if (plyCount() < 4)
 		return 0;
 
+	// A position can't repeat across an irreversible move unless
+	// captured pieces can be dropped back on the board, so only the
+	// reversible moves have to be searched. The side to move is part
+	// of the zobrist key, so every other position can be skipped.
+	int first = 0;
+	int reversible = reversibleMoveCount();
+	if (reversible >= 0 && !variantHasDrops())
+		first = qMax(0, plyCount() - reversible);
+
 	int repeatCount = 0;
-	for (int i = plyCount() - 1; i >= 0; i--)
+	for (int i = plyCount() - 2; i >= first; i -= 2)
 	{
 		if (m_moveHistory.at(i).key == m_key)
 			repeatCount++;
@@ -204,6 +204,10 @@ class LIB_EXPORT Board
 		/*!
 		 * Returns the number of times the current position was
 		 * reached previously in the game.
+		 *
+		 * If the variant counts reversible moves and doesn't have
+		 * piece drops, only the positions after the last irreversible
+		 * move are searched.
 		 */
 		int repeatCount() const;
 		/*!
@@ -278,8 +282,13 @@ class LIB_EXPORT Board
 		 * reached earlier in the game.
 		 */
 		bool isRepetition(const Move& move);
-		/*! Returns a vector of legal moves in the current position. */
-		QVector<Move> legalMoves();
+		/*!
+		 * Returns a vector of legal moves in the current position.
+		 *
+		 * The default implementation filters the pseudo-legal moves
+		 * with vIsLegalMove().
+		 */
+		virtual QVector<Move> legalMoves();
 		/*!
 		 * Returns the result of the game, or Result::NoResult if
 		 * the game is in progress.
@@ -290,7 +299,8 @@ class LIB_EXPORT Board
 		 *
 		 * If the position is a win for either player, \a dtm is
 		 * set to the distance to mate, ie. the number of plies it
-		 * takes to force a mate.
+		 * takes to force a mate. Pass a null \a dtm if only the
+		 * result is needed; it allows a cheaper probe.
 		 *
 		 * The default implementation always returns a null result.
 		 */
@@ -487,8 +497,13 @@ class LIB_EXPORT Board
 		 * \sa isLegalMove()
 		 */
 		bool moveExists(const Move& move) const;
-		/*! Returns true if the side to move has any legal moves. */
-		bool canMove();
+		/*!
+		 * Returns true if the side to move has any legal moves.
+		 *
+		 * The default implementation tries the pseudo-legal moves
+		 * with vIsLegalMove() until a legal one is found.
+		 */
+		virtual bool canMove();
 		/*!
 		 * Returns the size of the board array, including the padding
 		 * (the inaccessible wall squares).
@@ -39,6 +39,11 @@ QString ExtinctionBoard::variant() const
 	return "extinction";
 }
 
+bool ExtinctionBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 QString ExtinctionBoard::defaultFenString() const
 {
 	return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
@@ -61,6 +61,7 @@ class LIB_EXPORT ExtinctionBoard : public StandardBoard
 		virtual Result result();
 	protected:
 		// Inherited from StandardBoard
+		virtual bool hasStandardMoveRules() const;
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool inCheck(Side side, int square = 0) const;
@@ -35,6 +35,11 @@ QString HordeBoard::variant() const
 	return "horde";
 }
 
+bool HordeBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 /*!
  * Horde chess, lichess.org variant has 36 white pawns and starting FEN
  * rnbqkbnr/pppppppp/8/1PP2PP1/PPPPPPPP/PPPPPPPP/PPPPPPPP/PPPPPPPP w kq - 0 1
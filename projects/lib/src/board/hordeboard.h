@@ -57,6 +57,7 @@ class LIB_EXPORT HordeBoard : public StandardBoard
 		virtual QString defaultFenString() const;
 		virtual Result result();
 	protected:
+		virtual bool hasStandardMoveRules() const;
 		virtual bool kingsCountAssertion(int whiteKings,
 						 int blackKings) const;
 		virtual bool vIsLegalMove(const Move& m);
@@ -35,6 +35,11 @@ QString KnightRelayBoard::variant() const
 	return "knightrelay";
 }
 
+bool KnightRelayBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 bool KnightRelayBoard::hasEnPassantCaptures() const
 {
 	return false;
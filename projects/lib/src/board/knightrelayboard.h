@@ -45,6 +45,7 @@ class LIB_EXPORT KnightRelayBoard : public StandardBoard
 
 	protected:
 		// Inherited from StandardBoard
+		virtual bool hasStandardMoveRules() const;
 		virtual bool pieceHasMovement(Piece piece, int square, unsigned movement) const;
 		virtual bool pieceHasCaptureMovement(Piece piece, int square, unsigned movement) const;
 		virtual bool vIsLegalMove(const Move& move);
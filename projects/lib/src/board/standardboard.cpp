@@ -1072,6 +1072,11 @@ QString StandardBoard::defaultFenString() const
 	return "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 }
 
+bool StandardBoard::hasStandardMoveRules() const
+{
+	return true;
+}
+
 Result StandardBoard::tablebaseResult(unsigned int* dtz) const
 {
 	SyzygyTablebase::PieceList pieces;
@@ -1102,7 +1107,8 @@ Result StandardBoard::tablebaseResult(unsigned int* dtz) const
 					castling,
 					reversibleMoveCount(),
 					pieces,
-					dtz);
+					dtz,
+					key());
 }
 
 } // namespace Chess
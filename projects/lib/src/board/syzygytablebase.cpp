@@ -17,6 +17,7 @@
 */
 
 #include "syzygytablebase.h"
+#include <atomic>
 #include <QDir>
 #include <QMutex>
 #include <QStringList>
@@ -27,7 +28,63 @@ namespace {
 
 bool s_initialized = false, s_initOK = false, s_noRule50 = false;
 int s_pieces = INT_MAX;
-QMutex s_mutex;
+
+struct CacheEntry
+{
+	quint64 key;
+	int rule50;	// -1 if the 50-move clock doesn't matter
+	unsigned dtz;
+	Chess::Side winner;
+	bool hasDtz;
+	bool isValid;
+};
+
+const int s_cacheSize = 1 << 16;
+const int s_cacheLockCount = 64;
+CacheEntry s_cache[s_cacheSize];
+QMutex s_cacheLocks[s_cacheLockCount];
+std::atomic<quint64> s_cacheHits(0);
+std::atomic<quint64> s_cacheMisses(0);
+
+bool findCachedResult(quint64 key,
+		      int rule50,
+		      unsigned int* dtz,
+		      Chess::Side* winner)
+{
+	const int index = int(key & (s_cacheSize - 1));
+	QMutexLocker locker(&s_cacheLocks[index % s_cacheLockCount]);
+
+	const CacheEntry& entry = s_cache[index];
+	if (!entry.isValid
+	||  entry.key != key
+	||  (entry.rule50 != -1 && entry.rule50 != rule50)
+	||  (dtz != nullptr && !entry.hasDtz))
+	{
+		locker.unlock();
+		s_cacheMisses++;
+		return false;
+	}
+
+	*winner = entry.winner;
+	if (dtz != nullptr)
+		*dtz = entry.dtz;
+	locker.unlock();
+	s_cacheHits++;
+
+	return true;
+}
+
+void cacheResult(quint64 key,
+		 int rule50,
+		 const Chess::Side& winner,
+		 bool hasDtz,
+		 unsigned dtz)
+{
+	const int index = int(key & (s_cacheSize - 1));
+	QMutexLocker locker(&s_cacheLocks[index % s_cacheLockCount]);
+
+	s_cache[index] = { key, rule50, dtz, winner, hasDtz, true };
+}
 
 int tbSquare(const Chess::Square& square)
 {
@@ -36,6 +93,29 @@ int tbSquare(const Chess::Square& square)
 	return square.rank() * 8 + square.file();
 }
 
+Chess::Side tbWinner(unsigned wdl, bool wtm)
+{
+	switch (wdl)
+	{
+	case TB_BLESSED_LOSS:
+		if (!s_noRule50)
+			break;
+		// Fallthrough
+	case TB_LOSS:
+		return wtm? Chess::Side::Black: Chess::Side::White;
+	case TB_DRAW:
+		break;
+	case TB_CURSED_WIN:
+		if (!s_noRule50)
+			break;
+		// Fallthrough
+	case TB_WIN:
+		return wtm? Chess::Side::White: Chess::Side::Black;
+	}
+
+	return Chess::Side::NoSide;
+}
+
 } // anonymous namespace
 
 bool SyzygyTablebase::initialize(const QString& path)
@@ -71,7 +151,8 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 					   Castling castling,
 					   int rule50,
 					   const PieceList& pieces,
-					   unsigned int* dtz)
+					   unsigned int* dtz,
+					   quint64 key)
 {
 	if (!s_initOK)
 		return Chess::Result();
@@ -80,6 +161,12 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 	if (pieces.size() > s_pieces)
 		return Chess::Result();
 
+	Chess::Side winner(Chess::Side::NoSide);
+	if (key != 0 && findCachedResult(key, rule50, dtz, &winner))
+		return Chess::Result(Chess::Result::Adjudication,
+				     winner,
+				     "SyzygyTB");
+
 	bool wtm = (side == Chess::Side::White);
 	unsigned ep = (tbSquare(enpassantSq) < 0? 0: tbSquare(enpassantSq));
 	uint64_t white = 0, black = 0;
@@ -113,12 +200,31 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 		}
 	}
 
-	s_mutex.lock();
+	// Without a DTZ request the WDL tables are enough, unless the
+	// 50-move rule can turn a win into a draw. Both probes are
+	// thread-safe, so concurrent games don't have to wait for
+	// each other.
+	if (dtz == nullptr)
+	{
+		unsigned wdl = tb_probe_wdl(white, black, kings, queens, rooks,
+			bishops, knights, pawns, 0, 0, ep, wtm);
+		if (wdl == TB_RESULT_FAILED)
+			return Chess::Result();
+		bool fixed = (wdl != TB_WIN && wdl != TB_LOSS) || s_noRule50;
+		if (fixed || rule50 == 0)
+		{
+			winner = tbWinner(wdl, wtm);
+			if (key != 0)
+				cacheResult(key, fixed ? -1 : 0, winner, false, 0);
+			return Chess::Result(Chess::Result::Adjudication,
+					     winner,
+					     "SyzygyTB");
+		}
+	}
+
 	unsigned result = tb_probe_root(white, black, kings, queens, rooks,
 		bishops, knights, pawns, rule50, 0, ep, wtm, nullptr);
-	s_mutex.unlock();
 
-	Chess::Side winner(Chess::Side::NoSide); 
 	if (result == TB_RESULT_FAILED)
 		return Chess::Result();
 	if (result == TB_RESULT_CHECKMATE)
@@ -126,28 +232,20 @@ Chess::Result SyzygyTablebase::result(const Chess::Side& side,
 	else if (result == TB_RESULT_STALEMATE)
 		winner = Chess::Side::NoSide;
 	else
-	{
-		switch (TB_GET_WDL(result))
-		{
-		case TB_BLESSED_LOSS:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_LOSS:
-			winner = (wtm? Chess::Side::Black: Chess::Side::White);
-			break;
-		case TB_DRAW:
-			break;
-		case TB_CURSED_WIN:
-			if (!s_noRule50)
-				break;
-			// Fallthrough
-		case TB_WIN:
-			winner = (wtm? Chess::Side::White: Chess::Side::Black);
-			break;
-		}
-	}
+		winner = tbWinner(TB_GET_WDL(result), wtm);
+	if (key != 0)
+		cacheResult(key, rule50, winner, true, TB_GET_DTZ(result));
 	if (dtz != nullptr)
 		*dtz = TB_GET_DTZ(result);
 	return Chess::Result(Chess::Result::Adjudication, winner, "SyzygyTB");
 }
+
+quint64 SyzygyTablebase::cacheHits()
+{
+	return s_cacheHits;
+}
+
+quint64 SyzygyTablebase::cacheMisses()
+{
+	return s_cacheMisses;
+}
@@ -36,6 +36,10 @@
  * positions. The Syzygy tablebases take the 50-move-rule into account.
  * Syzygy tablebases can only be used in standard chess and Fischer
  * Random chess.
+ *
+ * Probe results are kept in a fixed-size cache that is shared by all
+ * games, so positions that are reached again don't have to be probed
+ * from the tablebase files.
  */
 class LIB_EXPORT SyzygyTablebase
 {
@@ -83,11 +87,20 @@ class LIB_EXPORT SyzygyTablebase
 		 *
 		 * If the position is a win for either player, \a dtz is
 		 * set to the distance to zero, ie. the number of plies it
-		 * takes to force a non-reversible move or mate.
+		 * takes to force a non-reversible move or mate. If \a dtz
+		 * is null, only the cheaper WDL tables are probed whenever
+		 * they are enough to tell the result.
 		 *
 		 * If the position isn't found in the tablebases, a null result
 		 * is returned.
 		 *
+		 * If \a key is not zero, it's used as the Zobrist key of the
+		 * position for looking up and storing the result in the
+		 * result cache. Results that the 50-move rule can't change
+		 * are shared by all values of \a rule50.
+		 *
+		 * This function is thread-safe.
+		 *
 		 * \sa Chess::Board::tablebaseResult()
 		 */
 		static Chess::Result result(const Chess::Side& side,
@@ -95,7 +108,15 @@ class LIB_EXPORT SyzygyTablebase
 					    Castling castling,
 					    int rule50,
 					    const PieceList& pieces,
-					    unsigned int* dtz = nullptr);
+					    unsigned int* dtz = nullptr,
+					    quint64 key = 0);
+		/*! Returns the number of results found in the result cache. */
+		static quint64 cacheHits();
+		/*!
+		 * Returns the number of cache lookups that had to probe
+		 * the tablebases.
+		 */
+		static quint64 cacheMisses();
 
 	private:
 		SyzygyTablebase();
@@ -19,6 +19,7 @@
 #include <QStringList>
 #include "westernzobrist.h"
 #include "boardtransition.h"
+#include "bitboard.h"
 
 
 namespace Chess {
@@ -35,6 +36,7 @@ WesternBoard::WesternBoard(WesternZobrist* zobrist)
 	  m_hasCastling(true),
 	  m_pawnHasDoubleStep(true),
 	  m_hasEnPassantCaptures(true),
+	  m_hasStandardMoveRules(false),
 	  m_pawnAmbiguous(false),
 	  m_multiDigitNotation(false),
 	  m_zobrist(zobrist)
@@ -86,6 +88,11 @@ bool WesternBoard::hasEnPassantCaptures() const
 	return pawnHasDoubleStep();
 }
 
+bool WesternBoard::hasStandardMoveRules() const
+{
+	return false;
+}
+
 bool WesternBoard::variantHasChanneling(Side, int) const
 {
 	return false;
@@ -97,6 +104,8 @@ void WesternBoard::vInitialize()
 	m_hasCastling = hasCastling();
 	m_pawnHasDoubleStep = pawnHasDoubleStep();
 	m_hasEnPassantCaptures = hasEnPassantCaptures();
+	m_hasStandardMoveRules = hasStandardMoveRules()
+			      && width() == 8 && height() == 8;
 
 	m_arwidth = width() + 2;
 
@@ -1378,6 +1387,61 @@ void WesternBoard::generateCastlingMoves(QVarLengthArray<Move>& moves) const
 	}
 }
 
+void WesternBoard::fillBitboard(Bitboard& bitboard) const
+{
+	for (int sq = 0; sq < 64; sq++)
+	{
+		Piece piece = pieceAt(Bitboard::boardIndex(sq));
+		if (piece.isValid())
+			bitboard.setPiece(sq, piece.side(), piece.type());
+	}
+
+	Side side = sideToMove();
+	bitboard.setSideToMove(side);
+
+	if (m_enpassantSquare != 0)
+		bitboard.setEnpassantSquare(Bitboard::square(m_enpassantSquare),
+					    Bitboard::square(m_enpassantTarget));
+
+	for (int i = QueenSide; i <= KingSide; i++)
+	{
+		int rookSq = m_castlingRights.rookSquare[side][i];
+		if (rookSq == 0)
+			continue;
+
+		int target = m_castleTarget[side][i];
+		int rtarget = (i == QueenSide) ? target + 1 : target - 1;
+		bitboard.setCastling(side, i,
+				     Bitboard::square(rookSq),
+				     Bitboard::square(target),
+				     Bitboard::square(rtarget));
+	}
+}
+
+bool WesternBoard::canMove()
+{
+	if (!m_hasStandardMoveRules)
+		return Board::canMove();
+
+	Bitboard bitboard;
+	fillBitboard(bitboard);
+	return bitboard.hasLegalMoves();
+}
+
+QVector<Move> WesternBoard::legalMoves()
+{
+	if (!m_hasStandardMoveRules)
+		return Board::legalMoves();
+
+	Bitboard bitboard;
+	fillBitboard(bitboard);
+
+	QVarLengthArray<Move> moves;
+	bitboard.generateLegalMoves(moves);
+
+	return QVector<Move>(moves.constBegin(), moves.constEnd());
+}
+
 int WesternBoard::kingSquare(Side side) const
 {
 	Q_ASSERT(!side.isNull());
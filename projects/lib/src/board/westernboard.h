@@ -23,6 +23,7 @@
 namespace Chess {
 
 class WesternZobrist;
+class Bitboard;
 
 
 /*!
@@ -60,6 +61,7 @@ class LIB_EXPORT WesternBoard : public Board
 		virtual Result result();
 		virtual int reversibleMoveCount() const;
 		virtual bool winPossible(Side side) const;
+		virtual QVector<Move> legalMoves();
 
 	protected:
 		/*! The king's castling side. */
@@ -135,6 +137,17 @@ class LIB_EXPORT WesternBoard : public Board
 		 * The default value is the value of pawnHasDoubleStep().
 		 */
 		virtual bool hasEnPassantCaptures() const;
+		/*!
+		 * Returns true if the variant is played on an 8x8 board with
+		 * one king per side, and all pieces move, capture and promote
+		 * exactly like in standard chess.
+		 *
+		 * Legal moves are then generated with bitboards instead of
+		 * testing every pseudo-legal move with vIsLegalMove().
+		 * The default value is false.
+		 * \sa StandardBoard
+		 */
+		virtual bool hasStandardMoveRules() const;
 		/*!
 		 * Returns true if a rule provides \a side to insert a reserve
 		 * piece at a vacated source \a square immediately after a move.
@@ -224,6 +237,7 @@ class LIB_EXPORT WesternBoard : public Board
 		virtual bool vIsLegalMove(const Move& move);
 		virtual bool isLegalPosition();
 		virtual int captureType(const Move& move) const;
+		virtual bool canMove();
 
 	private:
 		struct CastlingRights
@@ -245,6 +259,7 @@ class LIB_EXPORT WesternBoard : public Board
 		};
 
 		void generateCastlingMoves(QVarLengthArray<Move>& moves) const;
+		void fillBitboard(Bitboard& bitboard) const;
 		void generatePawnMoves(int sourceSquare,
 				       QVarLengthArray<Move>& moves) const;
 
@@ -272,6 +287,7 @@ class LIB_EXPORT WesternBoard : public Board
 		bool m_hasCastling;
 		bool m_pawnHasDoubleStep;
 		bool m_hasEnPassantCaptures;
+		bool m_hasStandardMoveRules;
 		bool m_pawnAmbiguous;
 		bool m_multiDigitNotation;
 		QVector<MoveData> m_history;
@@ -0,0 +1,537 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "bookbuilder.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <QDataStream>
+#include <QFile>
+#include <QFuture>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include "pgngame.h"
+#include "pgnstream.h"
+#include "polyglotbook.h"
+
+namespace {
+
+// The number of games in a range added with BookBuilder::addGame()
+const int s_gamesPerRange = 1024;
+// The minimum size of a range of a file added with addFile()
+const qint64 s_minRangeSize = 4 * 1024 * 1024;
+// The number of tuples read from a run file at a time
+const int s_runBlockSize = 4096;
+// The maximum number of run files merged at a time
+const int s_mergeFanIn = 64;
+
+/*
+ * Returns true if a game begins at index \a i of \a data, ie. there
+ * is an Event tag after an empty line.
+ */
+bool isGameStart(const QByteArray& data, int i)
+{
+	int j = i - 1;
+	if (j < 1 || data.at(j) != '\n')
+		return false;
+	if (data.at(j - 1) == '\r')
+		j--;
+	return j >= 1 && data.at(j - 1) == '\n';
+}
+
+/*
+ * Returns the position of the first game in \a file that begins at
+ * or after \a pos, or the file size if there isn't one.
+ */
+qint64 nextGameStart(QFile* file, qint64 pos)
+{
+	if (pos <= 0)
+		return 0;
+
+	// Include the end of the preceding line
+	qint64 dataPos = qMax(pos - 3, qint64(0));
+	if (!file->seek(dataPos))
+		return file->size();
+
+	QByteArray data;
+	int from = 0;
+	for (;;)
+	{
+		const QByteArray block = file->read(64 * 1024);
+		if (block.isEmpty())
+			return file->size();
+		data.append(block);
+
+		int i;
+		while ((i = data.indexOf("[Event", from)) != -1)
+		{
+			from = i + 1;
+			if (dataPos + i >= pos && isGameStart(data, i))
+				return dataPos + i;
+		}
+
+		// Keep enough data to see the blank line before the
+		// next Event tag
+		const int keep = qMin(data.size(), 8);
+		dataPos += data.size() - keep;
+		data = data.right(keep);
+		from = 0;
+	}
+}
+
+} // anonymous namespace
+
+BookBuilder::BookBuilder(int maxDepth, QObject* parent)
+	: QObject(parent),
+	  m_maxDepth(maxDepth),
+	  m_threadCount(QThread::idealThreadCount()),
+	  m_memoryLimit(256 * 1024 * 1024),
+	  m_tempDir(nullptr)
+{
+	Q_ASSERT(maxDepth > 0);
+	m_threadCount = qMax(m_threadCount, 1);
+}
+
+BookBuilder::~BookBuilder()
+{
+}
+
+void BookBuilder::setThreadCount(int count)
+{
+	m_threadCount = qMax(count, 1);
+}
+
+void BookBuilder::setMemoryLimit(qint64 bytes)
+{
+	m_memoryLimit = bytes;
+}
+
+void BookBuilder::addFile(const QString& fileName)
+{
+	m_files.append(fileName);
+}
+
+void BookBuilder::addGame(const QString& fileName, qint64 pos, qint64 lineNumber)
+{
+	if (m_ranges.isEmpty()
+	||  m_ranges.last().fileName != fileName
+	||  m_ranges.last().games.size() >= s_gamesPerRange)
+	{
+		Range range;
+		range.fileName = fileName;
+		range.begin = 0;
+		range.end = 0;
+		m_ranges.append(range);
+	}
+
+	m_ranges.last().games.append(qMakePair(pos, lineNumber));
+}
+
+int BookBuilder::gameCount() const
+{
+	return m_gameCount.loadAcquire();
+}
+
+QString BookBuilder::errorString() const
+{
+	return m_error;
+}
+
+void BookBuilder::cancel()
+{
+	m_cancelled.storeRelease(1);
+}
+
+void BookBuilder::setError(const QString& error)
+{
+	QMutexLocker locker(&m_mutex);
+	if (m_error.isEmpty())
+		m_error = error;
+}
+
+bool BookBuilder::build(const QString& fileName)
+{
+	QTemporaryDir tempDir;
+	if (!tempDir.isValid())
+	{
+		m_error = tr("Could not create a temporary directory");
+		return false;
+	}
+
+	m_tempDir = &tempDir;
+	m_error.clear();
+	m_cancelled.storeRelease(0);
+	m_runs.clear();
+	m_nextRange.storeRelease(0);
+	m_gameCount.storeRelease(0);
+
+	splitFiles();
+	parseRanges();
+
+	emit mergeStarted();
+	const bool ok = m_error.isEmpty() && mergeRuns(fileName);
+
+	m_runs.clear();
+	m_tempDir = nullptr;
+	return ok;
+}
+
+void BookBuilder::splitFiles()
+{
+	// Split the files into ranges that begin at game boundaries
+	for (const QString& fileName : qAsConst(m_files))
+	{
+		QFile file(fileName);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			setError(tr("Could not open file %1").arg(fileName));
+			continue;
+		}
+
+		const qint64 size = file.size();
+		const qint64 rangeSize = qMax(s_minRangeSize,
+					      size / (m_threadCount * 4));
+		qint64 begin = 0;
+		while (begin < size)
+		{
+			const qint64 end = nextGameStart(&file, begin + rangeSize);
+
+			Range range;
+			range.fileName = fileName;
+			range.begin = begin;
+			range.end = end;
+			m_ranges.append(range);
+
+			begin = end;
+		}
+	}
+	m_files.clear();
+}
+
+void BookBuilder::parseRanges()
+{
+	QThreadPool pool;
+	pool.setMaxThreadCount(m_threadCount);
+
+	const int bufferSize = int(qBound(qint64(1),
+		m_memoryLimit / m_threadCount / qint64(sizeof(Tuple)),
+		qint64(INT_MAX / sizeof(Tuple))));
+
+	QList< QFuture<void> > futures;
+	for (int i = 0; i < m_threadCount; i++)
+	{
+		futures << QtConcurrent::run(&pool, [=]()
+		{
+			// Each thread has its own tuple buffer
+			QVector<Tuple> buffer;
+			for (;;)
+			{
+				const int index = m_nextRange.fetchAndAddRelaxed(1);
+				if (index >= m_ranges.size()
+				||  m_cancelled.loadAcquire()
+				||  !parseRange(m_ranges.at(index), buffer, bufferSize))
+					break;
+			}
+			writeRun(buffer);
+		});
+	}
+
+	for (auto& future : futures)
+		future.waitForFinished();
+	m_ranges.clear();
+}
+
+void BookBuilder::addTuples(const PgnGame& game, QVector<Tuple>& buffer) const
+{
+	// Skip the loser's moves like OpeningBook::import() does
+	const Chess::Side winner(game.result().winner());
+	int loserMod = -1;
+	quint32 weight = 1;
+	if (!winner.isNull())
+	{
+		loserMod = int(game.startingSide() == winner);
+		weight = 2;
+	}
+
+	const auto& moves = game.moves();
+	const int n = qMin(m_maxDepth, moves.size());
+	for (int i = 0; i < n; i++)
+	{
+		if ((i % 2) == loserMod)
+			continue;
+
+		const Tuple tuple = {
+			moves.at(i).key,
+			PolyglotBook::encodeMove(moves.at(i).move),
+			0,
+			weight
+		};
+		buffer.append(tuple);
+	}
+}
+
+bool BookBuilder::parseRange(const Range& range,
+			     QVector<Tuple>& buffer,
+			     int bufferSize)
+{
+	QFile file(range.fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		setError(tr("Could not open file %1").arg(range.fileName));
+		return false;
+	}
+	PgnStream in(&file);
+
+	int i = 0;
+	while (!m_cancelled.loadAcquire())
+	{
+		PgnGame game;
+		if (range.games.isEmpty())
+		{
+			// Read the games that begin inside the range
+			if (i == 0 && !in.seek(range.begin))
+				break;
+			if (!in.nextGame() || in.pos() >= range.end)
+				break;
+		}
+		else
+		{
+			if (i >= range.games.size())
+				break;
+			const auto& pos = range.games.at(i);
+			if (!in.seek(pos.first, pos.second))
+			{
+				i++;
+				continue;
+			}
+		}
+		i++;
+
+		if (!game.read(in, m_maxDepth, false))
+		{
+			if (range.games.isEmpty())
+				break;
+			continue;
+		}
+
+		addTuples(game, buffer);
+		if (buffer.size() >= bufferSize && !writeRun(buffer))
+			return false;
+
+		const int count = m_gameCount.fetchAndAddRelaxed(1) + 1;
+		if (count % 512 == 0)
+			emit progressChanged(count);
+	}
+
+	return true;
+}
+
+bool BookBuilder::writeRun(QVector<Tuple>& buffer)
+{
+	if (buffer.isEmpty())
+		return true;
+
+	// Sort the tuples and merge the ones with the same key and move
+	std::sort(buffer.begin(), buffer.end(), [](const Tuple& a, const Tuple& b)
+	{
+		return a.key < b.key || (a.key == b.key && a.move < b.move);
+	});
+
+	int size = 0;
+	for (const Tuple& tuple : qAsConst(buffer))
+	{
+		if (size > 0
+		&&  buffer.at(size - 1).key == tuple.key
+		&&  buffer.at(size - 1).move == tuple.move)
+			buffer[size - 1].weight += tuple.weight;
+		else
+			buffer[size++] = tuple;
+	}
+
+	QString fileName;
+	{
+		QMutexLocker locker(&m_mutex);
+		fileName = m_tempDir->filePath(QString("run%1.bin").arg(m_runs.size()));
+		m_runs.append(fileName);
+	}
+
+	QFile file(fileName);
+	const qint64 bytes = qint64(size) * sizeof(Tuple);
+	const bool ok = file.open(QIODevice::WriteOnly)
+		&& file.write(reinterpret_cast<const char*>(buffer.constData()),
+			      bytes) == bytes;
+
+	// Keep the capacity for the next run
+	buffer.resize(0);
+
+	if (!ok)
+		setError(tr("Could not write temporary file %1").arg(fileName));
+	return ok;
+}
+
+bool BookBuilder::mergeRuns(const QString& fileName)
+{
+	// Merge at most s_mergeFanIn runs at a time, so that a large
+	// import doesn't run out of file descriptors
+	for (int pass = 0; m_runs.size() > s_mergeFanIn; pass++)
+	{
+		QStringList runs;
+		for (int i = 0; i < m_runs.size(); i += s_mergeFanIn)
+		{
+			const QStringList inputs(m_runs.mid(i, s_mergeFanIn));
+			if (inputs.size() == 1)
+			{
+				runs.append(inputs.first());
+				continue;
+			}
+
+			const QString run(m_tempDir->filePath(
+				QString("merge%1_%2.bin").arg(pass).arg(runs.size())));
+			if (!mergeFiles(inputs, run, false))
+				return false;
+			runs.append(run);
+
+			for (const QString& input : inputs)
+				QFile::remove(input);
+		}
+		m_runs = runs;
+	}
+
+	return mergeFiles(m_runs, fileName, true);
+}
+
+bool BookBuilder::mergeFiles(const QStringList& runs,
+			     const QString& fileName,
+			     bool polyglot)
+{
+	QFile out(fileName);
+	if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		m_error = tr("Could not open file %1").arg(fileName);
+		return false;
+	}
+	QDataStream stream(&out);
+
+	const int runCount = runs.size();
+	QList<QFile*> files;
+	QVector< QVector<Tuple> > blocks(runCount);
+	QVector<int> positions(runCount, 0);
+	QVector<Tuple> outBlock;
+
+	// Reads the next block of run \a i, returns false at the end
+	auto readBlock = [&](int i)
+	{
+		QVector<Tuple>& block = blocks[i];
+		block.resize(s_runBlockSize);
+		const qint64 bytes = files.at(i)->read(
+			reinterpret_cast<char*>(block.data()),
+			qint64(s_runBlockSize) * sizeof(Tuple));
+		block.resize(int(qMax(bytes, qint64(0)) / qint64(sizeof(Tuple))));
+		positions[i] = 0;
+		return !block.isEmpty();
+	};
+
+	// A min-heap of the runs ordered by their current tuples
+	auto greater = [&](int a, int b)
+	{
+		const Tuple& ta = blocks.at(a).at(positions.at(a));
+		const Tuple& tb = blocks.at(b).at(positions.at(b));
+		return ta.key > tb.key || (ta.key == tb.key && ta.move > tb.move);
+	};
+	std::priority_queue<int, std::vector<int>, std::function<bool(int, int)>>
+		heap(greater);
+
+	bool ok = true;
+	for (int i = 0; i < runCount; i++)
+	{
+		QFile* file = new QFile(runs.at(i));
+		files.append(file);
+		if (!file->open(QIODevice::ReadOnly))
+		{
+			m_error = tr("Could not read temporary file %1").arg(runs.at(i));
+			ok = false;
+			break;
+		}
+		if (readBlock(i))
+			heap.push(i);
+	}
+
+	// Intermediate runs keep the tuple format, the last pass
+	// writes the book
+	auto flush = [&]()
+	{
+		const qint64 bytes = qint64(outBlock.size()) * sizeof(Tuple);
+		if (out.write(reinterpret_cast<const char*>(outBlock.constData()),
+			      bytes) != bytes)
+			ok = false;
+		outBlock.resize(0);
+	};
+	auto writeTuple = [&](const Tuple& tuple)
+	{
+		if (!polyglot)
+		{
+			outBlock.append(tuple);
+			if (outBlock.size() >= s_runBlockSize)
+				flush();
+			return;
+		}
+
+		const quint16 weight = quint16(qMin(tuple.weight, quint32(0xFFFF)));
+		const quint32 learn = 0;
+
+		// Polyglot entries are big-endian, which is the default
+		// byte order of QDataStream
+		stream << tuple.key << tuple.move << weight << learn;
+	};
+
+	bool haveTuple = false;
+	Tuple current = { 0, 0, 0, 0 };
+	while (ok && !heap.empty())
+	{
+		const int i = heap.top();
+		heap.pop();
+
+		const Tuple& tuple = blocks.at(i).at(positions.at(i));
+		if (haveTuple && current.key == tuple.key && current.move == tuple.move)
+			current.weight += tuple.weight;
+		else
+		{
+			if (haveTuple)
+				writeTuple(current);
+			current = tuple;
+			haveTuple = true;
+		}
+
+		if (++positions[i] < blocks.at(i).size() || readBlock(i))
+			heap.push(i);
+	}
+	if (ok && haveTuple)
+		writeTuple(current);
+	if (ok && !outBlock.isEmpty())
+		flush();
+
+	qDeleteAll(files);
+
+	if (ok && stream.status() != QDataStream::Ok)
+		ok = false;
+	if (!ok && m_error.isEmpty())
+		m_error = tr("Could not write file %1").arg(fileName);
+	return ok;
+}
@@ -0,0 +1,162 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BOOKBUILDER_H
+#define BOOKBUILDER_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+class QTemporaryDir;
+class PgnGame;
+
+/*!
+ * \brief Builds Polyglot opening books from PGN games.
+ *
+ * BookBuilder parses ranges of PGN games in parallel. Every worker
+ * thread collects (key, move, weight) tuples into its own buffer, and
+ * when the buffer is full it is sorted and written to a temporary run
+ * file. Finally the runs are merged into the book with an external
+ * merge sort, at most 64 runs at a time, so books much larger than
+ * the available memory can be built.
+ *
+ * The moves are weighted like in OpeningBook::import(): a winning
+ * move has a weight of 2 and a drawing move has a weight of 1. The
+ * moves of the losing side are not included.
+ *
+ * \sa PolyglotBook
+ */
+class LIB_EXPORT BookBuilder : public QObject
+{
+	Q_OBJECT
+
+	public:
+		/*!
+		 * Creates a new BookBuilder that includes the first
+		 * \a maxDepth plies of every game.
+		 */
+		BookBuilder(int maxDepth, QObject* parent = nullptr);
+		/*! Destroys the builder. */
+		virtual ~BookBuilder();
+
+		/*!
+		 * Sets the number of worker threads to \a count.
+		 *
+		 * The default is the number of CPU cores.
+		 */
+		void setThreadCount(int count);
+		/*!
+		 * Sets the approximate amount of memory used for the
+		 * tuple buffers of all threads to \a bytes.
+		 *
+		 * A thread writes a new run file whenever its buffer is
+		 * full, so a tiny limit writes a run for every game.
+		 */
+		void setMemoryLimit(qint64 bytes);
+
+		/*! Adds all the games in PGN file \a fileName. */
+		void addFile(const QString& fileName);
+		/*!
+		 * Adds the game at position \a pos and line \a lineNumber
+		 * in PGN file \a fileName.
+		 *
+		 * Consecutive games in the same file are parsed together,
+		 * so games should be added in file order when possible.
+		 */
+		void addGame(const QString& fileName, qint64 pos, qint64 lineNumber);
+
+		/*!
+		 * Builds the book and writes it to \a fileName.
+		 *
+		 * This function blocks until the book is written or the
+		 * build is cancelled. Returns true if successful; otherwise
+		 * returns false.
+		 */
+		bool build(const QString& fileName);
+		/*! Returns the number of games that were parsed by build(). */
+		int gameCount() const;
+		/*! Returns a description of the last error. */
+		QString errorString() const;
+
+	public slots:
+		/*!
+		 * Stops parsing games. The games that were already parsed
+		 * are still written to the book.
+		 *
+		 * Only the build in progress is cancelled; the next call
+		 * to build() starts over.
+		 */
+		void cancel();
+
+	signals:
+		/*!
+		 * Emitted periodically with the number of parsed games in
+		 * \a gameCount.
+		 *
+		 * \note This signal is emitted from the worker threads.
+		 */
+		void progressChanged(int gameCount);
+		/*! Emitted when the parsed games are merged into the book. */
+		void mergeStarted();
+
+	private:
+		struct Tuple
+		{
+			quint64 key;
+			quint16 move;
+			quint16 reserved;
+			quint32 weight;
+		};
+		struct Range
+		{
+			QString fileName;
+			qint64 begin;
+			qint64 end;
+			QVector< QPair<qint64, qint64> > games;
+		};
+
+		void splitFiles();
+		void parseRanges();
+		bool parseRange(const Range& range,
+				QVector<Tuple>& buffer,
+				int bufferSize);
+		void addTuples(const PgnGame& game, QVector<Tuple>& buffer) const;
+		bool writeRun(QVector<Tuple>& buffer);
+		bool mergeRuns(const QString& fileName);
+		bool mergeFiles(const QStringList& runs,
+				const QString& fileName,
+				bool polyglot);
+		void setError(const QString& error);
+
+		int m_maxDepth;
+		int m_threadCount;
+		qint64 m_memoryLimit;
+		QStringList m_files;
+		QVector<Range> m_ranges;
+		QTemporaryDir* m_tempDir;
+		QStringList m_runs;
+		QMutex m_mutex;
+		QAtomicInt m_nextRange;
+		QAtomicInt m_gameCount;
+		QAtomicInt m_cancelled;
+		QString m_error;
+};
+
+#endif // BOOKBUILDER_H
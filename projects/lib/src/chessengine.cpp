@@ -18,11 +18,40 @@
 
 #include "chessengine.h"
 #include <QIODevice>
+#include <QProcess>
 #include <QTimer>
 #include <QStringRef>
 #include <QtAlgorithms>
+#include <cstring>
 #include "engineoption.h"
 
+namespace {
+
+/*!
+ * Decodes \a size bytes of \a data into \a line.
+ *
+ * Engine output is nearly always plain ASCII, which is widened in
+ * place so that \a line reuses its buffer from the previous line.
+ * Anything else is decoded as UTF-8.
+ */
+void decodeLine(const char* data, int size, QString& line)
+{
+	line.resize(size);
+	QChar* out = line.data();
+	for (int i = 0; i < size; i++)
+	{
+		const uchar c = uchar(data[i]);
+		if (c >= 0x80)
+		{
+			line = QString::fromUtf8(data, size);
+			return;
+		}
+		out[i] = QLatin1Char(char(c));
+	}
+}
+
+} // anonymous namespace
+
 
 int ChessEngine::s_count = 0;
 
@@ -120,6 +149,32 @@ void ChessEngine::setDevice(QIODevice* device)
 
 	connect(m_ioDevice, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
 	connect(m_ioDevice, SIGNAL(readChannelFinished()), this, SLOT(onCrashed()));
+
+	// Buffered devices hand the data to the OS later, so the clock
+	// starts when the write buffer has been flushed
+	connect(m_ioDevice, &QIODevice::bytesWritten, this, [=]()
+	{
+		if (m_ioDevice->bytesToWrite() == 0)
+			stampMoveRequest();
+	});
+
+	// QProcess reports a command that can't be executed only after
+	// start() has returned, so treat it like a crash during startup
+	QProcess* process = qobject_cast<QProcess*>(m_ioDevice);
+	if (process != nullptr)
+	{
+		connect(process, &QProcess::errorOccurred, this,
+			[=](QProcess::ProcessError error)
+		{
+			if (error != QProcess::FailedToStart
+			||  state() == Disconnected)
+				return;
+
+			setError(tr("Cannot execute command: %1")
+				 .arg(process->program()));
+			onCrashed();
+		});
+	}
 }
 
 void ChessEngine::applyConfiguration(const EngineConfiguration& configuration)
@@ -298,6 +353,13 @@ bool ChessEngine::isReady() const
 	return ChessPlayer::isReady();
 }
 
+bool ChessEngine::isReusable() const
+{
+	if (restartsBetweenGames() || m_quitTimer->isActive())
+		return false;
+	return ChessPlayer::isReusable();
+}
+
 bool ChessEngine::supportsVariant(const QString& variant) const
 {
 	return m_variants.contains(variant);
@@ -432,33 +494,61 @@ void ChessEngine::write(const QString& data, WriteMode mode)
 	}
 
 	Q_ASSERT(m_ioDevice->isWritable());
-	emit debugMessage(QString(">%1(%2): %3")
-			  .arg(name())
-			  .arg(m_id)
-			  .arg(data));
+	if (hasDebugReceivers())
+		emit debugMessage(QString(">%1(%2): %3")
+				  .arg(name())
+				  .arg(m_id)
+				  .arg(data));
 
 	if (m_ioDevice->write(data.toLatin1() + "\n") == -1)
 		qWarning("Writing to engine %s(%d) failed",
 			 qUtf8Printable(name()), m_id);
+	else if (m_ioDevice->bytesToWrite() == 0)
+		stampMoveRequest();
 }
 
 void ChessEngine::onReadyRead()
 {
-	while (m_ioDevice->isReadable() && m_ioDevice->canReadLine())
+	if (!m_ioDevice->isReadable())
+		return;
+	stampMoveReply();
+
+	// Append the available input to the read buffer, which keeps its
+	// capacity between calls
+	const qint64 available = m_ioDevice->bytesAvailable();
+	if (available > 0)
 	{
-		QString line = QString(m_ioDevice->readLine());
-		if (line.endsWith('\n'))
-			line.chop(1);
-		if (line.endsWith('\r'))
-			line.chop(1);
-		if (line.isEmpty())
+		const int oldSize = m_readBuffer.size();
+		m_readBuffer.resize(oldSize + int(available));
+		const qint64 n = m_ioDevice->read(m_readBuffer.data() + oldSize,
+						  available);
+		m_readBuffer.resize(oldSize + int(qMax(n, qint64(0))));
+	}
+
+	int start = 0;
+	while (m_ioDevice->isReadable())
+	{
+		const char* data = m_readBuffer.constData();
+		const char* newline = static_cast<const char*>(
+			memchr(data + start, '\n', m_readBuffer.size() - start));
+		if (newline == nullptr)
+			break;
+
+		int size = int(newline - data) - start;
+		if (size > 0 && data[start + size - 1] == '\r')
+			size--;
+		const int lineStart = start;
+		start = int(newline - data) + 1;
+		if (size == 0)
 			continue;
 
-		emit debugMessage(QString("<%1(%2): %3")
-				  .arg(name())
-				  .arg(m_id)
-				  .arg(line));
-		parseLine(line);
+		decodeLine(data + lineStart, size, m_line);
+		if (hasDebugReceivers())
+			emit debugMessage(QString("<%1(%2): %3")
+					  .arg(name())
+					  .arg(m_id)
+					  .arg(m_line));
+		parseLine(m_line);
 
 		if (m_idleTimer->isActive())
 		{
@@ -468,6 +558,7 @@ void ChessEngine::onReadyRead()
 				m_idleTimer->stop();
 		}
 	}
+	m_readBuffer.remove(0, start);
 }
 
 void ChessEngine::flushWriteBuffer()
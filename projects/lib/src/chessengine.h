@@ -61,13 +61,20 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 
 		/*! Returns the current device associated with the engine. */
 		QIODevice* device() const;
-		/*! Sets the current device to \a device. */
+		/*!
+		 * Sets the current device to \a device.
+		 *
+		 * The device can be set before it's opened. If \a device is
+		 * a QProcess that fails to start, the engine disconnects and
+		 * errorString() describes the failure.
+		 */
 		void setDevice(QIODevice* device);
 
 		// Inherited from ChessPlayer
 		virtual void endGame(const Chess::Result& result);
 		virtual bool isHuman() const;
 		virtual bool isReady() const;
+		virtual bool isReusable() const;
 		virtual bool supportsVariant(const QString& variant) const;
 
 		/*!
@@ -294,6 +301,8 @@ class LIB_EXPORT ChessEngine : public ChessPlayer
 		QTimer* m_idleTimer;
 		QTimer* m_protocolStartTimer;
 		QIODevice *m_ioDevice;
+		QByteArray m_readBuffer;
+		QString m_line;
 		QStringList m_writeBuffer;
 		QStringList m_variants;
 		QList<EngineOption*> m_options;
@@ -20,6 +20,7 @@
 #include <QTimer>
 #include "board/board.h"
 #include "chessplayer.h"
+#include "chessengine.h"
 #include "openingbook.h"
 #include "timecontrol.h"
 
@@ -38,16 +39,24 @@ QString evalString(const MoveEvaluation& eval)
 
 	int t = eval.time();
 	if (t == 0)
-		return str + "0s";
+		str += "0s";
+	else
+	{
+		int precision = 0;
+		if (t < 100)
+			precision = 3;
+		else if (t < 1000)
+			precision = 2;
+		else if (t < 10000)
+			precision = 1;
+		str += QString::number(double(t / 1000.0), 'f', precision) + 's';
+	}
 
-	int precision = 0;
-	if (t < 100)
-		precision = 3;
-	else if (t < 1000)
-		precision = 2;
-	else if (t < 10000)
-		precision = 1;
-	str += QString::number(double(t / 1000.0), 'f', precision) + 's';
+	// Only report latency that is big enough to matter
+	int latency = eval.latency();
+	if (latency >= 1000)
+		str += QString(", latency %1ms")
+		       .arg(QString::number(latency / 1000.0, 'f', 1));
 
 	return str;
 }
@@ -139,6 +148,18 @@ const QMap<int,int>& ChessGame::scores() const
 	return m_scores;
 }
 
+const QVector<int>& ChessGame::moveTimes(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_moveTimes[side];
+}
+
+const QVector<int>& ChessGame::moveLatencies(Chess::Side side) const
+{
+	Q_ASSERT(!side.isNull());
+	return m_moveLatencies[side];
+}
+
 Chess::Result ChessGame::result() const
 {
 	return m_result;
@@ -261,7 +282,15 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 		return;
 	}
 
-	m_scores[m_moves.size()] = sender->evaluation().score();
+	const MoveEvaluation& eval = sender->evaluation();
+	if (!eval.isBookEval())
+	{
+		const Chess::Side side = m_board->sideToMove();
+		m_moveTimes[side].append(eval.time());
+		m_moveLatencies[side].append(eval.latency());
+	}
+
+	m_scores[m_moves.size()] = eval.score();
 	m_moves.append(move);
 	addPgnMove(move, evalString(sender->evaluation()));
 
@@ -285,6 +314,7 @@ void ChessGame::onMoveMade(const Chess::Move& move)
 
 	player->makeMove(move);
 	m_board->makeMove(move);
+	m_pgn->updateEco(m_board->key());
 
 	if (m_result.isNone())
 	{
@@ -529,6 +559,13 @@ void ChessGame::setStartDelay(int time)
 	m_startDelay = time;
 }
 
+void ChessGame::setEngineOptions(Chess::Side side,
+				 const QVariantMap& options)
+{
+	Q_ASSERT(!side.isNull());
+	m_engineOptions[side] = options;
+}
+
 void ChessGame::setBookOwnership(bool enabled)
 {
 	m_bookOwnership = enabled;
@@ -639,6 +676,15 @@ void ChessGame::start()
 	{
 		connect(m_player[i], SIGNAL(resultClaim(Chess::Result)),
 			this, SLOT(onResultClaim(Chess::Result)));
+
+		// Engines that are reused between games get the options
+		// before the new game is set up
+		ChessEngine* engine = qobject_cast<ChessEngine*>(m_player[i]);
+		if (engine == nullptr)
+			continue;
+		for (auto it = m_engineOptions[i].constBegin();
+		     it != m_engineOptions[i].constEnd(); ++it)
+			engine->setOption(it.key(), it.value());
 	}
 
 	// Start the game in the correct thread
@@ -750,6 +796,7 @@ void ChessGame::startGame()
 		playerToMove()->makeBookMove(move);
 		playerToWait()->makeMove(move);
 		m_board->makeMove(move);
+		m_pgn->updateEco(m_board->key());
 		
 		emitLastMove();
 
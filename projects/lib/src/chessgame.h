@@ -22,6 +22,7 @@
 #include <QVector>
 #include <QStringList>
 #include <QMap>
+#include <QVariant>
 #include <QSemaphore>
 #include "pgngame.h"
 #include "board/result.h"
@@ -56,6 +57,10 @@ class LIB_EXPORT ChessGame : public QObject
 		QString startingFen() const;
 		const QVector<Chess::Move>& moves() const;
 		const QMap<int,int>& scores() const;
+		// Thinking times (ms) and transport latencies (us) of the
+		// non-book moves made by the player on a side
+		const QVector<int>& moveTimes(Chess::Side side) const;
+		const QVector<int>& moveLatencies(Chess::Side side) const;
 		Chess::Result result() const;
 
 		void setError(const QString& message);
@@ -71,9 +76,16 @@ class LIB_EXPORT ChessGame : public QObject
 		void setAdjudicator(const GameAdjudicator& adjudicator);
 		void setStartDelay(int time);
 		void setBookOwnership(bool enabled);
+		void setEngineOptions(Chess::Side side,
+				      const QVariantMap& options);
 
 		void generateOpening();
 
+		// Pauses the game's thread until unlockThread() is called,
+		// so that the game can be read from another thread. A thread
+		// shared by several games (GameManager::setWorkerThreadCount())
+		// pauses all of them, so the lock should only be held while
+		// copying data from the game.
 		void lockThread();
 		void unlockThread();
 
@@ -127,6 +139,7 @@ class LIB_EXPORT ChessGame : public QObject
 		TimeControl m_timeControl[2];
 		const OpeningBook* m_book[2];
 		int m_bookDepth[2];
+		QVariantMap m_engineOptions[2];
 		int m_startDelay;
 		bool m_finished;
 		bool m_gameInProgress;
@@ -139,6 +152,8 @@ class LIB_EXPORT ChessGame : public QObject
 		Chess::Result m_result;
 		QVector<Chess::Move> m_moves;
 		QMap<int,int> m_scores;
+		QVector<int> m_moveTimes[2];
+		QVector<int> m_moveLatencies[2];
 		PgnGame* m_pgn;
 		QSemaphore m_pauseSem;
 		QSemaphore m_resumeSem;
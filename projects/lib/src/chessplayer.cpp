@@ -18,8 +18,28 @@
 
 #include "chessplayer.h"
 #include <QTimer>
+#include <QMetaMethod>
 #include "board/board.h"
 
+namespace {
+
+/*
+ * Returns the time in nanoseconds until the active clock of
+ * \a timeControl runs out of time and expiry margin.
+ */
+qint64 timeToFlag(const TimeControl& timeControl)
+{
+	return timeControl.activeTimeLeftNsecs()
+	       + qint64(timeControl.expiryMargin()) * 1000000;
+}
+
+// Returns \a nsecs rounded up to whole milliseconds
+int toMsecs(qint64 nsecs)
+{
+	return int((qMax(nsecs, qint64(0)) + 999999) / 1000000);
+}
+
+} // anonymous namespace
 
 ChessPlayer::ChessPlayer(QObject* parent)
 	: QObject(parent),
@@ -32,7 +52,8 @@ ChessPlayer::ChessPlayer(QObject* parent)
 	  m_opponent(nullptr)
 {
 	m_timer->setSingleShot(true);
-	connect(m_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+	m_timer->setTimerType(Qt::PreciseTimer);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(onClockTimeout()));
 }
 
 ChessPlayer::~ChessPlayer()
@@ -53,6 +74,11 @@ bool ChessPlayer::isReady() const
 	}
 }
 
+bool ChessPlayer::isReusable() const
+{
+	return m_state != Disconnected && !isHuman();
+}
+
 void ChessPlayer::newGame(Chess::Side side, ChessPlayer* opponent, Chess::Board* board)
 {
 	Q_ASSERT(opponent != nullptr);
@@ -129,8 +155,7 @@ void ChessPlayer::startClock()
 
 	if (!m_timeControl.isInfinite())
 	{
-		int t = m_timeControl.timeLeft() + m_timeControl.expiryMargin();
-		m_timer->start(qMax(t, 0) + 200);
+		m_timer->start(toMsecs(timeToFlag(m_timeControl)));
 	}
 }
 
@@ -205,6 +230,13 @@ void ChessPlayer::setError(const QString& error)
 	m_error = error;
 }
 
+bool ChessPlayer::hasDebugReceivers() const
+{
+	static const QMetaMethod signal =
+		QMetaMethod::fromSignal(&ChessPlayer::debugMessage);
+	return isSignalConnected(signal);
+}
+
 QString ChessPlayer::name() const
 {
 	return m_name;
@@ -280,6 +312,7 @@ void ChessPlayer::emitMove(const Chess::Move& move)
 
 	m_timeControl.update();
 	m_eval.setTime(m_timeControl.lastMoveTime());
+	m_eval.setLatency(int(m_timeControl.lastMoveLatency() / 1000));
 	m_eval.setIsTrusted(!areClaimsValidated());
 
 	m_timer->stop();
@@ -304,6 +337,34 @@ void ChessPlayer::onCrashed()
 	forfeit(Chess::Result::Disconnection);
 }
 
+void ChessPlayer::stampMoveRequest()
+{
+	if (m_state == Thinking)
+		m_timeControl.stampMoveRequest();
+}
+
+void ChessPlayer::stampMoveReply()
+{
+	if (m_state == Thinking)
+		m_timeControl.stampMoveReply();
+}
+
+void ChessPlayer::onClockTimeout()
+{
+	/*
+	 * The timer was started before the move request was sent, so
+	 * check the clock again in case the request was delayed.
+	 */
+	const qint64 t = timeToFlag(m_timeControl);
+	if (t > 0)
+	{
+		m_timer->start(toMsecs(t));
+		return;
+	}
+
+	onTimeout();
+}
+
 void ChessPlayer::onTimeout()
 {
 	if (!canPlayAfterTimeout())
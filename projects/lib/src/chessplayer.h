@@ -64,6 +64,14 @@ class LIB_EXPORT ChessPlayer : public QObject
 		 * the disconnection is done.
 		 */
 		virtual bool isReady() const;
+		/*!
+		 * Returns true if the player can be kept alive after a game
+		 * and reused in a later game; otherwise returns false.
+		 *
+		 * The default implementation returns true for players that
+		 * are not human and not disconnected.
+		 */
+		virtual bool isReusable() const;
 
 		/*! Returns the player's state. */
 		State state() const;
@@ -288,6 +296,30 @@ class LIB_EXPORT ChessPlayer : public QObject
 
 		/*! Sets the current error to \a error. */
 		void setError(const QString& error);
+
+		/*!
+		 * Returns true if the debugMessage() signal is connected.
+		 *
+		 * Subclasses should skip formatting debugging messages
+		 * that nobody receives.
+		 */
+		bool hasDebugReceivers() const;
+
+		/*!
+		 * Records the moment the move request reached the player.
+		 *
+		 * Subclasses should call this as close as possible to the
+		 * actual transport write, so that dispatch delays aren't
+		 * charged to the player. Only the first call per move counts.
+		 */
+		void stampMoveRequest();
+		/*!
+		 * Records the moment the player's reply arrived.
+		 *
+		 * Subclasses should call this as soon as the reply is read
+		 * from the transport, before parsing it.
+		 */
+		void stampMoveReply();
 		
 		/*!
 		 * Move evaluation for the current move.
@@ -298,6 +330,9 @@ class LIB_EXPORT ChessPlayer : public QObject
 		 */
 		MoveEvaluation m_eval;
 
+	private slots:
+		void onClockTimeout();
+
 	private:
 		void startClock();
 
@@ -17,27 +17,33 @@
 */
 
 #include "econode.h"
-#include <QStringList>
+#include <algorithm>
+#include <QAtomicInt>
 #include <QFile>
-#include <QDataStream>
+#include <QHash>
 #include <QMutex>
+#include <QtEndian>
 #include "pgngame.h"
 #include "pgnstream.h"
+#include "board/board.h"
 
 namespace {
 
-QStringList s_openings;
-EcoNode* s_root = nullptr;
-
-class EcoDeleter
-{
-	public:
-		~EcoDeleter()
-		{
-			delete s_root;
-		}
-};
-EcoDeleter s_ecoDeleter;
+const quint32 s_magic = 0x4F434543; // "CECO"
+const quint32 s_version = 2;
+const int s_headerSize = 16;
+const int s_nodeSize = 16;
+// The number of high key bits used to index s_buckets
+const int s_bucketBits = 12;
+
+// The opening and variation names. Index 0 is an empty string.
+QStringList s_strings;
+// The openings sorted by key
+QVector<EcoNode> s_nodes;
+// The index of the first node in each key bucket
+QVector<int> s_buckets;
+int s_maxPly = 0;
+QAtomicInt s_initialized;
 
 int ecoFromString(const QString& ecoString)
 {
@@ -53,59 +59,38 @@ int ecoFromString(const QString& ecoString)
 	return hundreds * 100 + tens;
 }
 
-} // anonymous namespace
-
-QDataStream& operator<<(QDataStream& out, const EcoNode* node)
+inline int bucket(quint64 key)
 {
-	if (!node)
-		return out;
-	out << node->m_ecoCode
-	    << node->m_opening
-	    << node->m_variation
-	    << node->m_children;
-
-	return out;
+	return int(key >> (64 - s_bucketBits));
 }
 
-QDataStream& operator>>(QDataStream& in, EcoNode*& node)
-{
-	node = new EcoNode;
-
-	in >> node->m_ecoCode
-	   >> node->m_opening
-	   >> node->m_variation
-	   >> node->m_children;
-
-	return in;
-}
+} // anonymous namespace
 
 void EcoNode::initialize()
 {
 	static QMutex mutex;
-	if (s_root)
+	if (s_initialized.loadAcquire())
 		return;
 
-	mutex.lock();
-	if (!s_root)
-	{
-		Q_INIT_RESOURCE(eco);
+	QMutexLocker locker(&mutex);
+	if (s_initialized.loadAcquire())
+		return;
 
-		QFile file(":/eco.bin");
-		if (!file.open(QIODevice::ReadOnly))
-			qWarning("Could not open ECO file");
-		else
-		{
-			QDataStream in(&file);
-			in.setVersion(QDataStream::Qt_4_6);
-			in >> s_openings >> s_root;
-		}
-	}
-	mutex.unlock();
+	Q_INIT_RESOURCE(eco);
+
+	// The whole table is read at once
+	QFile file(":/eco.bin");
+	if (!file.open(QIODevice::ReadOnly))
+		qWarning("Could not open ECO file");
+	else if (!load(file.readAll()))
+		qWarning("Invalid ECO file");
+
+	s_initialized.storeRelease(1);
 }
 
 void EcoNode::initialize(PgnStream& in)
 {
-	if (s_root)
+	if (s_initialized.loadAcquire())
 		return;
 
 	if (!in.isOpen())
@@ -114,106 +99,227 @@ void EcoNode::initialize(PgnStream& in)
 		return;
 	}
 
-	s_root = new EcoNode;
-	EcoNode* current = s_root;
-	QMap<QString, int> tmpOpenings;
+	QVector<EcoNode> nodes;
+	QStringList strings(QString());
+	QHash<QString, int> stringIds;
+	QHash<quint64, int> nodeIds;
 
-	PgnGame game;
-	while (game.read(in, INT_MAX - 1, false))
+	auto stringId = [&](const QString& str)
 	{
-		current = s_root;
-		for (const PgnGame::MoveData& move : game.moves())
+		if (str.isEmpty())
+			return 0;
+		int id = stringIds.value(str, -1);
+		if (id == -1)
 		{
-			QString san = move.moveString;
-			EcoNode* node = current->child(san);
-			if (node == nullptr)
-			{
-				node = new EcoNode;
-				current->addChild(san, node);
-			}
-			current = node;
+			id = strings.size();
+			stringIds[str] = id;
+			strings.append(str);
 		}
-		if (current == s_root)
-			continue;
+		return id;
+	};
 
-		current->m_ecoCode = ecoFromString(game.tagValue("ECO"));
+	PgnGame game;
+	while (game.read(in, INT_MAX - 1, false))
+	{
+		const int ecoCode = ecoFromString(game.tagValue("ECO"));
+		if (game.moves().isEmpty() || ecoCode == -1)
+			continue;
 
-		QString val = game.tagValue("Opening");
-		if (!val.isEmpty())
+		// Play the moves to get the key of the opening position
+		Chess::Board* board = game.createBoard();
+		if (board == nullptr)
+			continue;
+		for (const PgnGame::MoveData& md : game.moves())
+			board->makeMove(board->moveFromGenericMove(md.move));
+
+		EcoNode node;
+		node.m_key = board->key();
+		node.m_ecoCode = qint16(ecoCode);
+		node.m_ply = quint16(game.moves().size());
+		node.m_opening = quint16(stringId(game.tagValue("Opening")));
+		node.m_variation = quint16(stringId(game.tagValue("Variation")));
+		delete board;
+
+		// If several openings transpose to the same position, the
+		// one with the lowest ECO code is used
+		const int id = nodeIds.value(node.m_key, -1);
+		if (id == -1)
 		{
-			int index = tmpOpenings.value(val, -1);
-			if (index == -1)
-			{
-				index = tmpOpenings.count();
-				tmpOpenings[val] = index;
-				s_openings.append(val);
-			}
-			current->m_opening = index;
+			nodeIds[node.m_key] = nodes.size();
+			nodes.append(node);
 		}
+		else if (node.m_ecoCode < nodes.at(id).m_ecoCode)
+			nodes[id] = node;
+	}
 
-		current->m_variation = game.tagValue("Variation");
+	if (strings.size() > 0xFFFF)
+	{
+		qWarning("Too many opening names");
+		return;
 	}
+
+	setTable(nodes, strings);
+	s_initialized.storeRelease(1);
 }
 
-const EcoNode* EcoNode::root()
+bool EcoNode::load(const QByteArray& data)
 {
-	if (!s_root)
-		initialize();
-	return s_root;
+	if (data.size() < s_headerSize)
+		return false;
+
+	const uchar* p = reinterpret_cast<const uchar*>(data.constData());
+	if (qFromLittleEndian<quint32>(p) != s_magic
+	||  qFromLittleEndian<quint32>(p + 4) != s_version)
+		return false;
+
+	const quint32 nodeCount = qFromLittleEndian<quint32>(p + 8);
+	const quint32 stringCount = qFromLittleEndian<quint32>(p + 12);
+	qint64 offset = s_headerSize + qint64(nodeCount) * s_nodeSize;
+	if (offset > data.size() || stringCount == 0 || stringCount > 0xFFFF)
+		return false;
+
+	QVector<EcoNode> nodes;
+	nodes.reserve(int(nodeCount));
+	for (quint32 i = 0; i < nodeCount; i++)
+	{
+		const uchar* q = p + s_headerSize + i * s_nodeSize;
+
+		EcoNode node;
+		node.m_key = qFromLittleEndian<quint64>(q);
+		node.m_ecoCode = qFromLittleEndian<qint16>(q + 8);
+		node.m_ply = qFromLittleEndian<quint16>(q + 10);
+		node.m_opening = qFromLittleEndian<quint16>(q + 12);
+		node.m_variation = qFromLittleEndian<quint16>(q + 14);
+		if (node.m_opening >= stringCount || node.m_variation >= stringCount)
+			return false;
+		nodes.append(node);
+	}
+
+	QStringList strings;
+	for (quint32 i = 0; i < stringCount; i++)
+	{
+		if (offset + 4 > data.size())
+			return false;
+		const quint32 size = qFromLittleEndian<quint32>(p + offset);
+		offset += 4;
+		if (offset + size > data.size())
+			return false;
+
+		strings.append(QString::fromUtf8(data.constData() + offset, int(size)));
+		offset += size;
+	}
+
+	setTable(nodes, strings);
+	return true;
 }
 
-const EcoNode* EcoNode::find(const QVector<PgnGame::MoveData>& moves)
+void EcoNode::setTable(QVector<EcoNode> nodes, const QStringList& strings)
 {
-	if (!s_root)
-		return nullptr;
+	std::sort(nodes.begin(), nodes.end(), [](const EcoNode& a, const EcoNode& b)
+	{
+		return a.m_key < b.m_key;
+	});
+
+	// Index the sorted nodes by the high bits of their keys, so
+	// that a lookup only needs to search a few nodes
+	QVector<int> buckets((1 << s_bucketBits) + 1, 0);
+	int maxPly = 0;
+	for (const EcoNode& node : qAsConst(nodes))
+	{
+		buckets[bucket(node.m_key) + 1]++;
+		maxPly = qMax(maxPly, int(node.m_ply));
+	}
+	for (int i = 1; i < buckets.size(); i++)
+		buckets[i] += buckets.at(i - 1);
 
-	EcoNode* current = s_root;
-	EcoNode* valid = nullptr;
+	s_nodes = nodes;
+	s_strings = strings;
+	s_buckets = buckets;
+	s_maxPly = maxPly;
+}
+
+const EcoNode* EcoNode::find(quint64 key)
+{
+	if (!s_initialized.loadAcquire())
+		initialize();
+	if (s_buckets.isEmpty())
+		return nullptr;
 
-	for (const PgnGame::MoveData& move : moves)
+	const int i = bucket(key);
+	const auto first = s_nodes.constBegin() + s_buckets.at(i);
+	const auto last = s_nodes.constBegin() + s_buckets.at(i + 1);
+	const auto it = std::lower_bound(first, last, key,
+		[](const EcoNode& node, quint64 key)
 	{
-		EcoNode* node = current->child(move.moveString);
-		if (node == nullptr)
-			return valid;
-		if (!node->opening().isEmpty())
-			valid = node;
-		current = node;
-	}
+		return node.m_key < key;
+	});
+
+	if (it == last || it->m_key != key)
+		return nullptr;
+	return &*it;
+}
 
-	return nullptr;
+int EcoNode::maxPly()
+{
+	if (!s_initialized.loadAcquire())
+		initialize();
+	return s_maxPly;
 }
 
 void EcoNode::write(const QString& fileName)
 {
-	if (!s_root)
+	if (s_strings.isEmpty())
 		return;
 
-	QFile file(fileName);
-	if (!file.open(QIODevice::WriteOnly))
+	QByteArray data(s_headerSize + s_nodes.size() * s_nodeSize, 0);
+	uchar* p = reinterpret_cast<uchar*>(data.data());
+	qToLittleEndian<quint32>(s_magic, p);
+	qToLittleEndian<quint32>(s_version, p + 4);
+	qToLittleEndian<quint32>(quint32(s_nodes.size()), p + 8);
+	qToLittleEndian<quint32>(quint32(s_strings.size()), p + 12);
+
+	p += s_headerSize;
+	for (const EcoNode& node : qAsConst(s_nodes))
 	{
-		qWarning("Could not open file %s", qUtf8Printable(fileName));
-		return;
+		qToLittleEndian<quint64>(node.m_key, p);
+		qToLittleEndian<qint16>(node.m_ecoCode, p + 8);
+		qToLittleEndian<quint16>(node.m_ply, p + 10);
+		qToLittleEndian<quint16>(node.m_opening, p + 12);
+		qToLittleEndian<quint16>(node.m_variation, p + 14);
+		p += s_nodeSize;
+	}
+
+	for (const QString& str : qAsConst(s_strings))
+	{
+		const QByteArray utf8(str.toUtf8());
+		uchar size[4];
+		qToLittleEndian<quint32>(quint32(utf8.size()), size);
+		data.append(reinterpret_cast<const char*>(size), 4);
+		data.append(utf8);
 	}
 
-	QDataStream out(&file);
-	out.setVersion(QDataStream::Qt_4_6);
-	out << s_openings << s_root;
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+		qWarning("Could not write file %s", qUtf8Printable(fileName));
 }
 
 EcoNode::EcoNode()
-	: m_ecoCode(-1),
-	  m_opening(-1)
+	: m_key(0),
+	  m_ecoCode(-1),
+	  m_ply(0),
+	  m_opening(0),
+	  m_variation(0)
 {
 }
 
-EcoNode::~EcoNode()
+quint64 EcoNode::key() const
 {
-	qDeleteAll(m_children);
+	return m_key;
 }
 
-bool EcoNode::isLeaf() const
+int EcoNode::ply() const
 {
-	return m_ecoCode != -1;
+	return m_ply;
 }
 
 QString EcoNode::ecoCode() const
@@ -227,20 +333,10 @@ QString EcoNode::ecoCode() const
 
 QString EcoNode::opening() const
 {
-	return m_opening >= 0 ? s_openings[m_opening] : QString();
+	return s_strings.value(m_opening);
 }
 
 QString EcoNode::variation() const
 {
-	return m_variation;
-}
-
-EcoNode* EcoNode::child(const QString& sanMove) const
-{
-	return m_children.value(sanMove);
-}
-
-void EcoNode::addChild(const QString& sanMove, EcoNode* child)
-{
-	m_children[sanMove] = child;
+	return s_strings.value(m_variation);
 }
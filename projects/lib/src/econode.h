@@ -20,22 +20,24 @@
 #define ECONODE_H
 
 #include <QString>
-#include <QMap>
+#include <QStringList>
+#include <QVector>
 #include "pgngame.h"
-class QDataStream;
 class PgnStream;
 
 /*!
- * \brief A node in the ECO tree (Encyclopaedia of Chess Openings)
+ * \brief An opening in the ECO table (Encyclopaedia of Chess Openings)
  *
- * The EcoNode class can be used to generate and query a database (a tree) of
+ * The EcoNode class can be used to generate and query a database of
  * known chess openings that belong to the Encyclopaedia of Chess Openings.
  * More about ECO: http://en.wikipedia.org/wiki/Encyclopaedia_of_Chess_Openings
  *
- * The ECO tree can be generated from a PGN collection or from a binary file
- * that's part of the cutechess library (the default). A node corresponding
- * to a PgnGame can be found by traversing the ECO tree as new moves are added
- * to the game, or by passing all the moves at once to the find() function.
+ * The openings are stored in a flat table that is sorted by the zobrist
+ * key of the opening position, so an opening is found with a single
+ * lookup per position, and transposed move orders are recognized. The
+ * table can be generated from a PGN collection or loaded from a binary
+ * file that's part of the cutechess library (the default). That file
+ * is generated from res/eco/eco.pgn with the ecogen tool.
  *
  * \note The Encyclopaedia of Chess Openings only applies to games of standard
  * chess that start from the default starting position.
@@ -43,73 +45,54 @@ class PgnStream;
 class LIB_EXPORT EcoNode
 {
 	public:
-		/*! Destroys the node and its subtree. */
-		~EcoNode();
-
-		/*!
-		 * Returns true if the node is a leaf node; otherwise returns false.
-		 * A leaf node is a node that counts as an opening and has an ECO
-		 * code and a name.
-		 */
-		bool isLeaf() const;
+		/*! Returns the zobrist key of the opening position. */
+		quint64 key() const;
 		/*!
-		 * Returns the node's child node corresponding to \a sanMove, or 0
-		 * if no match is found.
-		 */
-		EcoNode* child(const QString& sanMove) const;
-		/*!
-		 * Returns the node's ECO code, or an empty string if the node is
-		 * an inner node.
+		 * Returns the number of halfmoves from the starting position
+		 * to the opening position.
 		 */
+		int ply() const;
+		/*! Returns the node's ECO code. */
 		QString ecoCode() const;
-		/*!
-		 * Returns the node's opening name, or an empty string if the node
-		 * is an inner node.
-		 */
+		/*! Returns the node's opening name. */
 		QString opening() const;
 		/*!
-		 * Returns the node's variation name, or an empty string if the node
-		 * is an inner node or doesn't have a variation name.
+		 * Returns the node's variation name, or an empty string if the
+		 * node doesn't have a variation name.
 		 */
 		QString variation() const;
 
-		/*! Initializes the ECO tree from the internal opening database. */
+		/*! Initializes the ECO table from the internal opening database. */
 		static void initialize();
-		/*! Initializes the ECO tree by parsing the PGN games in \a in. */
+		/*! Initializes the ECO table by parsing the PGN games in \a in. */
 		static void initialize(PgnStream& in);
 		/*!
-		 * Returns the root node of the ECO tree.
-		 * initialize() is called first if the tree is uninitialized.
+		 * Returns the opening whose position has the zobrist key \a key,
+		 * or 0 if no match is found.
+		 *
+		 * initialize() is called first if the table is uninitialized.
 		 */
-		static const EcoNode* root();
+		static const EcoNode* find(quint64 key);
 		/*!
-		 * Returns the deepest node (closest to the leaves) that matches the
-		 * opening sequence in \a moves.
+		 * Returns the largest ply() of any opening in the table.
+		 *
+		 * Positions that are deeper than this can't be found.
 		 */
-		static const EcoNode* find(const QVector<PgnGame::MoveData>& moves);
-		/*! Writes the ECO tree in binary format to \a fileName. */
+		static int maxPly();
+		/*! Writes the ECO table in binary format to \a fileName. */
 		static void write(const QString& fileName);
 
 	private:
-		friend LIB_EXPORT QDataStream& operator<<(QDataStream& out, const EcoNode* node);
-		friend LIB_EXPORT QDataStream& operator>>(QDataStream& in, EcoNode*& node);
-
 		EcoNode();
-		void addChild(const QString& sanMove, EcoNode* child);
+		static bool load(const QByteArray& data);
+		static void setTable(QVector<EcoNode> nodes,
+				     const QStringList& strings);
 
+		quint64 m_key;
 		qint16 m_ecoCode;
-		qint32 m_opening;
-		QString m_variation;
-
-		QMap<QString, EcoNode*> m_children;
+		quint16 m_ply;
+		quint16 m_opening;
+		quint16 m_variation;
 };
 
-/*! Writes the node \a node to stream \a out. */
-extern LIB_EXPORT QDataStream& operator<<(QDataStream& out, const EcoNode* node);
-/*!
- * Reads a node from stream \a in into \a node.
- * \a node should be a null or uninitialized pointer.
- */
-extern LIB_EXPORT QDataStream& operator>>(QDataStream& in, EcoNode*& node);
-
 #endif // ECONODE_H
@@ -71,28 +71,37 @@ ChessPlayer* EngineBuilder::create(QObject* receiver,
 	if (!stderrFile.isEmpty())
 		process->setStandardErrorFile(stderrFile, QIODevice::Append);
 
+	ChessEngine* engine = EngineFactory::create(m_config.protocol());
+	Q_ASSERT(engine != nullptr);
+
+	engine->setParent(parent);
+	if (receiver != nullptr && method != nullptr)
+		QObject::connect(engine, SIGNAL(debugMessage(QString)),
+				 receiver, method);
+
+	// Attach the device before starting the process so that the
+	// engine sees a start failure that's reported asynchronously
+	engine->setDevice(process);
+
 	if (!m_config.arguments().isEmpty())
 		process->start(cmd, m_config.arguments());
 	else
 		process->start(cmd);
 
-	bool ok = process->waitForStarted();
-	if (!ok)
+	// Don't wait for the process to start: the protocol commands are
+	// buffered until then, and the engine emits ready() once the
+	// protocol has started. EngineProcess::start() on Windows already
+	// knows whether the process started, so the check is free there.
+#ifdef Q_OS_WIN32
+	if (!process->waitForStarted())
 	{
 		setError(error, tr("Cannot execute command: %1")
 			 .arg(m_config.command()));
-		delete process;
+		delete engine;
 		return nullptr;
 	}
+#endif
 
-	ChessEngine* engine = EngineFactory::create(m_config.protocol());
-	Q_ASSERT(engine != nullptr);
-
-	engine->setParent(parent);
-	if (receiver != nullptr && method != nullptr)
-		QObject::connect(engine, SIGNAL(debugMessage(QString)),
-				 receiver, method);
-	engine->setDevice(process);
 	engine->applyConfiguration(m_config);
 
 	engine->start();
@@ -18,6 +18,7 @@
 
 #include "gamemanager.h"
 #include <QThread>
+#include <QMetaMethod>
 #include <algorithm>
 #include "playerbuilder.h"
 #include "chessgame.h"
@@ -36,6 +37,9 @@ class GameInitializer : public QObject
 		const PlayerBuilder* blackBuilder() const;
 		void swapPlayers();
 		void setGame(ChessGame* game);
+		void setPlayer(int index, ChessPlayer* player);
+		ChessPlayer* releasePlayer(int index, QThread* target);
+		void setDebugReceiver(QObject* receiver);
 
 	public slots:
 		void initializeGame();
@@ -56,13 +60,15 @@ class GameInitializer : public QObject
 		const PlayerBuilder* m_builder[2];
 		ChessPlayer* m_player[2];
 		ChessGame* m_game;
+		QObject* m_debugReceiver;
 };
 
 GameInitializer::GameInitializer(const PlayerBuilder* white,
 				 const PlayerBuilder* black)
 	: m_playerCount(0),
 	  m_finishing(false),
-	  m_game(nullptr)
+	  m_game(nullptr),
+	  m_debugReceiver(nullptr)
 {
 	Q_ASSERT(white != nullptr);
 	Q_ASSERT(black != nullptr);
@@ -106,6 +112,35 @@ void GameInitializer::setGame(ChessGame* game)
 	m_game = game;
 }
 
+void GameInitializer::setPlayer(int index, ChessPlayer* player)
+{
+	Q_ASSERT(m_player[index] == nullptr);
+	Q_ASSERT(player->thread() == thread());
+
+	m_player[index] = player;
+}
+
+ChessPlayer* GameInitializer::releasePlayer(int index, QThread* target)
+{
+	Q_ASSERT(QThread::currentThread() == thread());
+
+	ChessPlayer* player = m_player[index];
+	if (player == nullptr || !player->isReusable())
+		return nullptr;
+
+	m_player[index] = nullptr;
+	m_playerCount--;
+
+	player->setParent(nullptr);
+	player->moveToThread(target);
+	return player;
+}
+
+void GameInitializer::setDebugReceiver(QObject* receiver)
+{
+	m_debugReceiver = receiver;
+}
+
 void GameInitializer::deletePlayer(int index)
 {
 	ChessPlayer* player = m_player[index];
@@ -135,11 +170,17 @@ void GameInitializer::initializeGame()
 			deletePlayer(i);
 		}
 
+		// Adopt a player that was taken from the idle player pool
+		if (m_player[i] != nullptr && m_player[i]->parent() == nullptr)
+			m_player[i]->setParent(this);
+
 		if (m_player[i] == nullptr)
 		{
 			QString error;
-			m_player[i] = m_builder[i]->create(thread()->parent(),
-							   SIGNAL(debugMessage(QString)),
+			const char* method = m_debugReceiver != nullptr ?
+					     SIGNAL(debugMessage(QString)) : nullptr;
+			m_player[i] = m_builder[i]->create(m_debugReceiver,
+							   method,
 							   this, &error);
 			m_game->setError(error);
 
@@ -190,16 +231,20 @@ void GameInitializer::onPlayerQuit()
 }
 
 
-class GameThread : public QThread
+class GameThread : public QObject
 {
 	Q_OBJECT
 
 	public:
 		GameThread(const PlayerBuilder* white,
 			   const PlayerBuilder* black,
+			   QThread* worker,
 			   QObject* parent);
 		virtual ~GameThread();
 
+		QThread* workerThread() const;
+		bool isRunning() const;
+		void start();
 		bool isReady() const;
 		void newGame(ChessGame* game);
 		void finish();
@@ -216,41 +261,80 @@ class GameThread : public QThread
 	signals:
 		void gameInitialized(bool success);
 		void ready();
+		void finished();
 
 	private slots:
 		void onGameDestroyed();
+		void onInitializerDestroyed();
 
 	private:
 		bool m_ready;
+		bool m_running;
+		bool m_ownsThread;
 		GameManager::StartMode m_startMode;
 		GameManager::CleanupMode m_cleanupMode;
+		QThread* m_thread;
 		ChessGame* m_game;
 		GameInitializer* m_initializer;
 };
 
 GameThread::GameThread(const PlayerBuilder* white,
 		       const PlayerBuilder* black,
+		       QThread* worker,
 		       QObject* parent)
-	: QThread(parent),
+	: QObject(parent),
 	  m_ready(true),
+	  m_running(false),
+	  m_ownsThread(worker == nullptr),
 	  m_startMode(GameManager::StartImmediately),
 	  m_cleanupMode(GameManager::DeletePlayers),
+	  m_thread(worker),
 	  m_game(nullptr),
 	  m_initializer(new GameInitializer(white, black))
 {
+	// Without a shared worker the game gets a thread of its own,
+	// which lives exactly as long as the players do
+	if (m_ownsThread)
+	{
+		m_thread = new QThread(this);
+		connect(m_thread, SIGNAL(finished()),
+			this, SIGNAL(finished()));
+	}
+
 	connect(m_initializer, SIGNAL(gameInitialized(bool)),
 		this, SIGNAL(gameInitialized(bool)));
 	connect(m_initializer, SIGNAL(finished()),
 		m_initializer, SLOT(deleteLater()),
 		Qt::QueuedConnection);
 	connect(m_initializer, SIGNAL(destroyed()),
-		this, SLOT(quit()),
+		this, SLOT(onInitializerDestroyed()),
 		Qt::QueuedConnection);
-	m_initializer->moveToThread(this);
+	m_initializer->moveToThread(m_thread);
 }
 
 GameThread::~GameThread()
 {
+	if (m_ownsThread)
+		m_thread->wait();
+}
+
+QThread* GameThread::workerThread() const
+{
+	return m_thread;
+}
+
+bool GameThread::isRunning() const
+{
+	if (m_ownsThread)
+		return m_thread->isRunning();
+	return m_running;
+}
+
+void GameThread::start()
+{
+	m_running = true;
+	if (m_ownsThread)
+		m_thread->start();
 }
 
 bool GameThread::isReady() const
@@ -329,15 +413,33 @@ void GameThread::onGameDestroyed()
 	emit ready();
 }
 
+void GameThread::onInitializerDestroyed()
+{
+	m_running = false;
+	if (m_ownsThread)
+		m_thread->quit();
+	else
+		emit finished();
+}
+
 
 GameManager::GameManager(QObject* parent)
 	: QObject(parent),
 	  m_finishing(false),
+	  m_cleaningUp(false),
 	  m_concurrency(1),
+	  m_playerPoolSize(-1),
+	  m_workerThreadCount(0),
+	  m_quittingPlayerCount(0),
 	  m_activeQueuedGameCount(0)
 {
 }
 
+GameManager::~GameManager()
+{
+	stopWorkers();
+}
+
 QList<ChessGame*> GameManager::activeGames() const
 {
 	return m_activeGames;
@@ -353,8 +455,210 @@ void GameManager::setConcurrency(int concurrency)
 	m_concurrency = concurrency;
 }
 
+int GameManager::playerPoolSize() const
+{
+	return m_playerPoolSize;
+}
+
+void GameManager::setPlayerPoolSize(int size)
+{
+	m_playerPoolSize = size;
+	while (m_idlePlayers.size() > maxIdlePlayers())
+		quitIdlePlayer(0);
+}
+
+int GameManager::workerThreadCount() const
+{
+	return m_workerThreadCount;
+}
+
+void GameManager::setWorkerThreadCount(int count)
+{
+	m_workerThreadCount = count;
+}
+
+QThread* GameManager::takeWorker()
+{
+	int count = m_workerThreadCount;
+	if (count < 0)
+		count = qMax(QThread::idealThreadCount(), 1);
+	if (count == 0)
+		return nullptr;
+
+	// Start a new worker only if every existing one is busy
+	Worker* worker = nullptr;
+	for (Worker& tmp : m_workers)
+	{
+		if (worker == nullptr || tmp.load < worker->load)
+			worker = &tmp;
+	}
+	if (worker == nullptr
+	||  (worker->load > 0 && m_workers.size() < count))
+	{
+		QThread* thread = new QThread(this);
+		thread->start();
+		m_workers.append({ thread, 0 });
+		worker = &m_workers.last();
+	}
+
+	worker->load++;
+	return worker->thread;
+}
+
+void GameManager::releaseWorker(QThread* thread)
+{
+	for (Worker& worker : m_workers)
+	{
+		if (worker.thread == thread)
+		{
+			worker.load--;
+			return;
+		}
+	}
+}
+
+void GameManager::stopWorkers()
+{
+	for (const Worker& worker : qAsConst(m_workers))
+	{
+		worker.thread->quit();
+		worker.thread->wait();
+		delete worker.thread;
+	}
+	m_workers.clear();
+}
+
+int GameManager::maxIdlePlayers() const
+{
+	if (m_playerPoolSize >= 0)
+		return m_playerPoolSize;
+	return 2 * m_concurrency;
+}
+
+void GameManager::addIdlePlayer(const PlayerBuilder* builder,
+				ChessPlayer* player)
+{
+	Q_ASSERT(player->thread() == thread());
+
+	player->setParent(this);
+	connect(player, SIGNAL(disconnected()),
+		this, SLOT(onIdlePlayerDisconnected()));
+	m_idlePlayers.append({ builder, player });
+
+	// Together with the two players of each game slot this caps the
+	// number of live players, so evict the least recently used ones
+	while (m_idlePlayers.size() > maxIdlePlayers())
+		quitIdlePlayer(0);
+}
+
+ChessPlayer* GameManager::takeIdlePlayer(const PlayerBuilder* builder)
+{
+	for (int i = m_idlePlayers.size() - 1; i >= 0; i--)
+	{
+		if (m_idlePlayers.at(i).builder != builder)
+			continue;
+
+		ChessPlayer* player = m_idlePlayers.takeAt(i).player;
+		disconnect(player, SIGNAL(disconnected()),
+			   this, SLOT(onIdlePlayerDisconnected()));
+		player->setParent(nullptr);
+		return player;
+	}
+
+	return nullptr;
+}
+
+void GameManager::quitIdlePlayer(int index)
+{
+	ChessPlayer* player = m_idlePlayers.takeAt(index).player;
+
+	m_quittingPlayerCount++;
+	player->quit();
+}
+
+void GameManager::clearIdlePlayers()
+{
+	while (!m_idlePlayers.isEmpty())
+		quitIdlePlayer(0);
+}
+
+void GameManager::onIdlePlayerDisconnected()
+{
+	ChessPlayer* player = qobject_cast<ChessPlayer*>(QObject::sender());
+	Q_ASSERT(player != nullptr);
+
+	auto it = std::find_if(m_idlePlayers.begin(), m_idlePlayers.end(),
+			       [=](const IdlePlayer& idle)
+	{
+		return idle.player == player;
+	});
+
+	// An idle player either crashed or was told to quit
+	if (it != m_idlePlayers.end())
+		m_idlePlayers.erase(it);
+	else
+		m_quittingPlayerCount--;
+
+	player->deleteLater();
+	checkFinished();
+}
+
+void GameManager::recycleThread(GameThread* thread)
+{
+	GameInitializer* initializer = thread->initializer();
+	if (initializer != nullptr
+	&&  thread->cleanupMode() == ReusePlayers
+	&&  maxIdlePlayers() > 0)
+	{
+		const PlayerBuilder* builders[2] = {
+			initializer->whiteBuilder(),
+			initializer->blackBuilder()
+		};
+		ChessPlayer* players[2] = { nullptr, nullptr };
+		QThread* target = QObject::thread();
+
+		// The players can only be pushed out of their thread by
+		// the thread itself. Game threads never wait on the
+		// manager, so blocking here can't deadlock.
+		QMetaObject::invokeMethod(initializer,
+					  [initializer, target, &players]()
+		{
+			for (int i = 0; i < 2; i++)
+				players[i] = initializer->releasePlayer(i, target);
+		}, Qt::BlockingQueuedConnection);
+
+		for (int i = 0; i < 2; i++)
+		{
+			if (players[i] != nullptr)
+				addIdlePlayer(builders[i], players[i]);
+		}
+	}
+
+	thread->finishAndDelete();
+}
+
+void GameManager::recycleIdleThreads()
+{
+	QList<GameThread*>::iterator it = m_activeThreads.begin();
+	while (it != m_activeThreads.end())
+	{
+		GameThread* thread = *it;
+		Q_ASSERT(thread != nullptr);
+
+		if (thread->isReady())
+		{
+			it = m_activeThreads.erase(it);
+			recycleThread(thread);
+		}
+		else
+			++it;
+	}
+}
+
 void GameManager::cleanupIdleThreads()
 {
+	clearIdlePlayers();
+
 	QList<GameThread*>::iterator it = m_activeThreads.begin();
 	while (it != m_activeThreads.end())
 	{
@@ -371,9 +675,21 @@ void GameManager::cleanupIdleThreads()
 	}
 }
 
+void GameManager::checkFinished()
+{
+	if (!m_cleaningUp || !m_threads.isEmpty() || m_quittingPlayerCount > 0)
+		return;
+
+	m_cleaningUp = false;
+	stopWorkers();
+	emit finished();
+}
+
 void GameManager::cleanup()
 {
 	m_finishing = false;
+	m_cleaningUp = true;
+	clearIdlePlayers();
 
 	// Remove terminated threads from the list
 	QList< QPointer<GameThread> >::iterator it = m_threads.begin();
@@ -387,7 +703,7 @@ void GameManager::cleanup()
 
 	if (m_threads.isEmpty())
 	{
-		emit finished();
+		checkFinished();
 		return;
 	}
 
@@ -445,7 +761,7 @@ void GameManager::onThreadQuit()
 	if (m_threads.isEmpty())
 	{
 		m_finishing = false;
-		emit finished();
+		checkFinished();
 	}
 }
 
@@ -498,9 +814,9 @@ void GameManager::onGameInitialized(bool success)
 
 	m_activeGames << game;
 	if (gameThread->startMode() == Enqueue)
-		cleanupIdleThreads();
+		recycleIdleThreads();
 
-	game->moveToThread(gameThread);
+	game->moveToThread(gameThread->workerThread());
 	connect(game, SIGNAL(started(ChessGame*)),
 		this, SIGNAL(gameStarted(ChessGame*)),
 		Qt::QueuedConnection);
@@ -528,7 +844,20 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 			return thread;
 	}
 
-	GameThread* gameThread = new GameThread(white, black, this);
+	// Move the players of the idle threads to the pool, so that the
+	// new thread can take over running players instead of starting
+	// new ones
+	recycleIdleThreads();
+
+	QThread* worker = takeWorker();
+	GameThread* gameThread = new GameThread(white, black, worker, this);
+	if (worker != nullptr)
+	{
+		connect(gameThread, &GameThread::finished, this, [=]()
+		{
+			releaseWorker(worker);
+		});
+	}
 	m_threads << gameThread;
 	m_activeThreads << gameThread;
 	connect(gameThread, SIGNAL(ready()),
@@ -537,6 +866,24 @@ GameThread* GameManager::getThread(const PlayerBuilder* white,
 		this, SLOT(onGameInitialized(bool)),
 		Qt::QueuedConnection);
 
+	// Only route the players' debugging messages through the manager
+	// if someone is listening, so that the engines can skip them
+	static const QMetaMethod debugSignal =
+		QMetaMethod::fromSignal(&GameManager::debugMessage);
+	if (isSignalConnected(debugSignal))
+		gameThread->initializer()->setDebugReceiver(this);
+
+	const PlayerBuilder* builders[2] = { white, black };
+	for (int i = 0; i < 2; i++)
+	{
+		ChessPlayer* player = takeIdlePlayer(builders[i]);
+		if (player == nullptr)
+			continue;
+
+		player->moveToThread(gameThread->workerThread());
+		gameThread->initializer()->setPlayer(i, player);
+	}
+
 	gameThread->start();
 	return gameThread;
 }
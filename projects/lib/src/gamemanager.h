@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QList>
 #include <QPointer>
+class QThread;
 class ChessGame;
 class ChessPlayer;
 class PlayerBuilder;
@@ -35,6 +36,10 @@ class GameThread;
  * multiple games concurrently, and queue games to be
  * run when a game slot/thread is free.
  *
+ * By default each game slot has a thread of its own. With
+ * setWorkerThreadCount() the games and their players share
+ * a fixed pool of threads instead.
+ *
  * \sa ChessGame, PlayerBuilder
  */
 class LIB_EXPORT GameManager : public QObject
@@ -64,13 +69,17 @@ class LIB_EXPORT GameManager : public QObject
 			/*!
 			 * The players are left alive after the game is deleted.
 			 * If a new game with the same builder objects is started,
-			 * the players are reused for that game.
+			 * the players are reused for that game. Otherwise the
+			 * players are moved to a pool of idle players, from which
+			 * any later game using the same builder can take them.
 			 */
 			ReusePlayers
 		};
 
 		/*! Creates a new game manager. */
 		GameManager(QObject* parent = nullptr);
+		/*! Destroys the game manager and stops its worker threads. */
+		virtual ~GameManager();
 
 		/*!
 		 * Returns the list of active games.
@@ -98,13 +107,62 @@ class LIB_EXPORT GameManager : public QObject
 		 */
 		void setConcurrency(int concurrency);
 
+		/*!
+		 * Returns the maximum number of idle players kept alive
+		 * for reuse in later games.
+		 *
+		 * The default value is -1, which allows two idle players
+		 * per game slot, ie. twice the concurrency() limit.
+		 *
+		 * \sa setPlayerPoolSize()
+		 */
+		int playerPoolSize() const;
+		/*!
+		 * Sets the maximum number of idle players to \a size.
+		 *
+		 * With \a size 0 idle players are not pooled, and each new
+		 * pairing of builders starts new players. A negative \a size
+		 * restores the default limit.
+		 *
+		 * \sa playerPoolSize()
+		 */
+		void setPlayerPoolSize(int size);
+
+		/*!
+		 * Returns the number of threads shared by the games.
+		 *
+		 * The default value is 0, which runs each game and its
+		 * players in a thread of their own.
+		 *
+		 * \sa setWorkerThreadCount()
+		 */
+		int workerThreadCount() const;
+		/*!
+		 * Runs the games and players on a fixed pool of \a count
+		 * threads.
+		 *
+		 * Each new game slot goes to the thread with the fewest game
+		 * slots, and the threads are started as they're needed. With
+		 * a negative \a count the pool has one thread per CPU core,
+		 * and with \a count 0 each game gets a thread of its own.
+		 *
+		 * \note This should be called before the first game is
+		 * started. The threads are stopped when the manager has
+		 * finished. ChessGame::lockThread() pauses every game on
+		 * the locked game's thread.
+		 *
+		 * \sa workerThreadCount()
+		 */
+		void setWorkerThreadCount(int count);
+
 		/*!
 		 * Cleans up and deletes all idle game threads
 		 *
 		 * This function cleans up and removes all resources used by
 		 * game threads that are waiting for new games. The resources
-		 * include the players and the thread they're living in. The
-		 * PlayerBuilder objects will not be deleted.
+		 * include the players, the thread they're living in and the
+		 * pool of idle players. The PlayerBuilder objects will not be
+		 * deleted.
 		 *
 		 * Generally this function should be called after a tournament
 		 * has ended.
@@ -124,7 +182,8 @@ class LIB_EXPORT GameManager : public QObject
 		 * Construction of the players is delayed to the moment when the
 		 * game starts. If the same builder objects (\a white and \a black)
 		 * were used in a previous game, the players are reused instead of
-		 * constructing new players.
+		 * constructing new players. A player left idle by an earlier
+		 * game with a different pairing is reused the same way.
 		 *
 		 * If \a mode is StartImmediately, the game starts immediately
 		 * even if the number of active games is over the \a concurrency
@@ -180,13 +239,20 @@ class LIB_EXPORT GameManager : public QObject
 		 * safely deleted.
 		 */
 		void finished();
-		/*! This signal redirects the ChessPlayer::debugMessage() signal. */
+		/*!
+		 * This signal redirects the ChessPlayer::debugMessage() signal.
+		 *
+		 * \note Only players that are constructed while this signal is
+		 * connected forward their messages, so it should be connected
+		 * before the first game is started.
+		 */
 		void debugMessage(const QString& data);
 
 	private slots:
 		void onThreadReady();
 		void onThreadQuit();
 		void onGameInitialized(bool success);
+		void onIdlePlayerDisconnected();
 
 	private:
 		struct GameEntry
@@ -197,20 +263,48 @@ class LIB_EXPORT GameManager : public QObject
 			StartMode startMode;
 			CleanupMode cleanupMode;
 		};
+		struct IdlePlayer
+		{
+			const PlayerBuilder* builder;
+			ChessPlayer* player;
+		};
+		struct Worker
+		{
+			QThread* thread;
+			int load;
+		};
 
 		GameThread* getThread(const PlayerBuilder* white,
 				      const PlayerBuilder* black);
 		void startGame(const GameEntry& entry);
 		void startQueuedGame();
 		void cleanup();
+		void recycleIdleThreads();
+		void recycleThread(GameThread* thread);
+		int maxIdlePlayers() const;
+		void addIdlePlayer(const PlayerBuilder* builder,
+				   ChessPlayer* player);
+		ChessPlayer* takeIdlePlayer(const PlayerBuilder* builder);
+		void quitIdlePlayer(int index);
+		void clearIdlePlayers();
+		void checkFinished();
+		QThread* takeWorker();
+		void releaseWorker(QThread* thread);
+		void stopWorkers();
 
 		bool m_finishing;
+		bool m_cleaningUp;
 		int m_concurrency;
+		int m_playerPoolSize;
+		int m_workerThreadCount;
+		int m_quittingPlayerCount;
 		int m_activeQueuedGameCount;
 		QList< QPointer<GameThread> > m_threads;
 		QList<GameThread*> m_activeThreads;
 		QList<GameEntry> m_gameEntries;
 		QList<ChessGame*> m_activeGames;
+		QList<IdlePlayer> m_idlePlayers;
+		QList<Worker> m_workers;
 };
 
 #endif // GAMEMANAGER_H
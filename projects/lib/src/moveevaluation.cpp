@@ -17,6 +17,57 @@
 */
 
 #include "moveevaluation.h"
+#include <mutex>
+#include <QScopedPointer>
+#include <QStringList>
+#include "board/board.h"
+#include "board/boardfactory.h"
+
+namespace {
+
+QString sanPv(const QString& pv, const QString& variant, const QString& fen)
+{
+	QScopedPointer<Chess::Board> board(Chess::BoardFactory::create(variant));
+	if (board.isNull() || !board->setFenString(fen))
+		return pv;
+
+	QString san;
+	const QStringList moves(pv.split(' ', Qt::SkipEmptyParts));
+	for (const QString& str : moves)
+	{
+		// Stop at the first illegal move
+		const Chess::Move move(board->moveFromString(str));
+		if (move.isNull())
+		{
+			qWarning("Illegal PV move %s from position %s",
+				 qUtf8Printable(str),
+				 qUtf8Printable(fen));
+			qWarning("PV: %s %s",
+				 qUtf8Printable(san),
+				 qUtf8Printable(str));
+			break;
+		}
+
+		if (!san.isEmpty())
+			san += " ";
+		san += board->moveString(move, Chess::Board::StandardAlgebraic);
+		board->makeMove(move);
+	}
+
+	return san;
+}
+
+} // anonymous namespace
+
+// A PV in long algebraic notation and its SAN form
+struct MoveEvaluation::LongPv
+{
+	QString pv;
+	QString variant;
+	QString fen;
+	std::once_flag converted;
+	QString san;
+};
 
 MoveEvaluation::MoveEvaluation()
 	: m_isBookEval(false),
@@ -25,6 +76,7 @@ MoveEvaluation::MoveEvaluation()
 	  m_selDepth(0),
 	  m_score(NULL_SCORE),
 	  m_time(0),
+	  m_latency(0),
 	  m_pvNumber(0),
 	  m_hashUsage(0),
 	  m_ponderhitRate(0),
@@ -42,6 +94,7 @@ bool MoveEvaluation::operator==(const MoveEvaluation& other) const
 	&&  m_selDepth == other.m_selDepth
 	&&  m_score == other.m_score
 	&&  m_time == other.m_time
+	&&  m_latency == other.m_latency
 	&&  m_pvNumber == other.m_pvNumber
 	&&  m_hashUsage == other.m_hashUsage
 	&&  m_ponderhitRate == other.m_ponderhitRate
@@ -61,6 +114,7 @@ bool MoveEvaluation::operator!=(const MoveEvaluation& other) const
 	||  m_selDepth != other.m_selDepth
 	||  m_score != other.m_score
 	||  m_time != other.m_time
+	||  m_latency != other.m_latency
 	||  m_pvNumber != other.m_pvNumber
 	||  m_hashUsage != other.m_hashUsage
 	||  m_ponderhitRate != other.m_ponderhitRate
@@ -148,6 +202,11 @@ int MoveEvaluation::time() const
 	return m_time;
 }
 
+int MoveEvaluation::latency() const
+{
+	return m_latency;
+}
+
 quint64 MoveEvaluation::nodeCount() const
 {
 	return m_nodeCount;
@@ -182,7 +241,15 @@ QString MoveEvaluation::ponderMove() const
 
 QString MoveEvaluation::pv() const
 {
-	return m_pv;
+	if (m_longPv.isNull())
+		return m_pv;
+
+	LongPv* longPv = m_longPv.data();
+	std::call_once(longPv->converted, [=]()
+	{
+		longPv->san = sanPv(longPv->pv, longPv->variant, longPv->fen);
+	});
+	return longPv->san;
 }
 
 int MoveEvaluation::pvNumber() const
@@ -197,6 +264,7 @@ void MoveEvaluation::clear()
 	m_selDepth = 0;
 	m_score = NULL_SCORE;
 	m_time = 0;
+	m_latency = 0;
 	m_pvNumber = 0;
 	m_nodeCount = 0;
 	m_nps = 0;
@@ -204,6 +272,7 @@ void MoveEvaluation::clear()
 	m_hashUsage = 0;
 	m_ponderhitRate = 0;
 	m_pv.clear();
+	m_longPv.clear();
 	m_ponderMove.clear();
 }
 
@@ -237,6 +306,11 @@ void MoveEvaluation::setTime(int time)
 	m_time = time;
 }
 
+void MoveEvaluation::setLatency(int latency)
+{
+	m_latency = latency;
+}
+
 void MoveEvaluation::setNodeCount(quint64 nodeCount)
 {
 	m_nodeCount = nodeCount;
@@ -270,6 +344,18 @@ void MoveEvaluation::setPonderMove(const QString& san)
 void MoveEvaluation::setPv(const QString& pv)
 {
 	m_pv = pv;
+	m_longPv.clear();
+}
+
+void MoveEvaluation::setPv(const QString& pv,
+			   const QString& variant,
+			   const QString& fen)
+{
+	m_pv = pv;
+	m_longPv.reset(new LongPv);
+	m_longPv->pv = pv;
+	m_longPv->variant = variant;
+	m_longPv->fen = fen;
 }
 
 void MoveEvaluation::setPvNumber(int number)
@@ -297,11 +383,16 @@ void MoveEvaluation::merge(const MoveEvaluation& other)
 	if (!other.m_ponderMove.isEmpty())
 		m_ponderMove = other.m_ponderMove;
 	if (!other.m_pv.isEmpty())
+	{
 		m_pv = other.m_pv;
+		m_longPv = other.m_longPv;
+	}
 	if (other.m_pvNumber)
 		m_pvNumber = other.m_pvNumber;
 	if (other.m_score != NULL_SCORE)
 		m_score = other.m_score;
 	if (other.m_time)
 		m_time = other.m_time;
+	if (other.m_latency)
+		m_latency = other.m_latency;
 }
@@ -21,6 +21,7 @@
 
 #include <QString>
 #include <QMetaType>
+#include <QSharedPointer>
 
 /*!
  * \brief Evaluation data for a chess move.
@@ -87,6 +88,14 @@ class LIB_EXPORT MoveEvaluation
 		/*! Move time in milliseconds. */
 		int time() const;
 
+		/*!
+		 * Transport latency of the move in microseconds.
+		 *
+		 * This is the time spent delivering the move request and
+		 * the reply, which is not included in time().
+		 */
+		int latency() const;
+
 		/*!
 		 * How many nodes were searched?
 		 * \note For human players this is always 0.
@@ -124,6 +133,11 @@ class LIB_EXPORT MoveEvaluation
 		 * The principal variation.
 		 * This is a sequence of moves that an engine
 		 * expects to be played next.
+		 *
+		 * A PV set in long algebraic notation is converted to SAN
+		 * on the first call, and the result is shared with the
+		 * copies of the evaluation. The conversion is thread-safe.
+		 *
 		 * \note For human players this is always empty.
 		 */
 		QString pv() const;
@@ -156,6 +170,9 @@ class LIB_EXPORT MoveEvaluation
 		/*! Sets the move time to \a time. */
 		void setTime(int time);
 
+		/*! Sets the transport latency to \a latency microseconds. */
+		void setLatency(int latency);
+
 		/*! Sets the node count to \a nodeCount. */
 		void setNodeCount(quint64 nodeCount);
 
@@ -176,6 +193,16 @@ class LIB_EXPORT MoveEvaluation
 
 		/*! Sets the principal variation to \a pv. */
 		void setPv(const QString& pv);
+		/*!
+		 * Sets the principal variation to \a pv in long algebraic
+		 * notation, played from the position \a fen of \a variant.
+		 *
+		 * The moves are converted to SAN only when pv() is first
+		 * called.
+		 */
+		void setPv(const QString& pv,
+			   const QString& variant,
+			   const QString& fen);
 
 		/*! Sets the principal variation number to \a number. */
 		void setPvNumber(int number);
@@ -184,12 +211,15 @@ class LIB_EXPORT MoveEvaluation
 		void merge(const MoveEvaluation& other);
 
 	private:
+		struct LongPv;
+
 		bool m_isBookEval;
 		bool m_isTrusted;
 		int m_depth;
 		int m_selDepth;
 		int m_score;
 		int m_time;
+		int m_latency;
 		int m_pvNumber;
 		int m_hashUsage;
 		int m_ponderhitRate;
@@ -197,6 +227,7 @@ class LIB_EXPORT MoveEvaluation
 		quint64 m_nps;
 		quint64 m_tbHits;
 		QString m_pv;
+		QSharedPointer<LongPv> m_longPv;
 		QString m_ponderMove;
 };
 
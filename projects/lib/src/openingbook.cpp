@@ -17,14 +17,67 @@
 */
 
 #include "openingbook.h"
+#include <algorithm>
+#include <climits>
 #include <QString>
 #include <QFile>
 #include <QDataStream>
+#include <QByteArray>
 #include <QtDebug>
 #include "pgngame.h"
 #include "pgnstream.h"
 #include "mersenne.h"
 
+namespace {
+
+quint32 packMove(const Chess::GenericMove& move)
+{
+	// Store file and rank plus one so that the null source
+	// square of piece drops fits in the unsigned fields.
+	const Chess::Square& src = move.sourceSquare();
+	const Chess::Square& trg = move.targetSquare();
+
+	return quint32(src.file() + 1)
+	     | quint32(src.rank() + 1) << 6
+	     | quint32(trg.file() + 1) << 12
+	     | quint32(trg.rank() + 1) << 18
+	     | quint32(move.promotion()) << 24;
+}
+
+Chess::GenericMove unpackMove(quint32 bits)
+{
+	Chess::Square source(int(bits & 63) - 1, int((bits >> 6) & 63) - 1);
+	Chess::Square target(int((bits >> 12) & 63) - 1,
+			     int((bits >> 18) & 63) - 1);
+
+	return Chess::GenericMove(source, target, int(bits >> 24));
+}
+
+template <typename WeightFunc>
+int pickEntry(int count, WeightFunc weight)
+{
+	// Calculate the total weight of all available moves
+	int totalWeight = 0;
+	for (int i = 0; i < count; i++)
+		totalWeight += weight(i);
+	if (totalWeight <= 0)
+		return -1;
+
+	// Pick a move randomly, with the highest-weighted move having
+	// the highest probability of getting picked.
+	int pick = Mersenne::random() % totalWeight;
+	int currentWeight = 0;
+	for (int i = 0; i < count; i++)
+	{
+		currentWeight += weight(i);
+		if (currentWeight > pick)
+			return i;
+	}
+
+	return -1;
+}
+
+} // anonymous namespace
 
 QDataStream& operator>>(QDataStream& in, OpeningBook* book)
 {
@@ -34,21 +87,25 @@ QDataStream& operator>>(QDataStream& in, OpeningBook* book)
 		OpeningBook::Entry entry = book->readEntry(in, &key);
 		book->addEntry(entry, key);
 	}
+	book->sortEntries();
 
 	return in;
 }
 
 QDataStream& operator<<(QDataStream& out, const OpeningBook* book)
 {
-	OpeningBook::Map::const_iterator it;
-	for (it = book->m_map.constBegin(); it != book->m_map.constEnd(); ++it)
-		book->writeEntry(it, out);
+	Q_ASSERT(book->m_sortedCount == book->m_keys.size());
+	for (int i = 0; i < book->m_keys.size(); i++)
+		book->writeEntry(book->m_keys.at(i), book->entryAt(i), out);
 
 	return out;
 }
 
 OpeningBook::OpeningBook(AccessMode mode)
-	: m_mode(mode)
+	: m_mode(mode),
+	  m_sortedCount(0),
+	  m_mappedData(nullptr),
+	  m_mappedSize(0)
 {
 }
 
@@ -59,6 +116,10 @@ OpeningBook::~OpeningBook()
 bool OpeningBook::read(const QString& filename)
 {
 	m_filename = filename;
+	m_file.reset();
+	m_mappedData = nullptr;
+	m_mappedSize = 0;
+
 	QFile file(filename);
 	if (!file.open(QIODevice::ReadOnly))
 		return false;
@@ -70,14 +131,62 @@ bool OpeningBook::read(const QString& filename)
 		return false;
 	}
 
+	if (m_mode == Mapped)
+	{
+		if (file.size() == 0)
+			return false;
+
+		// The mapping stays valid for as long as the file is open,
+		// so the file object is shared by all copies of the book.
+		QSharedPointer<QFile> mappedFile(new QFile(filename));
+		if (mappedFile->open(QIODevice::ReadOnly))
+			m_mappedData = mappedFile->map(0, mappedFile->size());
+		if (m_mappedData != nullptr)
+		{
+			m_file = mappedFile;
+			m_mappedSize = mappedFile->size();
+			return true;
+		}
+
+		qWarning("Could not map opening book %s, using disk access",
+			 qUtf8Printable(filename));
+		m_mode = Disk;
+	}
+
 	if (m_mode == Disk)
 		return true;
 
-	m_map.clear();
-	QDataStream in(&file);
-	in >> this;
+	m_keys.clear();
+	m_moves.clear();
+	m_weights.clear();
+	m_sortedCount = 0;
+
+	const int step = entrySize();
+	const int count = int(qMin(file.size() / step, qint64(INT_MAX)));
+	m_keys.reserve(count);
+	m_moves.reserve(count);
+	m_weights.reserve(count);
+
+	// Read the book in large blocks and sort it once at the end
+	while (m_keys.size() < count)
+	{
+		const QByteArray block(file.read(qint64(4096) * step));
+		if (block.size() < step)
+			break;
 
-	return !m_map.isEmpty();
+		const uchar* data = reinterpret_cast<const uchar*>(block.constData());
+		for (int pos = 0; pos + step <= block.size(); pos += step)
+		{
+			quint64 key;
+			Entry entry = entryFromData(data + pos, &key);
+			m_keys.append(key);
+			m_moves.append(packMove(entry.move));
+			m_weights.append(entry.weight);
+		}
+	}
+	sortEntries();
+
+	return !m_keys.isEmpty();
 }
 
 bool OpeningBook::write(const QString& filename) const
@@ -94,22 +203,119 @@ bool OpeningBook::write(const QString& filename) const
 
 void OpeningBook::addEntry(const Entry& entry, quint64 key)
 {
-	Map::iterator it = m_map.find(key);
-	while (it != m_map.end() && it.key() == key)
+	m_keys.append(key);
+	m_moves.append(packMove(entry.move));
+	m_weights.append(entry.weight);
+}
+
+void OpeningBook::sortEntries()
+{
+	const int n = m_keys.size();
+	if (m_sortedCount == n)
+		return;
+
+	// Order the entries by key. Entries with the same key keep
+	// their relative order.
+	if (!std::is_sorted(m_keys.constBegin(), m_keys.constEnd()))
+	{
+		QVector<int> order(n);
+		for (int i = 0; i < n; i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(),
+			[this](int a, int b)
+		{
+			return m_keys.at(a) < m_keys.at(b);
+		});
+
+		QVector<quint64> keys(n);
+		QVector<quint32> moves(n);
+		QVector<quint16> weights(n);
+		for (int i = 0; i < n; i++)
+		{
+			keys[i] = m_keys.at(order.at(i));
+			moves[i] = m_moves.at(order.at(i));
+			weights[i] = m_weights.at(order.at(i));
+		}
+		m_keys.swap(keys);
+		m_moves.swap(moves);
+		m_weights.swap(weights);
+	}
+
+	// Merge the entries that have the same key and move
+	int size = 0;
+	int first = 0;
+	for (int i = 0; i < n; i++)
 	{
-		Entry& tmp = it.value();
-		if (tmp.move == entry.move)
+		if (size == 0 || m_keys.at(i) != m_keys.at(size - 1))
+			first = size;
+
+		int j = first;
+		while (j < size && m_moves.at(j) != m_moves.at(i))
+			j++;
+		if (j < size)
 		{
-			tmp.weight += entry.weight;
-			return;
+			m_weights[j] += m_weights.at(i);
+			continue;
 		}
-		++it;
+
+		m_keys[size] = m_keys.at(i);
+		m_moves[size] = m_moves.at(i);
+		m_weights[size] = m_weights.at(i);
+		size++;
 	}
-	
-	m_map.insert(key, entry);
+	m_keys.resize(size);
+	m_moves.resize(size);
+	m_weights.resize(size);
+	m_sortedCount = size;
+}
+
+int OpeningBook::findEntries(quint64 key, int* count) const
+{
+	// The book is sorted when entries are added, so probing it
+	// doesn't modify anything
+	Q_ASSERT(m_sortedCount == m_keys.size());
+
+	*count = 0;
+	const int n = m_keys.size();
+	if (n == 0)
+		return 0;
+
+	// Branchless binary search for the first entry whose
+	// key is not less than the searched key
+	const quint64* keys = m_keys.constData();
+	const quint64* base = keys;
+	int len = n;
+	while (len > 1)
+	{
+		const int half = len / 2;
+		base += (base[half - 1] < key) ? half : 0;
+		len -= half;
+	}
+	base += (*base < key);
+
+	const int index = int(base - keys);
+	int end = index;
+	while (end < n && keys[end] == key)
+		end++;
+	*count = end - index;
+
+	return index;
+}
+
+OpeningBook::Entry OpeningBook::entryAt(int index) const
+{
+	return { unpackMove(m_moves.at(index)), m_weights.at(index) };
 }
 
 int OpeningBook::import(const PgnGame& pgn, int maxMoves)
+{
+	const int ret = importGame(pgn, maxMoves);
+	sortEntries();
+
+	return ret;
+}
+
+int OpeningBook::importGame(const PgnGame& pgn, int maxMoves)
 {
 	Q_ASSERT(maxMoves > 0);
 
@@ -155,15 +361,16 @@ int OpeningBook::import(PgnStream& in, int maxMoves)
 		if (game.moves().isEmpty())
 			break;
 
-		moveCount += import(game, maxMoves);
+		moveCount += importGame(game, maxMoves);
 	}
+	sortEntries();
 
 	return moveCount;
 }
 
-QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
+OpeningBook::EntryList OpeningBook::entriesFromDisk(quint64 key) const
 {
-	QList<Entry> entries;
+	EntryList entries;
 	QFile file(m_filename);
 	if (!file.open(QIODevice::ReadOnly))
 	{
@@ -190,14 +397,14 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 			first = middle + 1;
 		else if (entryKey == key)
 		{
-			entries << entry;
+			entries.append(entry);
 			for (qint64 i = pos - step; i >= 0; i -= step)
 			{
 				file.seek(i);
 				entry = readEntry(in, &entryKey);
 				if (entryKey != key)
 					break;
-				entries << entry;
+				entries.append(entry);
 			}
 			qint64 maxPos = (n - 1) * step;
 			for (qint64 i = pos + step; i <= maxPos; i += step)
@@ -206,7 +413,7 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 				entry = readEntry(in, &entryKey);
 				if (entryKey != key)
 					break;
-				entries << entry;
+				entries.append(entry);
 			}
 			return entries;
 		}
@@ -218,40 +425,89 @@ QList<OpeningBook::Entry> OpeningBook::entriesFromDisk(quint64 key) const
 	return entries;
 }
 
-QList<OpeningBook::Entry> OpeningBook::entries(quint64 key) const
+OpeningBook::EntryList OpeningBook::entriesFromMappedFile(quint64 key) const
 {
-	if (m_mode == Ram)
-		return m_map.values(key);
-	return entriesFromDisk(key);
+	EntryList entries;
+	if (m_mappedData == nullptr)
+		return entries;
+
+	quint64 entryKey = 0;
+	const int step = entrySize();
+	const qint64 n = m_mappedSize / step;
+
+	// Binary search for the first entry with a matching key
+	qint64 first = 0;
+	qint64 count = n;
+	while (count > 0)
+	{
+		qint64 half = count / 2;
+		entryFromData(m_mappedData + (first + half) * step, &entryKey);
+		if (entryKey < key)
+		{
+			first += half + 1;
+			count -= half + 1;
+		}
+		else
+			count = half;
+	}
+
+	for (qint64 i = first; i < n; i++)
+	{
+		Entry entry = entryFromData(m_mappedData + i * step, &entryKey);
+		if (entryKey != key)
+			break;
+		entries.append(entry);
+	}
+
+	return entries;
+}
+
+OpeningBook::Entry OpeningBook::entryFromData(const uchar* data,
+					      quint64* key) const
+{
+	const QByteArray bytes(QByteArray::fromRawData(
+		reinterpret_cast<const char*>(data), entrySize()));
+	QDataStream in(bytes);
+
+	return readEntry(in, key);
+}
+
+OpeningBook::EntryList OpeningBook::entries(quint64 key) const
+{
+	if (m_mode == Mapped)
+		return entriesFromMappedFile(key);
+	if (m_mode == Disk)
+		return entriesFromDisk(key);
+
+	EntryList entries;
+	int count = 0;
+	const int first = findEntries(key, &count);
+	for (int i = first; i < first + count; i++)
+		entries.append(entryAt(i));
+
+	return entries;
 }
 
 Chess::GenericMove OpeningBook::move(quint64 key) const
 {
-	Chess::GenericMove move;
-	
 	// There can be multiple entries/moves with the same key.
 	// We need to find them all to choose the best one
-	const auto entries = this->entries(key);
-	if (entries.isEmpty())
-		return move;
-	
-	// Calculate the total weight of all available moves
-	int totalWeight = 0;
-	for (const Entry& entry : entries)
-		totalWeight += entry.weight;
-	if (totalWeight <= 0)
-		return move;
-
-	// Pick a move randomly, with the highest-weighted move having
-	// the highest probability of getting picked.
-	int pick = Mersenne::random() % totalWeight;
-	int currentWeight = 0;
-	for (const Entry& entry : entries)
+	if (m_mode == Ram)
 	{
-		currentWeight += entry.weight;
-		if (currentWeight > pick)
-			return entry.move;
+		int count = 0;
+		const int first = findEntries(key, &count);
+		const quint16* weights = m_weights.constData() + first;
+		const int pick = pickEntry(count,
+					   [=](int i) { return weights[i]; });
+		if (pick == -1)
+			return Chess::GenericMove();
+		return unpackMove(m_moves.at(first + pick));
 	}
-	
-	return move;
+
+	const auto entries = this->entries(key);
+	const int pick = pickEntry(entries.size(),
+				   [&](int i) { return entries.at(i).weight; });
+	if (pick == -1)
+		return Chess::GenericMove();
+	return entries.at(pick).move;
 }
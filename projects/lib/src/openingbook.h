@@ -20,10 +20,13 @@
 #define OPENING_BOOK_H
 
 #include <QtGlobal>
-#include <QMultiMap>
+#include <QVector>
+#include <QVarLengthArray>
+#include <QSharedPointer>
 #include "board/genericmove.h"
 
 class QString;
+class QFile;
 class QDataStream;
 class PgnGame;
 class PgnStream;
@@ -32,13 +35,21 @@ class PgnStream;
 /*!
  * \brief A collection of opening moves for chess.
  *
- * OpeningBook is a container (binary tree) class for opening moves that
- * can be played by the GUI. When the game goes "out of book", control
- * of the game is transferred to the players.
+ * OpeningBook is a container class for opening moves that can be played
+ * by the GUI. When the game goes "out of book", control of the game is
+ * transferred to the players.
  *
  * The opening book can be stored externally in a binary file. When it's needed,
  * it is loaded in memory, and positions can be found quickly by searching
- * the book for Zobrist keys that match the current board position.
+ * the book for Zobrist keys that match the current board position. In
+ * memory the book is kept as flat arrays of keys, moves and weights that
+ * are sorted by key.
+ *
+ * Large books can also be memory-mapped instead of loaded. The mapping is
+ * created once by read() and it's never modified. The arrays of a RAM book
+ * are sorted before read() and import() return, so in every access mode a
+ * single OpeningBook object can be probed by many games and threads at the
+ * same time.
  */
 class LIB_EXPORT OpeningBook
 {
@@ -47,7 +58,8 @@ class LIB_EXPORT OpeningBook
 		enum AccessMode
 		{
 			Ram,	//!< Load the entire book to RAM
-			Disk	//!< Read moves directly from disk
+			Disk,	//!< Read moves directly from disk
+			Mapped	//!< Map the book file into memory
 		};
 
 		/*!
@@ -69,6 +81,14 @@ class LIB_EXPORT OpeningBook
 			quint16 weight;
 		};
 
+		/*!
+		 * A list of entries that match a Zobrist key.
+		 *
+		 * Positions rarely have more than a few dozen book moves,
+		 * so the entries usually don't need a heap allocation.
+		 */
+		typedef QVarLengthArray<Entry, 32> EntryList;
+
 		/*! Creates a new OpeningBook with access mode \a mode. */
 		OpeningBook(AccessMode mode = Ram);
 		/*! Destroys the opening book. */
@@ -82,6 +102,9 @@ class LIB_EXPORT OpeningBook
 		 * can be imported.
 		 *
 		 * Returns the number of moves imported.
+		 *
+		 * \note The book is sorted after every call, so many games
+		 * are imported faster from a PgnStream.
 		 */
 		int import(const PgnGame& pgn, int maxMoves);
 		/*!
@@ -109,7 +132,7 @@ class LIB_EXPORT OpeningBook
 		Chess::GenericMove move(quint64 key) const;
 
 		/*! Returns all entries matching \a key. */
-		QList<Entry> entries(quint64 key) const;
+		EntryList entries(quint64 key) const;
 
 		/*!
 		 * Reads a book from \a filename.
@@ -128,14 +151,23 @@ class LIB_EXPORT OpeningBook
 		friend LIB_EXPORT QDataStream& operator>>(QDataStream& in, OpeningBook* book);
 		friend LIB_EXPORT QDataStream& operator<<(QDataStream& out, const OpeningBook* book);
 
-		/*! The type of binary tree. */
-		typedef QMultiMap<quint64, Entry> Map;
-
 		/*! Returns the book format's internal entry size in bytes. */
 		virtual int entrySize() const = 0;
 
-		/*! Adds a new entry to the book. */
+		/*!
+		 * Adds a new entry to the book.
+		 *
+		 * If the book already has an entry with the same key and
+		 * move, the weight of \a entry is added to it when the
+		 * book is sorted. sortEntries() must be called after a batch
+		 * of new entries before the book is searched or written.
+		 */
 		void addEntry(const Entry& entry, quint64 key);
+		/*!
+		 * Merges the entries added by addEntry() into the sorted
+		 * book in one pass.
+		 */
+		void sortEntries();
 		
 		/*!
 		 * Reads a new book entry from \a in and returns it.
@@ -144,17 +176,38 @@ class LIB_EXPORT OpeningBook
 		 * belongs to the entry.
 		 */
 		virtual Entry readEntry(QDataStream& in, quint64* key) const = 0;
+		/*!
+		 * Reads a book entry from \a data, which points to entrySize()
+		 * bytes of raw book data, and returns it.
+		 *
+		 * The implementation must set \a key to the hash that
+		 * belongs to the entry. The default implementation calls
+		 * readEntry() with a data stream. Subclasses should reimplement
+		 * this function to decode the data directly.
+		 */
+		virtual Entry entryFromData(const uchar* data, quint64* key) const;
 		
-		/*! Writes the key and entry pointed to by \a it, to \a out. */
-		virtual void writeEntry(const Map::const_iterator& it,
+		/*! Writes \a key and \a entry to \a out. */
+		virtual void writeEntry(quint64 key,
+					const Entry& entry,
 					QDataStream& out) const = 0;
 
 	private:
-		QList<Entry> entriesFromDisk(quint64 key) const;
+		int importGame(const PgnGame& pgn, int maxMoves);
+		int findEntries(quint64 key, int* count) const;
+		Entry entryAt(int index) const;
+		EntryList entriesFromDisk(quint64 key) const;
+		EntryList entriesFromMappedFile(quint64 key) const;
 
 		AccessMode m_mode;
 		QString m_filename;
-		Map m_map;
+		QVector<quint64> m_keys;
+		QVector<quint32> m_moves;
+		QVector<quint16> m_weights;
+		int m_sortedCount;
+		QSharedPointer<QFile> m_file;
+		const uchar* m_mappedData;
+		qint64 m_mappedSize;
 };
 
 /*!
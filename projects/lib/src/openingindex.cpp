@@ -0,0 +1,486 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "openingindex.h"
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QSaveFile>
+#include <QtConcurrentRun>
+#include <QtEndian>
+
+namespace {
+
+const quint32 s_magic = 0x494F4343; // "CCOI"
+const quint32 s_version = 2;
+
+/*
+ * The file begins with a header of the magic number, the version,
+ * the format of the suite, a reserved word, the size and the
+ * modification time of the suite, and the number of openings.
+ * It is followed by the file position and the line number of each
+ * opening. All values are little-endian.
+ */
+const int s_keySize = 32;
+const int s_headerSize = 40;
+const int s_entrySize = 16;
+
+const int s_blockSize = 1024 * 1024;
+const qint64 s_minChunkSize = 4 * 1024 * 1024;
+
+struct Entry
+{
+	qint64 pos;
+	qint64 line;
+};
+
+/*
+ * The state of a PGN scan between two characters. It follows
+ * PgnStream::nextGame(), which skips comments, variations and
+ * escaped lines between games, and the reading of the tags that
+ * begin a game.
+ */
+struct PgnState
+{
+	enum Mode
+	{
+		BetweenGames,
+		InTags,
+		InSection
+	};
+
+	Mode mode;
+	bool inTag;
+	bool inQuotes;
+	char sectionStart;
+	char sectionEnd;
+	int level;
+};
+
+struct ScanResult
+{
+	// Openings with line numbers relative to the chunk
+	QVector<Entry> entries;
+	// The number of lines in the chunk
+	qint64 lineCount;
+	// True if the first entry is a tag at the start of the chunk,
+	// which begins a game only if the preceding chunk didn't end
+	// in the tags of a game
+	bool firstPending;
+	// The PGN state at the end of the chunk
+	PgnState state;
+};
+
+const PgnState s_betweenGames = {
+	PgnState::BetweenGames, false, false, 0, 0, 0
+};
+
+/*
+ * Returns the position of the first line that begins at or after
+ * \a pos in \a file, or the file size if there isn't one.
+ */
+qint64 alignToLine(QFile* file, qint64 pos)
+{
+	if (pos <= 0)
+		return 0;
+	if (!file->seek(pos - 1))
+		return file->size();
+
+	for (;;)
+	{
+		const QByteArray block = file->read(64 * 1024);
+		if (block.isEmpty())
+			return file->size();
+
+		const int i = block.indexOf('\n');
+		if (i != -1)
+			return pos + i;
+		pos += block.size();
+	}
+}
+
+/*
+ * Starts skipping the section that begins with \a c between games,
+ * like skipSection() of PgnStream does.
+ */
+void startSection(PgnState& state, char c)
+{
+	switch (c)
+	{
+	case '(':
+		state.sectionStart = '(';
+		state.sectionEnd = ')';
+		break;
+	case '{':
+		state.sectionStart = '{';
+		state.sectionEnd = '}';
+		break;
+	case ';':
+	case '%':
+		state.sectionStart = 0;
+		state.sectionEnd = '\n';
+		break;
+	default:
+		return;
+	}
+
+	state.mode = PgnState::InSection;
+	state.level = 1;
+}
+
+/*
+ * Advances PGN state \a state past character \a c.
+ *
+ * Returns true if a game begins at \a c.
+ */
+bool scanPgnChar(PgnState& state, char c)
+{
+	if (state.mode == PgnState::InSection)
+	{
+		if (c == state.sectionEnd && --state.level == 0)
+			state.mode = PgnState::BetweenGames;
+		else if (c == state.sectionStart)
+			state.level++;
+		return false;
+	}
+
+	if (state.mode == PgnState::InTags)
+	{
+		if (state.inTag)
+		{
+			if ((c == ']' && !state.inQuotes) || c == '\n' || c == '\r')
+			{
+				state.inTag = false;
+				state.inQuotes = false;
+			}
+			else if (c == '"')
+				state.inQuotes = !state.inQuotes;
+			return false;
+		}
+
+		if (c == '[')
+		{
+			state.inTag = true;
+			return false;
+		}
+		if (isspace(static_cast<unsigned char>(c)))
+			return false;
+
+		// The tags end at the movetext or at a comment
+		state.mode = PgnState::BetweenGames;
+	}
+
+	if (c != '[')
+	{
+		startSection(state, c);
+		return false;
+	}
+
+	state.mode = PgnState::InTags;
+	state.inTag = true;
+	state.inQuotes = false;
+	return true;
+}
+
+/*
+ * Scans the lines that begin in range [begin, end) of file
+ * \a fileName for openings. EPD openings begin at every non-empty
+ * line and PGN games at the first tag after a game's movetext,
+ * starting in PGN state \a state.
+ */
+ScanResult scanChunk(const QString& fileName,
+		     qint64 begin,
+		     qint64 end,
+		     bool pgn,
+		     PgnState state)
+{
+	ScanResult result = { QVector<Entry>(), 0, false, state };
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(begin))
+		return result;
+
+	QByteArray block;
+	qint64 blockPos = begin;
+	qint64 lineStart = begin;
+	qint64 line = 0;
+	bool lineEmpty = true;
+	bool chunkStart = (state.mode == PgnState::BetweenGames);
+
+	while (blockPos < end)
+	{
+		block.resize(int(qMin(qint64(s_blockSize), end - blockPos)));
+		const qint64 n = file.read(block.data(), block.size());
+		if (n <= 0)
+			break;
+
+		const char* data = block.constData();
+		for (int i = 0; i < n; i++)
+		{
+			const char c = data[i];
+			const bool space = isspace(static_cast<unsigned char>(c));
+
+			if (!pgn)
+			{
+				if (c == '\n')
+				{
+					lineStart = blockPos + i + 1;
+					lineEmpty = true;
+				}
+				else if (lineEmpty && !space)
+				{
+					result.entries.append({ lineStart, line });
+					lineEmpty = false;
+				}
+			}
+			else if (scanPgnChar(state, c))
+			{
+				if (chunkStart)
+					result.firstPending = true;
+				result.entries.append({ blockPos + i, line });
+			}
+
+			if (c == '\n')
+				line++;
+			if (!space)
+				chunkStart = false;
+		}
+		blockPos += n;
+	}
+
+	result.lineCount = line;
+	result.state = state;
+	return result;
+}
+
+} // anonymous namespace
+
+OpeningIndex::OpeningIndex()
+	: m_file(nullptr),
+	  m_data(nullptr),
+	  m_count(0),
+	  m_minChunkSize(s_minChunkSize)
+{
+}
+
+OpeningIndex::~OpeningIndex()
+{
+	close();
+}
+
+void OpeningIndex::setMinChunkSize(qint64 size)
+{
+	m_minChunkSize = qMax(size, Q_INT64_C(1));
+}
+
+QString OpeningIndex::indexFileName(const QString& fileName)
+{
+	return fileName + ".cci";
+}
+
+bool OpeningIndex::open(const QString& fileName,
+			OpeningSuite::Format format,
+			int threadCount)
+{
+	close();
+
+	const QFileInfo info(fileName);
+	if (!info.isFile())
+		return false;
+
+	// The index is valid only for this version of the suite
+	QByteArray header(s_keySize, 0);
+	uchar* p = reinterpret_cast<uchar*>(header.data());
+	qToLittleEndian<quint32>(s_magic, p);
+	qToLittleEndian<quint32>(s_version, p + 4);
+	qToLittleEndian<quint32>(quint32(format), p + 8);
+	qToLittleEndian<quint32>(0, p + 12);
+	qToLittleEndian<quint64>(quint64(info.size()), p + 16);
+	qToLittleEndian<qint64>(info.lastModified().toMSecsSinceEpoch(), p + 24);
+
+	const QString indexFile(indexFileName(fileName));
+	if (load(indexFile, header))
+		return true;
+	return build(fileName, indexFile, header, format, threadCount);
+}
+
+bool OpeningIndex::load(const QString& indexFileName, const QByteArray& header)
+{
+	m_file = new QFile(indexFileName);
+	if (!m_file->open(QIODevice::ReadOnly)
+	||  m_file->size() < s_headerSize)
+	{
+		close();
+		return false;
+	}
+
+	const qint64 size = m_file->size();
+	m_data = m_file->map(0, size);
+	if (m_data == nullptr)
+	{
+		// Fall back to reading the whole file into memory
+		m_buffer = m_file->readAll();
+		if (m_buffer.size() != size)
+		{
+			close();
+			return false;
+		}
+		m_data = reinterpret_cast<const uchar*>(m_buffer.constData());
+	}
+
+	const quint64 count = qFromLittleEndian<quint64>(m_data + s_keySize);
+	if (memcmp(m_data, header.constData(), s_keySize) != 0
+	||  count > quint64(INT_MAX)
+	||  quint64(size) != s_headerSize + count * s_entrySize)
+	{
+		close();
+		return false;
+	}
+
+	m_count = int(count);
+	return true;
+}
+
+bool OpeningIndex::build(const QString& fileName,
+			 const QString& indexFileName,
+			 const QByteArray& header,
+			 OpeningSuite::Format format,
+			 int threadCount)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Split the file into chunks that begin at line boundaries
+	const qint64 size = file.size();
+	const qint64 chunkSize = qMax(m_minChunkSize,
+				      size / (qMax(threadCount, 1) * 4));
+	QVector<qint64> bounds;
+	for (qint64 pos = 0; pos < size; )
+	{
+		bounds.append(pos);
+		pos = alignToLine(&file, pos + chunkSize);
+	}
+	bounds.append(size);
+	file.close();
+
+	/*
+	 * Scan the chunks in parallel. Every chunk is scanned as if it
+	 * began between games. A chunk that actually begins inside a
+	 * comment or a variation is scanned again once the state at the
+	 * end of the preceding chunk is known.
+	 */
+	const bool pgn = (format == OpeningSuite::PgnFormat);
+	QList< QFuture<ScanResult> > futures;
+	for (int i = 0; i < bounds.size() - 1; i++)
+		futures << QtConcurrent::run(scanChunk, fileName,
+					     bounds.at(i), bounds.at(i + 1),
+					     pgn, s_betweenGames);
+
+	QVector<Entry> entries;
+	qint64 lineBase = 1;
+	PgnState state = s_betweenGames;
+	for (int i = 0; i < futures.size(); i++)
+	{
+		ScanResult result = futures[i].result();
+		int first = 0;
+		if (state.mode == PgnState::InSection)
+			result = scanChunk(fileName, bounds.at(i), bounds.at(i + 1),
+					   pgn, state);
+		else if (state.mode == PgnState::InTags && result.firstPending)
+			first = 1;
+
+		for (int j = first; j < result.entries.size(); j++)
+		{
+			const Entry& entry = result.entries.at(j);
+			entries.append({ entry.pos, lineBase + entry.line });
+		}
+
+		lineBase += result.lineCount;
+		state = result.state;
+	}
+
+	m_buffer = header;
+	m_buffer.resize(s_headerSize + entries.size() * s_entrySize);
+	uchar* p = reinterpret_cast<uchar*>(m_buffer.data());
+	qToLittleEndian<quint64>(quint64(entries.size()), p + s_keySize);
+	p += s_headerSize;
+	for (const Entry& entry : qAsConst(entries))
+	{
+		qToLittleEndian<quint64>(quint64(entry.pos), p);
+		qToLittleEndian<quint64>(quint64(entry.line), p + 8);
+		p += s_entrySize;
+	}
+
+	m_data = reinterpret_cast<const uchar*>(m_buffer.constData());
+	m_count = entries.size();
+
+	// The suite may be in a read-only directory, in which case
+	// the index is rebuilt every time
+	QSaveFile out(indexFileName);
+	if (!out.open(QIODevice::WriteOnly)
+	||  out.write(m_buffer) != m_buffer.size()
+	||  !out.commit())
+		qWarning("Could not write opening index %s",
+			 qUtf8Printable(indexFileName));
+
+	return true;
+}
+
+void OpeningIndex::close()
+{
+	if (m_file != nullptr)
+	{
+		if (m_buffer.isEmpty() && m_data != nullptr)
+			m_file->unmap(const_cast<uchar*>(m_data));
+		delete m_file;
+		m_file = nullptr;
+	}
+
+	m_buffer.clear();
+	m_data = nullptr;
+	m_count = 0;
+}
+
+bool OpeningIndex::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+int OpeningIndex::count() const
+{
+	return m_count;
+}
+
+qint64 OpeningIndex::pos(int i) const
+{
+	Q_ASSERT(i >= 0 && i < m_count);
+	return qint64(qFromLittleEndian<quint64>(m_data + s_headerSize
+						 + qint64(i) * s_entrySize));
+}
+
+qint64 OpeningIndex::lineNumber(int i) const
+{
+	Q_ASSERT(i >= 0 && i < m_count);
+	return qint64(qFromLittleEndian<quint64>(m_data + s_headerSize
+						 + qint64(i) * s_entrySize + 8));
+}
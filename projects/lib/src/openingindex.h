@@ -0,0 +1,101 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENINGINDEX_H
+#define OPENINGINDEX_H
+
+#include <QByteArray>
+#include <QString>
+#include "openingsuite.h"
+class QFile;
+
+/*!
+ * \brief An index of the openings in an opening suite file.
+ *
+ * OpeningIndex stores the file position and line number of every
+ * opening in an EPD or PGN file, so that any opening can be read
+ * without scanning the file. The index is kept in a sidecar file
+ * next to the opening suite, and it is rebuilt when the size or the
+ * modification time of the suite changes. The sidecar file is
+ * memory-mapped when possible.
+ *
+ * \sa OpeningSuite
+ */
+class LIB_EXPORT OpeningIndex
+{
+	public:
+		/*! Creates a new index that isn't associated with a file. */
+		OpeningIndex();
+		/*! Destroys the index. */
+		~OpeningIndex();
+
+		/*!
+		 * Opens the index of opening suite \a fileName in \a format.
+		 *
+		 * If the sidecar file is missing or out of date, the suite
+		 * is scanned with \a threadCount threads and a new sidecar
+		 * file is written. If the sidecar file can't be written,
+		 * the index is kept in memory.
+		 *
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool open(const QString& fileName,
+			  OpeningSuite::Format format,
+			  int threadCount);
+		/*! Closes the index. */
+		void close();
+		/*! Returns true if the index is open. */
+		bool isOpen() const;
+
+		/*! Returns the number of openings in the suite. */
+		int count() const;
+		/*! Returns the file position of opening \a i. */
+		qint64 pos(int i) const;
+		/*! Returns the line number of opening \a i. */
+		qint64 lineNumber(int i) const;
+
+		/*!
+		 * Sets the smallest size of the chunks that the suite is
+		 * split into for scanning to \a size bytes.
+		 *
+		 * The default size is 4 MiB. Smaller chunks are mainly
+		 * useful for testing.
+		 */
+		void setMinChunkSize(qint64 size);
+
+		/*! Returns the name of the sidecar file of \a fileName. */
+		static QString indexFileName(const QString& fileName);
+
+	private:
+		Q_DISABLE_COPY(OpeningIndex)
+
+		bool load(const QString& indexFileName, const QByteArray& header);
+		bool build(const QString& fileName,
+			   const QString& indexFileName,
+			   const QByteArray& header,
+			   OpeningSuite::Format format,
+			   int threadCount);
+
+		QFile* m_file;
+		QByteArray m_buffer;
+		const uchar* m_data;
+		int m_count;
+		qint64 m_minChunkSize;
+};
+
+#endif // OPENINGINDEX_H
@@ -19,8 +19,10 @@
 #include "openingsuite.h"
 #include <QFile>
 #include <QTextStream>
+#include <QThread>
 #include <algorithm>
 #include "pgnstream.h"
+#include "openingindex.h"
 #include "epdrecord.h"
 #include "mersenne.h"
 
@@ -33,7 +35,8 @@ OpeningSuite::OpeningSuite(const QString& fen)
 	  m_fen(fen),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_index(nullptr)
 {
 }
 
@@ -49,12 +52,14 @@ OpeningSuite::OpeningSuite(const QString& fileName,
 	  m_fileName(fileName),
 	  m_file(nullptr),
 	  m_epdStream(nullptr),
-	  m_pgnStream(nullptr)
+	  m_pgnStream(nullptr),
+	  m_index(nullptr)
 {
 }
 
 OpeningSuite::~OpeningSuite()
 {
+	delete m_index;
 	if (m_epdStream != nullptr)
 	{
 		delete m_epdStream->device();
@@ -62,8 +67,10 @@ OpeningSuite::~OpeningSuite()
 	}
 	if (m_pgnStream != nullptr)
 	{
-		delete m_pgnStream->device();
+		// The stream uses its device when it is destroyed
+		QIODevice* device = m_pgnStream->device();
 		delete m_pgnStream;
+		delete device;
 	}
 }
 
@@ -89,7 +96,9 @@ bool OpeningSuite::initialize()
 
 	m_gamesRead = 0;
 	m_gameIndex = 0;
-	m_filePositions.clear();
+	m_permutation.clear();
+	delete m_index;
+	m_index = nullptr;
 
 	if (m_epdStream != nullptr)
 	{
@@ -99,8 +108,10 @@ bool OpeningSuite::initialize()
 	}
 	if (m_pgnStream != nullptr)
 	{
-		delete m_pgnStream->device();
+		// The stream uses its device when it is destroyed
+		QIODevice* device = m_pgnStream->device();
 		delete m_pgnStream;
+		delete device;
 		m_pgnStream = nullptr;
 	}
 
@@ -122,60 +133,55 @@ bool OpeningSuite::initialize()
 		m_epdStream = new QTextStream(m_file);
 	}
 
-	if (m_order == RandomOrder)
-	{
-		// Create a vector of file positions
-		for (;;)
-		{
-			FilePosition pos;
-			if (m_format == EpdFormat)
-				pos = getEpdPos();
-			else if (m_format == PgnFormat)
-				pos = getPgnPos();
+	if (m_order == SequentialOrder && m_startIndex <= 0)
+		return true;
 
-			if (pos.pos == -1)
-				break;
+	m_index = new OpeningIndex;
+	if (!m_index->open(m_fileName, m_format, QThread::idealThreadCount()))
+	{
+		qWarning("Can't index opening suite %s",
+			 qUtf8Printable(m_fileName));
+		return false;
+	}
 
-			m_filePositions.append(pos);
-		}
+	const int count = m_index->count();
+	if (count == 0)
+	{
+		qWarning("No openings found in %s", qUtf8Printable(m_fileName));
+		return false;
+	}
+	if (m_startIndex >= count)
+		qWarning("Start index larger than book size, wrapping after %d.", count);
 
+	if (m_order == RandomOrder)
+	{
 		// use a Knuth shuffle to generate a random permutation
-		for (int i = 0; i <= m_filePositions.size() - 2; i++)
+		m_permutation.resize(count);
+		for (int i = 0; i < count; i++)
+			m_permutation[i] = i;
+		for (int i = 0; i <= count - 2; i++)
 		{
-			int j = i + Mersenne::random() % (m_filePositions.size() - i);
-			std::swap(m_filePositions[i], m_filePositions[j]);
+			int j = i + Mersenne::random() % (count - i);
+			std::swap(m_permutation[i], m_permutation[j]);
 		}
 
-		if (m_startIndex >= m_filePositions.size())
-			qWarning("Start index larger than book size, wrapping after %d.", m_filePositions.size());
-
-		m_gameIndex += m_startIndex % m_filePositions.size();
+		m_gameIndex += m_startIndex % count;
 	}
 	else if (m_order == SequentialOrder)
 	{
-		for (int i = 0; i < m_startIndex; i++)
+		// Seek directly to the first opening
+		const int i = m_startIndex % count;
+		if (m_format == EpdFormat)
 		{
-			FilePosition pos;
-			if (m_format == EpdFormat)
-			{
-				pos = getEpdPos();
-				if (m_epdStream->atEnd())
-				{
-					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
-					m_epdStream->seek(0);
-					m_epdStream->resetStatus();
-                                }
-			}
-			else if (m_format == PgnFormat)
-			{
-				pos = getPgnPos();
-				if (!m_pgnStream->nextGame())
-				{
-					qWarning("Start index larger than book size, wrapping after %d.", i + 1);
-					m_pgnStream->rewind();
-				}
-			}
+			m_epdStream->seek(m_index->pos(i));
+			m_epdStream->resetStatus();
 		}
+		else if (m_format == PgnFormat)
+			m_pgnStream->seek(m_index->pos(i), m_index->lineNumber(i));
+
+		// Sequential reading doesn't need the index
+		delete m_index;
+		m_index = nullptr;
 	}
 
 	return true;
@@ -193,20 +199,27 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 	if (isNull())
 		return game;
 
-	FilePosition pos = { -1, -1 };
+	qint64 pos = -1;
+	qint64 lineNumber = -1;
 	if (m_order == RandomOrder)
 	{
-		pos = m_filePositions.at(m_gameIndex++);
-		if (m_gameIndex >= m_filePositions.size())
+		if (m_permutation.isEmpty())
+			return game;
+
+		const int i = m_permutation.at(m_gameIndex++);
+		if (m_gameIndex >= m_permutation.size())
 			m_gameIndex = 0;
+
+		pos = m_index->pos(i);
+		lineNumber = m_index->lineNumber(i);
 	}
 
 	bool ok = false;
 	if (m_format == EpdFormat)
 	{
-		if (pos.pos != -1)
+		if (pos != -1)
 		{
-			m_epdStream->seek(pos.pos);
+			m_epdStream->seek(pos);
 			m_epdStream->resetStatus();
 		}
 
@@ -227,8 +240,8 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 	}
 	else if (m_format == PgnFormat)
 	{
-		if (pos.pos != -1)
-			m_pgnStream->seek(pos.pos, pos.lineNumber);
+		if (pos != -1)
+			m_pgnStream->seek(pos, lineNumber);
 
 		ok = game.read(*m_pgnStream, maxPlies);
 
@@ -245,61 +258,3 @@ PgnGame OpeningSuite::nextGame(int maxPlies)
 		m_gamesRead++;
 	return game;
 }
-
-OpeningSuite::FilePosition OpeningSuite::getPgnPos()
-{
-	FilePosition pos = { -1, -1 };
-	if (!m_pgnStream->nextGame())
-		return pos;
-
-	pos.pos = m_pgnStream->pos();
-	pos.lineNumber = m_pgnStream->lineNumber();
-
-	char c;
-	bool inTag = false;
-	bool inQuotes = false;
-
-	while ((c = m_pgnStream->readChar()) != 0)
-	{
-		if (!inTag)
-		{
-			if (c == '[')
-				inTag = true;
-			else if (!isspace(c))
-			{
-				m_pgnStream->rewindChar();
-				break;
-			}
-
-			continue;
-		}
-
-		if ((c == ']' && !inQuotes) || c == '\n' || c == '\r')
-		{
-			inTag = false;
-			inQuotes = false;
-		}
-		else if (c == '\"')
-			inQuotes = !inQuotes;
-	}
-
-	return pos;
-}
-
-OpeningSuite::FilePosition OpeningSuite::getEpdPos()
-{
-	FilePosition pos = { m_file->pos(), -1 };
-
-	while (m_file->readLine().isEmpty())
-	{
-		if (m_file->atEnd())
-		{
-			pos.pos = -1;
-			break;
-		}
-		else
-			pos.pos = m_file->pos();
-	}
-
-	return pos;
-}
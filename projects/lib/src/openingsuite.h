@@ -25,6 +25,7 @@ class QString;
 class QFile;
 class QTextStream;
 class PgnStream;
+class OpeningIndex;
 
 /*!
  * \brief A suite of chess openings
@@ -91,11 +92,13 @@ class LIB_EXPORT OpeningSuite
 		/*!
 		 * Initializes the opening suite.
 		 *
-		 * If \a order is SequentialOrder, this function just opens
-		 * the opening suite file and gets ready to read data. If
-		 * \a order is RandomOrder, the file positions of all the
-		 * openings are parsed from the file, which could take some
-		 * time if the file is large.
+		 * If \a order is SequentialOrder and the start index is 0,
+		 * this function just opens the opening suite file and gets
+		 * ready to read data. Otherwise the file positions of the
+		 * openings are read from an index file, which is built
+		 * first if the suite doesn't have an up-to-date index.
+		 *
+		 * \sa OpeningIndex
 		 *
 		 * Returns true if successful; otherwise returns false.
 		 */
@@ -107,15 +110,6 @@ class LIB_EXPORT OpeningSuite
 		PgnGame nextGame(int maxPlies);
 
 	private:
-		struct FilePosition
-		{
-			qint64 pos;
-			qint64 lineNumber;
-		};
-
-		FilePosition getPgnPos();
-		FilePosition getEpdPos();
-
 		Format m_format;
 		Order m_order;
 		int m_gamesRead;
@@ -126,7 +120,8 @@ class LIB_EXPORT OpeningSuite
 		QFile* m_file;
 		QTextStream* m_epdStream;
 		PgnStream* m_pgnStream;
-		QVector<FilePosition> m_filePositions;
+		OpeningIndex* m_index;
+		QVector<int> m_permutation;
 };
 
 #endif // OPENINGSUITE_H
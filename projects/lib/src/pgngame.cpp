@@ -53,7 +53,6 @@ QTextStream& operator<<(QTextStream& out, const PgnGame& game)
 
 PgnGame::PgnGame()
 	: m_startingSide(Chess::Side::White),
-	  m_eco(EcoNode::root()),
 	  m_tagReceiver(nullptr)
 {
 }
@@ -66,7 +65,6 @@ bool PgnGame::isNull() const
 void PgnGame::clear()
 {
 	m_startingSide = Chess::Side();
-	m_eco = EcoNode::root();
 	m_tags.clear();
 	m_moves.clear();
 }
@@ -101,19 +99,22 @@ const QVector<PgnGame::MoveData>& PgnGame::moves() const
 	return m_moves;
 }
 
-void PgnGame::addMove(const MoveData& data, bool addEco)
+void PgnGame::addMove(const MoveData& data)
 {
 	m_moves.append(data);
+}
 
-	if (addEco) {
-		m_eco = (m_eco && isStandard()) ? m_eco->child(data.moveString)
-						: nullptr;
-		if (m_eco && m_eco->isLeaf())
-		{
-			setTag("ECO", m_eco->ecoCode());
-			setTag("Opening", m_eco->opening());
-			setTag("Variation", m_eco->variation());
-		}
+void PgnGame::updateEco(quint64 key)
+{
+	if (m_moves.size() > EcoNode::maxPly() || !isStandard())
+		return;
+
+	const EcoNode* eco = EcoNode::find(key);
+	if (eco != nullptr)
+	{
+		setTag("ECO", eco->ecoCode());
+		setTag("Opening", eco->opening());
+		setTag("Variation", eco->variation());
 	}
 }
 
@@ -203,9 +204,11 @@ bool PgnGame::parseMove(PgnStream& in, bool addEco)
 
 	MoveData md = { board->key(), board->genericMove(move),
 			str, QString() };
-	addMove(md, addEco);
+	addMove(md);
 
 	board->makeMove(move);
+	if (addEco)
+		updateEco(board->key());
 	return true;
 }
 
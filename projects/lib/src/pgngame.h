@@ -29,7 +29,6 @@
 #include "board/result.h"
 class QTextStream;
 class PgnStream;
-class EcoNode;
 class QObject;
 namespace Chess { class Board; }
 
@@ -84,11 +83,16 @@ class LIB_EXPORT PgnGame
 		QList< QPair<QString, QString> > tags() const;
 		/*! Returns the moves that were played in the game. */
 		const QVector<MoveData>& moves() const;
-		/*! Adds a new move to the game.
-		 * \param data The move to add.
-		 * \param addEco Adds opening information if true.
+		/*! Adds a new move to the game. */
+		void addMove(const MoveData& data);
+		/*!
+		 * Sets the ECO, Opening and Variation tags if the position
+		 * with zobrist key \a key is a known opening.
+		 *
+		 * This should be called with the key of the position after
+		 * each move. It has no effect on non-standard games.
 		 */
-		void addMove(const MoveData& data, bool addEco = true);
+		void updateEco(quint64 key);
 		void setMove(int ply, const MoveData& data);
 
 		/*!
@@ -209,7 +213,6 @@ class LIB_EXPORT PgnGame
 		bool parseMove(PgnStream& in, bool addEco);
 		
 		Chess::Side m_startingSide;
-		const EcoNode* m_eco;
 		QMap<QString, QString> m_tags;
 		QVector<MoveData> m_moves;
 		QObject* m_tagReceiver;
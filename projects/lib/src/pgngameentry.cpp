@@ -17,11 +17,13 @@
 */
 
 #include "pgngameentry.h"
+#include <algorithm>
 #include <cctype>
 #include <QDataStream>
 #include <QMap>
 #include "pgnstream.h"
 #include "pgngamefilter.h"
+#include "pgntagpool.h"
 
 namespace {
 
@@ -40,14 +42,14 @@ int s_stringContains(const char* s1, const char* s2, int size)
 
 	while (s1 < s1_end)
 	{
-		if (toupper(*s1) == toupper(*s2))
+		if (toupper(uchar(*s1)) == toupper(uchar(*s2)))
 		{
 			const char* a = s1 + 1;
 			const char* b = s2 + 1;
 
 			while (*b && a < s1_end)
 			{
-				if (toupper(*a) != toupper(*b))
+				if (toupper(uchar(*a)) != toupper(uchar(*b)))
 					break;
 				a++;
 				b++;
@@ -68,7 +70,7 @@ int s_stringToInt(const char *s, int size)
 	int num = 0;
 	for (int i = 0; i < size; i++)
 	{
-		if (!isdigit(s[i]))
+		if (!isdigit(static_cast<unsigned char>(s[i])))
 			return 0;
 		num = num * 10 + (s[i] - '0');
 	}
@@ -96,26 +98,35 @@ QDataStream& operator<<(QDataStream& out, const PgnGameEntry& entry)
 	return out;
 }
 
-PgnGameEntry::PgnGameEntry()
-	: m_pos(0),
+PgnGameEntry::PgnGameEntry(PgnTagPool* pool)
+	: m_pool(pool),
+	  m_pos(0),
 	  m_lineNumber(1)
 {
+	std::fill(m_tags, m_tags + VariantTag + 1, 0);
 }
 
 bool PgnGameEntry::match(const PgnGameFilter& filter) const
 {
-	const char* data = m_data.constData();
+	int size;
+	const char* str;
 
 	if (filter.type() == PgnGameFilter::FixedString)
-		return s_stringContains(data, filter.pattern(), m_data.size()) != -1;
+	{
+		for (int type = EventTag; type <= VariantTag; type++)
+		{
+			str = tag(TagType(type), &size);
+			if (s_stringContains(str, filter.pattern(), size) != -1)
+				return true;
+		}
+		return false;
+	}
 
 	int whitePlayer = 0;
 
-	int i = 0;
-	for (int type = 0; type < 8; type++)
+	for (int type = EventTag; type <= VariantTag; type++)
 	{
-		int size = data[i++];
-		const char* str = data + i;
+		str = tag(TagType(type), &size);
 
 		switch (type)
 		{
@@ -130,20 +141,9 @@ bool PgnGameEntry::match(const PgnGameFilter& filter) const
 		case DateTag:
 			if (!filter.minDate().isNull() || !filter.maxDate().isNull())
 			{
-				if (size < 10)
-					return false;
-
-				int year = s_stringToInt(str, 4);
-				if (year == 0)
+				QDate date;
+				if (!parseDate(str, size, &date))
 					return false;
-				int month = s_stringToInt(str + 5, 2);
-				if (month == 0)
-					month = 1;
-				int day = s_stringToInt(str + 8, 2);
-				if (day == 0)
-					day = 1;
-
-				QDate date(year, month, day);
 
 				if ((!filter.minDate().isNull() && date < filter.minDate())
 				||  (!filter.maxDate().isNull() && date > filter.maxDate()))
@@ -153,7 +153,7 @@ bool PgnGameEntry::match(const PgnGameFilter& filter) const
 		case RoundTag:
 			if (filter.minRound() != 0 || filter.maxRound() != 0)
 			{
-				int round = s_stringToInt(str, size);
+				int round = parseRound(str, size);
 
 				if (round == 0
 				||  (filter.minRound() != 0 && round < filter.minRound())
@@ -247,35 +247,27 @@ bool PgnGameEntry::match(const PgnGameFilter& filter) const
 		default:
 			break;
 		}
-		i += size;
 	}
 
 	return true;
 }
 
-void PgnGameEntry::addTag(const QByteArray& tagValue)
-{
-	int size = qMin(127, tagValue.size());
-
-	m_data.append(char(size));
-	m_data.append(tagValue.constData(), size);
-}
-
 void PgnGameEntry::clear()
 {
 	m_pos = 0;
 	m_lineNumber = 1;
-	m_data.clear();
+	std::fill(m_tags, m_tags + VariantTag + 1, 0);
 }
 
 bool PgnGameEntry::read(PgnStream& in)
 {
+	Q_ASSERT(m_pool != nullptr);
+
 	if (!in.nextGame())
 		return false;
 
 	m_pos = in.pos();
 	m_lineNumber = in.lineNumber();
-	m_data.clear();
 
 	char c;
 	QByteArray tagName;
@@ -324,14 +316,14 @@ bool PgnGameEntry::read(PgnStream& in)
 			tagValue += c;
 	}
 
-	addTag(tags["Event"]);
-	addTag(tags["Site"]);
-	addTag(tags["Date"]);
-	addTag(tags["Round"]);
-	addTag(tags["White"]);
-	addTag(tags["Black"]);
-	addTag(tags["Result"]);
-	addTag(tags["Variant"]);
+	m_tags[EventTag] = m_pool->intern(tags["Event"]);
+	m_tags[SiteTag] = m_pool->intern(tags["Site"]);
+	m_tags[DateTag] = m_pool->intern(tags["Date"]);
+	m_tags[RoundTag] = m_pool->intern(tags["Round"]);
+	m_tags[WhiteTag] = m_pool->intern(tags["White"]);
+	m_tags[BlackTag] = m_pool->intern(tags["Black"]);
+	m_tags[ResultTag] = m_pool->intern(tags["Result"]);
+	m_tags[VariantTag] = m_pool->intern(tags["Variant"]);
 
 	return true;
 }
@@ -343,9 +335,46 @@ bool PgnGameEntry::read(QDataStream& in)
 
 	in >> m_pos;
 	in >> m_lineNumber;
-	in >> m_data;
+	for (quint32& id : m_tags)
+		in >> id;
+
+	if (in.status() != QDataStream::Ok)
+		return false;
+	if (m_pool == nullptr)
+		return true;
 
-	return in.status() == QDataStream::Ok;
+	for (quint32 id : m_tags)
+	{
+		if (int(id) >= m_pool->count())
+			return false;
+	}
+	return true;
+}
+
+bool PgnGameEntry::readLegacy(QDataStream& in)
+{
+	Q_ASSERT(m_pool != nullptr);
+
+	QByteArray data;
+	in >> m_pos;
+	in >> m_lineNumber;
+	in >> data;
+
+	if (in.status() != QDataStream::Ok)
+		return false;
+
+	// Each tag value is prefixed by its length in one byte
+	int i = 0;
+	for (quint32& id : m_tags)
+	{
+		const int size = i < data.size() ? data.at(i++) : 0;
+		if (size < 0 || i + size > data.size())
+			return false;
+
+		id = m_pool->intern(data.constData() + i, size);
+		i += size;
+	}
+	return true;
 }
 
 void PgnGameEntry::write(QDataStream& out) const
@@ -355,7 +384,8 @@ void PgnGameEntry::write(QDataStream& out) const
 
 	out << m_pos;
 	out << m_lineNumber;
-	out << m_data;
+	for (quint32 id : m_tags)
+		out << id;
 }
 
 qint64 PgnGameEntry::pos() const
@@ -368,14 +398,73 @@ qint64 PgnGameEntry::lineNumber() const
 	return m_lineNumber;
 }
 
-QString PgnGameEntry::tagValue(TagType type) const
+void PgnGameEntry::addOffset(qint64 pos, qint64 lineCount)
 {
-	int i = 0;
-	for (int j = 0; j < type; j++)
-		i += m_data[i] + 1;
+	m_pos += pos;
+	m_lineNumber += lineCount;
+}
 
-	int size = m_data[i];
+PgnTagPool* PgnGameEntry::tagPool() const
+{
+	return m_pool;
+}
+
+void PgnGameEntry::setTagPool(PgnTagPool* pool, const QVector<quint32>& ids)
+{
+	for (quint32& id : m_tags)
+		id = ids.at(id);
+	m_pool = pool;
+}
+
+quint32 PgnGameEntry::tagId(TagType type) const
+{
+	return m_tags[type];
+}
+
+const char* PgnGameEntry::tag(TagType type, int* size) const
+{
+	if (m_pool == nullptr)
+	{
+		*size = 0;
+		return "";
+	}
+
+	const quint32 id = m_tags[type];
+	*size = m_pool->size(id);
+	return m_pool->data(id);
+}
+
+bool PgnGameEntry::parseDate(const char* str, int size, QDate* date)
+{
+	Q_ASSERT(date != nullptr);
+
+	if (size < 10)
+		return false;
+
+	int year = s_stringToInt(str, 4);
+	if (year == 0)
+		return false;
+	int month = s_stringToInt(str + 5, 2);
+	if (month == 0)
+		month = 1;
+	int day = s_stringToInt(str + 8, 2);
+	if (day == 0)
+		day = 1;
+
+	*date = QDate(year, month, day);
+	return true;
+}
+
+int PgnGameEntry::parseRound(const char* str, int size)
+{
+	return s_stringToInt(str, size);
+}
+
+QString PgnGameEntry::tagValue(TagType type) const
+{
+	int size;
+	const char* str = tag(type, &size);
 	if (size == 0)
 		return QString();
-	return m_data.mid(i + 1, size);
+	return QString::fromUtf8(str, size);
 }
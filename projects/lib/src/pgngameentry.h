@@ -20,9 +20,11 @@
 #define PGNGAMEENTRY_H
 
 #include <QDate>
+#include <QVector>
 #include "board/result.h"
 class PgnStream;
 class PgnGameFilter;
+class PgnTagPool;
 class QDataStream;
 
 
@@ -35,7 +37,11 @@ class QDataStream;
  * consumption, which is useful for quickly loading large game
  * collections.
  *
- * \sa PgnGame, PgnStream
+ * The tag values are stored as IDs in a PgnTagPool which is
+ * shared by all the entries of a collection, so an entry is a
+ * small fixed-size value that can be stored in contiguous arrays.
+ *
+ * \sa PgnGame, PgnStream, PgnTagPool
  */
 class LIB_EXPORT PgnGameEntry
 {
@@ -53,22 +59,39 @@ class LIB_EXPORT PgnGameEntry
 			VariantTag	//!< The chess variant of the game
 		};
 
-		/*! Creates a new empty PgnGameEntry object. */
-		PgnGameEntry();
+		/*!
+		 * Creates a new empty PgnGameEntry object that stores its
+		 * tag values in \a pool.
+		 *
+		 * The pool must outlive the entry.
+		 */
+		explicit PgnGameEntry(PgnTagPool* pool = nullptr);
 
 		/*! Resets the entry to an empty default. */
 		void clear();
 		/*!
 		 * Reads an entry from a PGN stream.
 		 * Returns true if successful; otherwise returns false.
+		 *
+		 * \note The entry must have a tag pool.
 		 */
 		bool read(PgnStream& in);
 
 		/*!
 		 * Reads an entry from data stream.
 		 * Returns true if successful; otherwise returns false.
+		 *
+		 * The tag IDs refer to the entry's tag pool, which must be
+		 * read separately.
 		 */
 		bool read(QDataStream& in);
+		/*!
+		 * Reads an entry in the old format where every entry has
+		 * its own copy of the tag values, and adds the values to
+		 * the entry's tag pool.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool readLegacy(QDataStream& in);
 
 		/*!
 		 * Writes an entry to data stream.
@@ -85,17 +108,52 @@ class LIB_EXPORT PgnGameEntry
 		qint64 pos() const;
 		/*! Returns the line number where the game begins. */
 		qint64 lineNumber() const;
+		/*!
+		 * Moves the entry forward by \a pos bytes and \a lineCount
+		 * lines.
+		 *
+		 * This is needed when the entry was read from a part of a
+		 * larger PGN stream.
+		 */
+		void addOffset(qint64 pos, qint64 lineCount);
 
+		/*! Returns the tag pool of the entry. */
+		PgnTagPool* tagPool() const;
+		/*!
+		 * Moves the entry to tag pool \a pool.
+		 *
+		 * \a ids maps the IDs of the current pool to the IDs of
+		 * \a pool, as returned by PgnTagPool::merge().
+		 */
+		void setTagPool(PgnTagPool* pool, const QVector<quint32>& ids);
+
+		/*! Returns the tag pool ID of the tag value of \a type. */
+		quint32 tagId(TagType type) const;
 		/*! Returns the tag value corresponding to \a type. */
 		QString tagValue(TagType type) const;
 
-	private:
-		void addTag(const QByteArray& tagValue);
+		/*!
+		 * Parses the Date tag value \a str of \a size bytes.
+		 *
+		 * Returns false if the value doesn't have a year. Otherwise
+		 * stores the date in \a date and returns true. An unknown
+		 * month or day counts as the first one, and \a date is
+		 * invalid if the value isn't a valid date.
+		 */
+		static bool parseDate(const char* str, int size, QDate* date);
+		/*!
+		 * Returns the round number of the Round tag value \a str of
+		 * \a size bytes, or 0 if the value isn't a number.
+		 */
+		static int parseRound(const char* str, int size);
 
-		QByteArray m_data;
+	private:
+		const char* tag(TagType type, int* size) const;
 
+		PgnTagPool* m_pool;
 		qint64 m_pos;
 		qint64 m_lineNumber;
+		quint32 m_tags[VariantTag + 1];
 };
 
 /*! Reads a PGN game entry from a PGN stream. */
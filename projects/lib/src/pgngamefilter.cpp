@@ -25,7 +25,10 @@ PgnGameFilter::PgnGameFilter()
 	  m_minRound(0),
 	  m_maxRound(0),
 	  m_result(AnyResult),
-	  m_resultInverted(false)
+	  m_resultInverted(false),
+	  m_hasPositionKey(false),
+	  m_positionKey(0),
+	  m_positionPly(0)
 {
 }
 
@@ -35,7 +38,10 @@ PgnGameFilter::PgnGameFilter(const QString& pattern)
 	  m_minRound(0),
 	  m_maxRound(0),
 	  m_result(AnyResult),
-	  m_resultInverted(false)
+	  m_resultInverted(false),
+	  m_hasPositionKey(false),
+	  m_positionKey(0),
+	  m_positionPly(0)
 {
 }
 
@@ -95,3 +101,10 @@ void PgnGameFilter::setResultInverted(bool invert)
 {
 	m_resultInverted = invert;
 }
+
+void PgnGameFilter::setPositionKey(quint64 key, int ply)
+{
+	m_hasPositionKey = true;
+	m_positionKey = key;
+	m_positionPly = ply;
+}
@@ -118,6 +118,25 @@ class LIB_EXPORT PgnGameFilter
 		 * of \a result(); otherwise returns false.
 		 */
 		bool isResultInverted() const;
+		/*!
+		 * Returns true if the filter only accepts games that reach
+		 * the position given by positionKey().
+		 */
+		bool hasPositionKey() const;
+		/*!
+		 * Returns the Zobrist key of the position that the games
+		 * must reach.
+		 *
+		 * \note PgnGameEntry::match() can't check the position; the
+		 * position filter is resolved with a PgnPositionIndex or by
+		 * replaying the games.
+		 */
+		quint64 positionKey() const;
+		/*!
+		 * Returns the number of plies that it took to reach the
+		 * position given by positionKey().
+		 */
+		int positionPly() const;
 
 		/*!
 		 * Sets the \a FixedString pattern to \a pattern.
@@ -146,6 +165,12 @@ class LIB_EXPORT PgnGameFilter
 		void setResult(Result result);
 		/*! Sets the \a resultInverted value to \a invert. */
 		void setResultInverted(bool invert);
+		/*!
+		 * Sets the filter to accept only games that reach the
+		 * position with Zobrist key \a key, which was reached
+		 * after \a ply plies.
+		 */
+		void setPositionKey(quint64 key, int ply);
 
 	private:
 		Type m_type;
@@ -161,6 +186,9 @@ class LIB_EXPORT PgnGameFilter
 		int m_maxRound;
 		Result m_result;
 		bool m_resultInverted;
+		bool m_hasPositionKey;
+		quint64 m_positionKey;
+		int m_positionPly;
 };
 
 inline PgnGameFilter::Type PgnGameFilter::type() const
@@ -228,4 +256,19 @@ inline Chess::Side PgnGameFilter::playerSide() const
 	return m_playerSide;
 }
 
+inline bool PgnGameFilter::hasPositionKey() const
+{
+	return m_hasPositionKey;
+}
+
+inline quint64 PgnGameFilter::positionKey() const
+{
+	return m_positionKey;
+}
+
+inline int PgnGameFilter::positionPly() const
+{
+	return m_positionPly;
+}
+
 #endif // PGNGAMEFILTER_H
@@ -0,0 +1,466 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pgnpositionindex.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <queue>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+namespace {
+
+const quint32 s_magic = 0x43435049; // "CCPI"
+const quint32 s_version = 2;
+
+/*
+ * The file begins with a header of the magic number, the version,
+ * the number of positions, the number of games and the number of
+ * plies indexed per game.
+ * It is followed by the sorted keys and then by the game indexes.
+ * All values are little-endian.
+ */
+const int s_headerSize = 24;
+
+// The default memory limit of PgnPositionIndex::Writer's buffer
+const qint64 s_defaultMemoryLimit = 64 * 1024 * 1024;
+// The number of positions read from or written to a file at a time
+const int s_blockSize = 4096;
+// The maximum number of run files merged at a time
+const int s_mergeFanIn = 64;
+
+typedef PgnPositionIndex::Position Position;
+
+bool lessThan(const Position& a, const Position& b)
+{
+	return a.key < b.key || (a.key == b.key && a.game < b.game);
+}
+
+bool isEqual(const Position& a, const Position& b)
+{
+	return a.key == b.key && a.game == b.game;
+}
+
+/*
+ * Merges the sorted run files \a runs, and calls \a write for every
+ * unique position in order. Returns false if a file can't be read or
+ * \a write returns false.
+ */
+bool mergeRuns(const QStringList& runs,
+	       const std::function<bool(const Position&)>& write)
+{
+	const int runCount = runs.size();
+	QList<QFile*> files;
+	QVector< QVector<Position> > blocks(runCount);
+	QVector<int> positions(runCount, 0);
+
+	// Reads the next block of run \a i, returns false at the end
+	auto readBlock = [&](int i)
+	{
+		QVector<Position>& block = blocks[i];
+		block.resize(s_blockSize);
+		const qint64 bytes = files.at(i)->read(
+			reinterpret_cast<char*>(block.data()),
+			qint64(s_blockSize) * sizeof(Position));
+		block.resize(int(qMax(bytes, qint64(0)) / qint64(sizeof(Position))));
+		positions[i] = 0;
+		return !block.isEmpty();
+	};
+
+	// A min-heap of the runs ordered by their current positions
+	auto greater = [&](int a, int b)
+	{
+		return lessThan(blocks.at(b).at(positions.at(b)),
+				blocks.at(a).at(positions.at(a)));
+	};
+	std::priority_queue<int, std::vector<int>, std::function<bool(int, int)>>
+		heap(greater);
+
+	bool ok = true;
+	for (int i = 0; i < runCount; i++)
+	{
+		QFile* file = new QFile(runs.at(i));
+		files.append(file);
+		if (!file->open(QIODevice::ReadOnly))
+		{
+			ok = false;
+			break;
+		}
+		if (readBlock(i))
+			heap.push(i);
+	}
+
+	// The same position may be in more than one run
+	bool havePosition = false;
+	Position last = { 0, 0 };
+	while (ok && !heap.empty())
+	{
+		const int i = heap.top();
+		heap.pop();
+
+		const Position pos = blocks.at(i).at(positions.at(i));
+		if (!havePosition || !isEqual(pos, last))
+		{
+			ok = write(pos);
+			last = pos;
+			havePosition = true;
+		}
+
+		if (++positions[i] < blocks.at(i).size() || readBlock(i))
+			heap.push(i);
+	}
+
+	qDeleteAll(files);
+	return ok;
+}
+
+} // anonymous namespace
+
+PgnPositionIndex::PgnPositionIndex()
+	: m_file(nullptr),
+	  m_data(nullptr),
+	  m_count(0),
+	  m_gameCount(0),
+	  m_maxPlies(0)
+{
+}
+
+PgnPositionIndex::~PgnPositionIndex()
+{
+	close();
+}
+
+bool PgnPositionIndex::open(const QString& fileName)
+{
+	close();
+
+	m_file = new QFile(fileName);
+	if (!m_file->open(QIODevice::ReadOnly)
+	||  m_file->size() < s_headerSize)
+	{
+		close();
+		return false;
+	}
+
+	const qint64 size = m_file->size();
+	m_data = m_file->map(0, size);
+	if (m_data == nullptr)
+	{
+		// Fall back to reading the whole file into memory
+		m_buffer = m_file->readAll();
+		if (m_buffer.size() != size)
+		{
+			close();
+			return false;
+		}
+		m_data = reinterpret_cast<const uchar*>(m_buffer.constData());
+	}
+
+	const quint32 magic = qFromLittleEndian<quint32>(m_data);
+	const quint32 version = qFromLittleEndian<quint32>(m_data + 4);
+	const quint64 count = qFromLittleEndian<quint64>(m_data + 8);
+	const quint32 gameCount = qFromLittleEndian<quint32>(m_data + 16);
+	const quint32 maxPlies = qFromLittleEndian<quint32>(m_data + 20);
+
+	if (magic != s_magic
+	||  version != s_version
+	||  count > quint64(size - s_headerSize) / 12
+	||  quint64(size) != s_headerSize + count * 12
+	||  gameCount > quint32(INT_MAX)
+	||  maxPlies > quint32(INT_MAX))
+	{
+		qWarning("Invalid position index file: %s",
+			 qUtf8Printable(fileName));
+		close();
+		return false;
+	}
+
+	m_count = qint64(count);
+	m_gameCount = int(gameCount);
+	m_maxPlies = int(maxPlies);
+	return true;
+}
+
+void PgnPositionIndex::close()
+{
+	if (m_file != nullptr)
+	{
+		if (m_buffer.isEmpty() && m_data != nullptr)
+			m_file->unmap(const_cast<uchar*>(m_data));
+		delete m_file;
+		m_file = nullptr;
+	}
+
+	m_buffer.clear();
+	m_data = nullptr;
+	m_count = 0;
+	m_gameCount = 0;
+	m_maxPlies = 0;
+}
+
+bool PgnPositionIndex::isOpen() const
+{
+	return m_data != nullptr;
+}
+
+QString PgnPositionIndex::fileName() const
+{
+	return m_file != nullptr ? m_file->fileName() : QString();
+}
+
+int PgnPositionIndex::gameCount() const
+{
+	return m_gameCount;
+}
+
+int PgnPositionIndex::maxPlies() const
+{
+	return m_maxPlies;
+}
+
+quint64 PgnPositionIndex::keyAt(qint64 i) const
+{
+	return qFromLittleEndian<quint64>(m_data + s_headerSize + i * 8);
+}
+
+quint32 PgnPositionIndex::gameAt(qint64 i) const
+{
+	return qFromLittleEndian<quint32>(m_data + s_headerSize
+					  + m_count * 8 + i * 4);
+}
+
+QVector<int> PgnPositionIndex::find(quint64 key) const
+{
+	QVector<int> games;
+	if (m_data == nullptr)
+		return games;
+
+	// Find the first position with a matching key
+	qint64 first = 0;
+	qint64 count = m_count;
+	while (count > 0)
+	{
+		const qint64 step = count / 2;
+		if (keyAt(first + step) < key)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+
+	// The game indexes of each key are sorted and unique
+	for (qint64 i = first; i < m_count && keyAt(i) == key; i++)
+		games.append(int(gameAt(i)));
+
+	return games;
+}
+
+PgnPositionIndex::Writer::Writer(const QString& fileName)
+	: m_fileName(fileName),
+	  m_tempDir(nullptr),
+	  m_bufferSize(0),
+	  m_runCount(0),
+	  m_ok(true)
+{
+	setMemoryLimit(s_defaultMemoryLimit);
+}
+
+PgnPositionIndex::Writer::~Writer()
+{
+	delete m_tempDir;
+}
+
+void PgnPositionIndex::Writer::setMemoryLimit(qint64 bytes)
+{
+	m_bufferSize = int(qBound(qint64(1),
+				  bytes / qint64(sizeof(Position)),
+				  qint64(INT_MAX / sizeof(Position))));
+}
+
+void PgnPositionIndex::Writer::addPosition(quint64 key, quint32 game)
+{
+	if (!m_ok)
+		return;
+
+	m_buffer.append({ key, game });
+	if (m_buffer.size() >= m_bufferSize)
+		m_ok = writeRun();
+}
+
+QString PgnPositionIndex::Writer::newRunName()
+{
+	return m_tempDir->filePath(QString("run%1.bin").arg(m_runCount++));
+}
+
+bool PgnPositionIndex::Writer::writeRun()
+{
+	if (m_buffer.isEmpty())
+		return true;
+
+	if (m_tempDir == nullptr)
+		m_tempDir = new QTemporaryDir;
+	if (!m_tempDir->isValid())
+		return false;
+
+	std::sort(m_buffer.begin(), m_buffer.end(), lessThan);
+	auto end = std::unique(m_buffer.begin(), m_buffer.end(), isEqual);
+	const qint64 bytes = qint64(end - m_buffer.begin()) * sizeof(Position);
+
+	const QString fileName(newRunName());
+	m_runs.append(fileName);
+
+	QFile file(fileName);
+	const bool ok = file.open(QIODevice::WriteOnly)
+		&& file.write(reinterpret_cast<const char*>(m_buffer.constData()),
+			      bytes) == bytes;
+
+	// Keep the capacity for the next run
+	m_buffer.resize(0);
+	return ok;
+}
+
+bool PgnPositionIndex::Writer::mergePass()
+{
+	// Merge at most s_mergeFanIn runs at a time, so that a huge
+	// collection doesn't run out of file descriptors
+	QStringList runs;
+	for (int i = 0; i < m_runs.size(); i += s_mergeFanIn)
+	{
+		const QStringList inputs(m_runs.mid(i, s_mergeFanIn));
+		if (inputs.size() == 1)
+		{
+			runs.append(inputs.first());
+			continue;
+		}
+
+		QFile file(newRunName());
+		if (!file.open(QIODevice::WriteOnly))
+			return false;
+
+		QVector<Position> block;
+		auto flush = [&]()
+		{
+			const qint64 bytes = qint64(block.size()) * sizeof(Position);
+			const bool ok = file.write(
+				reinterpret_cast<const char*>(block.constData()),
+				bytes) == bytes;
+			block.resize(0);
+			return ok;
+		};
+		auto write = [&](const Position& pos)
+		{
+			block.append(pos);
+			return block.size() < s_blockSize || flush();
+		};
+		if (!mergeRuns(inputs, write) || !flush())
+			return false;
+
+		runs.append(file.fileName());
+		for (const QString& input : inputs)
+			QFile::remove(input);
+	}
+
+	m_runs = runs;
+	return true;
+}
+
+bool PgnPositionIndex::Writer::finish(int gameCount, int maxPlies)
+{
+	if (!m_ok || !writeRun())
+		return false;
+	while (m_runs.size() > s_mergeFanIn)
+	{
+		if (!mergePass())
+			return false;
+	}
+
+	// The keys are written to the index file and the game indexes
+	// to a temporary file that is appended to the index at the end
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	QFile gameFile;
+	if (m_tempDir != nullptr)
+	{
+		gameFile.setFileName(newRunName());
+		if (!gameFile.open(QIODevice::ReadWrite | QIODevice::Truncate))
+		{
+			file.remove();
+			return false;
+		}
+	}
+
+	uchar header[s_headerSize] = {};
+	bool ok = file.write(reinterpret_cast<const char*>(header),
+			     s_headerSize) == s_headerSize;
+
+	quint64 count = 0;
+	int n = 0;
+	QByteArray keys(s_blockSize * 8, 0);
+	QByteArray games(s_blockSize * 4, 0);
+	auto flush = [&]()
+	{
+		ok = ok
+		  && file.write(keys.constData(), n * 8) == n * 8
+		  && gameFile.write(games.constData(), n * 4) == n * 4;
+		n = 0;
+		return ok;
+	};
+	auto write = [&](const Position& pos)
+	{
+		qToLittleEndian<quint64>(pos.key,
+			reinterpret_cast<uchar*>(keys.data()) + n * 8);
+		qToLittleEndian<quint32>(pos.game,
+			reinterpret_cast<uchar*>(games.data()) + n * 4);
+		count++;
+		return ++n < s_blockSize || flush();
+	};
+	ok = ok && mergeRuns(m_runs, write) && (n == 0 || flush());
+
+	// Append the game indexes
+	if (ok && count > 0)
+	{
+		ok = gameFile.seek(0);
+		while (ok)
+		{
+			const QByteArray block = gameFile.read(1024 * 1024);
+			if (block.isEmpty())
+				break;
+			ok = file.write(block) == block.size();
+		}
+	}
+
+	qToLittleEndian<quint32>(s_magic, header);
+	qToLittleEndian<quint32>(s_version, header + 4);
+	qToLittleEndian<quint64>(count, header + 8);
+	qToLittleEndian<quint32>(quint32(gameCount), header + 16);
+	qToLittleEndian<quint32>(quint32(qMax(maxPlies, 0)), header + 20);
+	ok = ok
+	  && file.seek(0)
+	  && file.write(reinterpret_cast<const char*>(header),
+			s_headerSize) == s_headerSize;
+	ok = ok && file.size() == s_headerSize + qint64(count) * 12;
+
+	if (!ok)
+		file.remove();
+	m_runs.clear();
+	return ok;
+}
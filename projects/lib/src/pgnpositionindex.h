@@ -0,0 +1,152 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PGNPOSITIONINDEX_H
+#define PGNPOSITIONINDEX_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+class QFile;
+class QTemporaryDir;
+
+/*!
+ * \brief A disk-backed index of the positions in a PGN collection.
+ *
+ * PgnPositionIndex maps the Zobrist keys of the positions reached
+ * in the games of a collection to the indexes of the games. The
+ * index is a file with a table of keys and game indexes sorted by
+ * the key, so that the games that reach a position are found with
+ * a binary search. The file is memory-mapped when possible.
+ *
+ * \sa PgnGameEntry, Chess::Board::key()
+ */
+class LIB_EXPORT PgnPositionIndex
+{
+	public:
+		/*! A position in a game. */
+		struct Position
+		{
+			/*! The Zobrist key of the position. */
+			quint64 key;
+			/*! The index of the game in the collection. */
+			quint32 game;
+		};
+
+		/*! Creates a new index that isn't associated with a file. */
+		PgnPositionIndex();
+		/*! Destroys the index. */
+		~PgnPositionIndex();
+
+		/*!
+		 * Opens the index file \a fileName.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool open(const QString& fileName);
+		/*! Closes the index file. */
+		void close();
+		/*! Returns true if an index file is open. */
+		bool isOpen() const;
+		/*! Returns the name of the index file. */
+		QString fileName() const;
+		/*! Returns the number of games in the indexed collection. */
+		int gameCount() const;
+		/*!
+		 * Returns the number of plies indexed from the start of
+		 * each game.
+		 *
+		 * Positions reached after more plies than this aren't in
+		 * the index.
+		 */
+		int maxPlies() const;
+
+		/*!
+		 * Returns the indexes of the games that reach the position
+		 * with Zobrist key \a key, in ascending order.
+		 */
+		QVector<int> find(quint64 key) const;
+
+		/*!
+		 * \brief Writes a position index file.
+		 *
+		 * Writer collects the positions in a buffer of bounded size.
+		 * When the buffer is full it is sorted and written to a
+		 * temporary run file, and finish() merges the runs into the
+		 * index file. This way the index of a collection much larger
+		 * than the available memory can be written.
+		 */
+		class LIB_EXPORT Writer
+		{
+			public:
+				/*! Creates a writer for index file \a fileName. */
+				explicit Writer(const QString& fileName);
+				/*! Destroys the writer and its temporary files. */
+				~Writer();
+
+				/*!
+				 * Sets the approximate amount of memory used for
+				 * buffering positions to \a bytes.
+				 *
+				 * The default is 64 MB.
+				 */
+				void setMemoryLimit(qint64 bytes);
+				/*!
+				 * Adds the position with Zobrist key \a key in
+				 * game \a game to the index.
+				 */
+				void addPosition(quint64 key, quint32 game);
+				/*!
+				 * Writes the index of a collection of \a gameCount
+				 * games to the index file. The positions of each game
+				 * were added up to ply \a maxPlies.
+				 *
+				 * Returns true if successful; otherwise returns false.
+				 */
+				bool finish(int gameCount, int maxPlies);
+
+			private:
+				Q_DISABLE_COPY(Writer)
+
+				QString newRunName();
+				bool writeRun();
+				bool mergePass();
+
+				QString m_fileName;
+				QTemporaryDir* m_tempDir;
+				QVector<Position> m_buffer;
+				int m_bufferSize;
+				QStringList m_runs;
+				int m_runCount;
+				bool m_ok;
+		};
+
+	private:
+		Q_DISABLE_COPY(PgnPositionIndex)
+
+		quint64 keyAt(qint64 i) const;
+		quint32 gameAt(qint64 i) const;
+
+		QFile* m_file;
+		QByteArray m_buffer;
+		const uchar* m_data;
+		qint64 m_count;
+		int m_gameCount;
+		int m_maxPlies;
+};
+
+#endif // PGNPOSITIONINDEX_H
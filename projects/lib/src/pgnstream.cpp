@@ -24,6 +24,8 @@
 
 namespace {
 
+const int s_bufferSize = 64 * 1024;
+
 void skipSection(PgnStream* in, char start)
 {
 	char end;
@@ -61,7 +63,9 @@ PgnStream::PgnStream(const QString& variant)
 	: m_board(nullptr),
 	  m_pos(0),
 	  m_lineNumber(1),
-	  m_lastChar(0),
+	  m_bufferPos(0),
+	  m_bufferStart(0),
+	  m_skipCarriageReturns(false),
 	  m_tokenType(NoToken),
 	  m_device(nullptr),
 	  m_string(nullptr),
@@ -72,14 +76,18 @@ PgnStream::PgnStream(const QString& variant)
 }
 
 PgnStream::PgnStream(QIODevice* device, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_skipCarriageReturns(false),
+	  m_device(nullptr)
 {
 	setVariant(variant);
 	setDevice(device);
 }
 
 PgnStream::PgnStream(const QByteArray* string, const QString& variant)
-	: m_board(nullptr)
+	: m_board(nullptr),
+	  m_skipCarriageReturns(false),
+	  m_device(nullptr)
 {
 	setVariant(variant);
 	setString(string);
@@ -87,14 +95,22 @@ PgnStream::PgnStream(const QByteArray* string, const QString& variant)
 
 PgnStream::~PgnStream()
 {
+	reset();
 	delete m_board;
 }
 
 void PgnStream::reset()
 {
+	// Give the device back in the mode it was in
+	if (m_device != nullptr && m_skipCarriageReturns && m_device->isOpen())
+		m_device->setTextModeEnabled(true);
+
 	m_pos = 0;
 	m_lineNumber = 1;
-	m_lastChar = 0;
+	m_buffer.clear();
+	m_bufferPos = 0;
+	m_bufferStart = 0;
+	m_skipCarriageReturns = false;
 	m_tokenString.clear();
 	m_tagName.clear();
 	m_tagValue.clear();
@@ -117,10 +133,21 @@ QIODevice* PgnStream::device() const
 
 void PgnStream::setDevice(QIODevice* device)
 {
-	Q_ASSERT(device != nullptr);
-
 	reset();
+	if (device == nullptr)
+		return;
+
 	m_device = device;
+	m_bufferStart = device->pos();
+
+	// Text mode would make the buffered data shorter than the
+	// data in the device, so the carriage returns are skipped
+	// in readChar() instead.
+	if (device->isOpen() && device->isTextModeEnabled())
+	{
+		device->setTextModeEnabled(false);
+		m_skipCarriageReturns = true;
+	}
 }
 
 const QByteArray* PgnStream::string() const
@@ -163,7 +190,7 @@ bool PgnStream::isOpen() const
 qint64 PgnStream::pos() const
 {
 	if (m_device)
-		return m_device->pos();
+		return m_bufferStart + m_bufferPos;
 	return m_pos;
 }
 
@@ -172,17 +199,38 @@ qint64 PgnStream::lineNumber() const
 	return m_lineNumber;
 }
 
+bool PgnStream::fillBuffer()
+{
+	m_bufferStart += m_buffer.size();
+	m_bufferPos = 0;
+
+	m_buffer.resize(s_bufferSize);
+	qint64 n = m_device->read(m_buffer.data(), s_bufferSize);
+	if (n <= 0)
+	{
+		m_buffer.clear();
+		return false;
+	}
+	m_buffer.resize(int(n));
+
+	return true;
+}
+
 char PgnStream::readChar()
 {
 	char c;
 	if (m_device)
 	{
-		if (!m_device->getChar(&m_lastChar))
+		do
 		{
-			m_status = ReadPastEnd;
-			return 0;
+			if (m_bufferPos >= m_buffer.size() && !fillBuffer())
+			{
+				m_status = ReadPastEnd;
+				return 0;
+			}
+			c = m_buffer.constData()[m_bufferPos++];
 		}
-		c = m_lastChar;
+		while (c == '\r' && m_skipCarriageReturns);
 	}
 	else if (m_string && m_pos < m_string->size())
 	{
@@ -210,14 +258,10 @@ void PgnStream::rewindChar()
 	Q_ASSERT(pos() > 0);
 
 	char c;
-	if (m_device)
-	{
-		c = m_lastChar;
-		m_device->ungetChar(m_lastChar);
-		m_lastChar = 0;
-	}
-	else if (m_string)
-		c = m_string->at(m_pos--);
+	if (m_device && m_bufferPos > 0)
+		c = m_buffer.at(--m_bufferPos);
+	else if (m_string && m_pos > 0)
+		c = m_string->at(--m_pos);
 	else
 		return;
 
@@ -233,7 +277,19 @@ bool PgnStream::seek(qint64 pos, qint64 lineNumber)
 	bool ok = false;
 	if (m_device)
 	{
-		ok = m_device->seek(pos);
+		// Positions inside the buffer don't need a device seek
+		if (pos >= m_bufferStart && pos <= m_bufferStart + m_buffer.size())
+		{
+			m_bufferPos = int(pos - m_bufferStart);
+			ok = true;
+		}
+		else if (m_device->seek(pos))
+		{
+			m_buffer.clear();
+			m_bufferPos = 0;
+			m_bufferStart = pos;
+			ok = true;
+		}
 		m_pos = 0;
 	}
 	else if (m_string)
@@ -246,7 +302,6 @@ bool PgnStream::seek(qint64 pos, qint64 lineNumber)
 
 	m_status = Ok;
 	m_lineNumber = lineNumber;
-	m_lastChar = 0;
 	m_phase = OutOfGame;
 
 	return true;
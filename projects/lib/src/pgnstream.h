@@ -21,6 +21,7 @@
 
 #include <QtGlobal>
 #include <QString>
+#include <QByteArray>
 class QIODevice;
 namespace Chess { class Board; }
 
@@ -36,6 +37,10 @@ namespace Chess { class Board; }
  * be changed at any time, so it's possible to read PGN streams that
  * contain games of multiple variants.
  *
+ * Input from a device is read in large blocks into an internal buffer,
+ * so the device shouldn't be read or repositioned by anyone else while
+ * the stream is using it.
+ *
  * \sa PgnGame
  * \sa OpeningBook
  */
@@ -104,7 +109,19 @@ class LIB_EXPORT PgnStream
 
 		/*! Returns the assigned device, or 0 if no device is in use. */
 		QIODevice* device() const;
-		/*! Sets the current device to \a device. */
+		/*!
+		 * Sets the current device to \a device.
+		 *
+		 * If \a device is open in text mode, the text mode is turned
+		 * off and the stream skips the carriage returns itself. That
+		 * way pos() always returns the exact position in the device.
+		 * The text mode is turned back on when the device is replaced,
+		 * the stream is reset or destroyed, or \a device is 0, which
+		 * detaches the stream from its device.
+		 *
+		 * \note The device must outlive the stream or be detached
+		 * from it first.
+		 */
 		void setDevice(QIODevice* device);
 
 		/*! Returns the assigned string, or 0 if no string is in use. */
@@ -129,7 +146,11 @@ class LIB_EXPORT PgnStream
 		/*! Returns the current line number. */
 		qint64 lineNumber() const;
 
-		/*! Resets the stream to its default state. */
+		/*!
+		 * Resets the stream to its default state.
+		 *
+		 * The stream is detached from its device or string.
+		 */
 		void reset();
 
 		/*! Reads one character and returns it. */
@@ -139,9 +160,8 @@ class LIB_EXPORT PgnStream
 		 * the next time readChar() is called, nothing is read and the
 		 * buffer character is returned.
 		 *
-		 * \note Only one character is kept in the buffer, so calling
-		 * this method multiple times in a row has the same effect as
-		 * calling it just once.
+		 * \note Only one character is guaranteed to be rewindable, so
+		 * this method shouldn't be called multiple times in a row.
 		 */
 		void rewindChar();
 		/*!
@@ -200,6 +220,7 @@ class LIB_EXPORT PgnStream
 			InGame
 		};
 
+		bool fillBuffer();
 		void parseUntil(const char* chars);
 		void parseTag();
 		void parseComment(char opBracket);
@@ -207,7 +228,10 @@ class LIB_EXPORT PgnStream
 		Chess::Board* m_board;
 		qint64 m_pos;
 		qint64 m_lineNumber;
-		char m_lastChar;
+		QByteArray m_buffer;
+		int m_bufferPos;
+		qint64 m_bufferStart;
+		bool m_skipCarriageReturns;
 		QByteArray m_tokenString;
 		QByteArray m_tagName;
 		QByteArray m_tagValue;
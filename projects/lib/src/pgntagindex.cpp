@@ -0,0 +1,432 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pgntagindex.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <QDataStream>
+#include <QDate>
+#include <QPair>
+#include "pgngamefilter.h"
+#include "pgntagpool.h"
+
+namespace {
+
+typedef QVector<int> PostingList;
+
+quint32 s_trigram(const char* s)
+{
+	const uchar* p = reinterpret_cast<const uchar*>(s);
+	return (quint32(quint8(tolower(p[0]))) << 16)
+	     | (quint32(quint8(tolower(p[1]))) << 8)
+	     |  quint32(quint8(tolower(p[2])));
+}
+
+bool s_containsIgnoreCase(const char* str, int size,
+			  const char* pattern, int length)
+{
+	for (int i = 0; i + length <= size; i++)
+	{
+		int j = 0;
+		while (j < length
+		&&     toupper(static_cast<unsigned char>(str[i + j]))
+		    == toupper(static_cast<unsigned char>(pattern[j])))
+			j++;
+		if (j == length)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Returns the date of a Date tag as a Julian day, or INT_MIN if the
+ * tag can't match any date range, or INT_MAX if it isn't a valid
+ * date.
+ */
+int s_dateKey(const char* str, int size)
+{
+	QDate date;
+	if (!PgnGameEntry::parseDate(str, size, &date))
+		return INT_MIN;
+	if (!date.isValid())
+		return INT_MAX;
+	return int(date.toJulianDay());
+}
+
+template <typename T>
+QVector<T> s_intersect(const QVector<T>& a, const QVector<T>& b)
+{
+	QVector<T> result;
+	std::set_intersection(a.constBegin(), a.constEnd(),
+			      b.constBegin(), b.constEnd(),
+			      std::back_inserter(result));
+	return result;
+}
+
+void s_unite(PostingList& list)
+{
+	std::sort(list.begin(), list.end());
+	list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+void s_buildSortedColumn(QVector< QPair<int, int> >& pairs,
+			 QVector<int>& keys,
+			 QVector<int>& entries)
+{
+	std::sort(pairs.begin(), pairs.end());
+	keys.resize(pairs.size());
+	entries.resize(pairs.size());
+	for (int i = 0; i < pairs.size(); i++)
+	{
+		keys[i] = pairs.at(i).first;
+		entries[i] = pairs.at(i).second;
+	}
+}
+
+} // anonymous namespace
+
+PgnTagIndex::PgnTagIndex()
+	: m_entryCount(0)
+{
+}
+
+void PgnTagIndex::clear()
+{
+	m_entryCount = 0;
+	m_trigrams.clear();
+	for (TagColumn& column : m_tags)
+	{
+		column.offsets.clear();
+		column.entries.clear();
+	}
+	m_dates.keys.clear();
+	m_dates.entries.clear();
+	m_rounds.keys.clear();
+	m_rounds.entries.clear();
+	m_otherDates.clear();
+}
+
+int PgnTagIndex::entryCount() const
+{
+	return m_entryCount;
+}
+
+void PgnTagIndex::build(const PgnTagPool& pool,
+			const QVector<PgnGameEntry>& entries)
+{
+	clear();
+	m_entryCount = entries.size();
+	const int tagCount = pool.count();
+
+	// Trigrams of the distinct tag values. The IDs are added in
+	// ascending order, so the posting lists are sorted.
+	for (int id = 1; id < tagCount; id++)
+	{
+		const char* str = pool.data(id);
+		const int size = pool.size(id);
+		for (int i = 0; i + 3 <= size; i++)
+		{
+			QVector<quint32>& list = m_trigrams[s_trigram(str + i)];
+			if (list.isEmpty() || list.last() != quint32(id))
+				list.append(id);
+		}
+	}
+
+	// Posting lists of every tag type, stored contiguously and
+	// indexed by tag ID
+	for (int type = 0; type <= PgnGameEntry::VariantTag; type++)
+	{
+		TagColumn& column = m_tags[type];
+		column.offsets.fill(0, tagCount + 1);
+		for (const PgnGameEntry& entry : entries)
+			column.offsets[entry.tagId(PgnGameEntry::TagType(type)) + 1]++;
+		for (int id = 0; id < tagCount; id++)
+			column.offsets[id + 1] += column.offsets.at(id);
+
+		QVector<int> pos(column.offsets);
+		column.entries.resize(entries.size());
+		for (int i = 0; i < entries.size(); i++)
+		{
+			const quint32 id = entries.at(i).tagId(PgnGameEntry::TagType(type));
+			column.entries[pos[id]++] = i;
+		}
+	}
+
+	// Date and round columns. The keys are computed once per
+	// distinct tag value.
+	QVector<int> dateKeys(tagCount);
+	QVector<int> roundKeys(tagCount);
+	for (int id = 0; id < tagCount; id++)
+	{
+		dateKeys[id] = s_dateKey(pool.data(id), pool.size(id));
+		roundKeys[id] = PgnGameEntry::parseRound(pool.data(id), pool.size(id));
+	}
+
+	QVector< QPair<int, int> > dates;
+	QVector< QPair<int, int> > rounds;
+	for (int i = 0; i < entries.size(); i++)
+	{
+		const PgnGameEntry& entry = entries.at(i);
+		const int date = dateKeys.at(entry.tagId(PgnGameEntry::DateTag));
+		if (date == INT_MAX)
+			m_otherDates.append(i);
+		else if (date != INT_MIN)
+			dates.append(qMakePair(date, i));
+
+		const int round = roundKeys.at(entry.tagId(PgnGameEntry::RoundTag));
+		if (round != 0)
+			rounds.append(qMakePair(round, i));
+	}
+	s_buildSortedColumn(dates, m_dates.keys, m_dates.entries);
+	s_buildSortedColumn(rounds, m_rounds.keys, m_rounds.entries);
+}
+
+QVector<quint32> PgnTagIndex::matchingTags(const char* pattern,
+					   const PgnTagPool& pool) const
+{
+	const int length = int(strlen(pattern));
+	QVector<quint32> candidates;
+
+	if (length >= 3)
+	{
+		// Intersect the posting lists of the pattern's trigrams,
+		// starting from the shortest one
+		QVector< const QVector<quint32>* > lists;
+		for (int i = 0; i + 3 <= length; i++)
+		{
+			auto it = m_trigrams.constFind(s_trigram(pattern + i));
+			if (it == m_trigrams.constEnd())
+				return QVector<quint32>();
+			lists.append(&it.value());
+		}
+		std::sort(lists.begin(), lists.end(),
+			  [](const QVector<quint32>* a, const QVector<quint32>* b)
+		{
+			return a->size() < b->size();
+		});
+
+		candidates = *lists.first();
+		for (int i = 1; i < lists.size() && !candidates.isEmpty(); i++)
+			candidates = s_intersect(candidates, *lists.at(i));
+	}
+	else
+	{
+		candidates.resize(pool.count() - 1);
+		for (int i = 0; i < candidates.size(); i++)
+			candidates[i] = i + 1;
+	}
+
+	// The trigrams don't guarantee a match, so check the values
+	QVector<quint32> tags;
+	for (quint32 id : qAsConst(candidates))
+	{
+		if (s_containsIgnoreCase(pool.data(id), pool.size(id),
+					 pattern, length))
+			tags.append(id);
+	}
+
+	return tags;
+}
+
+void PgnTagIndex::addPostings(PgnGameEntry::TagType type,
+			      const QVector<quint32>& tags,
+			      QVector<int>& list) const
+{
+	const TagColumn& column = m_tags[type];
+	for (quint32 id : tags)
+	{
+		if (int(id) + 1 >= column.offsets.size())
+			continue;
+
+		auto begin = column.entries.constBegin() + column.offsets.at(id);
+		auto end = column.entries.constBegin() + column.offsets.at(id + 1);
+		std::copy(begin, end, std::back_inserter(list));
+	}
+}
+
+void PgnTagIndex::addRange(const SortedColumn& column,
+			   int minKey,
+			   int maxKey,
+			   QVector<int>& list)
+{
+	auto first = std::lower_bound(column.keys.constBegin(),
+				      column.keys.constEnd(), minKey);
+	auto last = std::upper_bound(first, column.keys.constEnd(), maxKey);
+
+	auto begin = column.entries.constBegin() + (first - column.keys.constBegin());
+	auto end = column.entries.constBegin() + (last - column.keys.constBegin());
+	std::copy(begin, end, std::back_inserter(list));
+}
+
+QVector<int> PgnTagIndex::find(const PgnGameFilter& filter,
+			       const PgnTagPool& pool) const
+{
+	QVector<PostingList> lists;
+
+	if (filter.type() == PgnGameFilter::FixedString)
+	{
+		if (*filter.pattern())
+		{
+			const auto tags = matchingTags(filter.pattern(), pool);
+			PostingList list;
+			for (int type = 0; type <= PgnGameEntry::VariantTag; type++)
+				addPostings(PgnGameEntry::TagType(type), tags, list);
+			lists.append(list);
+		}
+	}
+	else
+	{
+		if (*filter.event())
+		{
+			PostingList list;
+			addPostings(PgnGameEntry::EventTag,
+				    matchingTags(filter.event(), pool), list);
+			lists.append(list);
+		}
+		if (*filter.site())
+		{
+			PostingList list;
+			addPostings(PgnGameEntry::SiteTag,
+				    matchingTags(filter.site(), pool), list);
+			lists.append(list);
+		}
+
+		// The player and the opponent must both be found on a
+		// side allowed by the filter
+		const Chess::Side side = filter.playerSide();
+		if (*filter.player())
+		{
+			const auto tags = matchingTags(filter.player(), pool);
+			PostingList list;
+			if (side != Chess::Side::Black)
+				addPostings(PgnGameEntry::WhiteTag, tags, list);
+			if (side != Chess::Side::White)
+				addPostings(PgnGameEntry::BlackTag, tags, list);
+			lists.append(list);
+		}
+		if (*filter.opponent())
+		{
+			const auto tags = matchingTags(filter.opponent(), pool);
+			PostingList list;
+			if (side != Chess::Side::White)
+				addPostings(PgnGameEntry::WhiteTag, tags, list);
+			if (side != Chess::Side::Black)
+				addPostings(PgnGameEntry::BlackTag, tags, list);
+			lists.append(list);
+		}
+
+		if (!filter.minDate().isNull() || !filter.maxDate().isNull())
+		{
+			const int minKey = filter.minDate().isNull()
+				? INT_MIN + 1 : int(filter.minDate().toJulianDay());
+			const int maxKey = filter.maxDate().isNull()
+				? INT_MAX - 1 : int(filter.maxDate().toJulianDay());
+
+			PostingList list(m_otherDates);
+			addRange(m_dates, minKey, maxKey, list);
+			lists.append(list);
+		}
+		if (filter.minRound() != 0 || filter.maxRound() != 0)
+		{
+			const int minKey = filter.minRound() != 0
+				? filter.minRound() : INT_MIN;
+			const int maxKey = filter.maxRound() != 0
+				? filter.maxRound() : INT_MAX;
+
+			PostingList list;
+			addRange(m_rounds, minKey, maxKey, list);
+			lists.append(list);
+		}
+	}
+
+	if (lists.isEmpty())
+	{
+		PostingList all(m_entryCount);
+		for (int i = 0; i < m_entryCount; i++)
+			all[i] = i;
+		return all;
+	}
+
+	for (PostingList& list : lists)
+		s_unite(list);
+	std::sort(lists.begin(), lists.end(),
+		  [](const PostingList& a, const PostingList& b)
+	{
+		return a.size() < b.size();
+	});
+
+	PostingList result = lists.first();
+	for (int i = 1; i < lists.size() && !result.isEmpty(); i++)
+		result = s_intersect(result, lists.at(i));
+
+	return result;
+}
+
+bool PgnTagIndex::read(QDataStream& in)
+{
+	clear();
+
+	qint32 entryCount;
+	in >> entryCount;
+	in >> m_trigrams;
+	for (TagColumn& column : m_tags)
+	{
+		in >> column.offsets;
+		in >> column.entries;
+	}
+	in >> m_dates.keys >> m_dates.entries;
+	in >> m_rounds.keys >> m_rounds.entries;
+	in >> m_otherDates;
+
+	bool ok = in.status() == QDataStream::Ok && entryCount >= 0;
+	for (const TagColumn& column : m_tags)
+	{
+		ok = ok && !column.offsets.isEmpty()
+			&& column.offsets.first() == 0
+			&& column.offsets.last() == column.entries.size()
+			&& column.entries.size() == entryCount;
+	}
+	ok = ok && m_dates.keys.size() == m_dates.entries.size()
+		&& m_rounds.keys.size() == m_rounds.entries.size();
+
+	if (!ok)
+	{
+		clear();
+		return false;
+	}
+
+	m_entryCount = entryCount;
+	return true;
+}
+
+void PgnTagIndex::write(QDataStream& out) const
+{
+	out << qint32(m_entryCount);
+	out << m_trigrams;
+	for (const TagColumn& column : m_tags)
+	{
+		out << column.offsets;
+		out << column.entries;
+	}
+	out << m_dates.keys << m_dates.entries;
+	out << m_rounds.keys << m_rounds.entries;
+	out << m_otherDates;
+}
@@ -0,0 +1,113 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PGNTAGINDEX_H
+#define PGNTAGINDEX_H
+
+#include <QHash>
+#include <QVector>
+#include "pgngameentry.h"
+class PgnGameFilter;
+class PgnTagPool;
+class QDataStream;
+
+/*!
+ * \brief An inverted index of the tags of a PGN collection.
+ *
+ * PgnTagIndex maps the tag values of a collection of PgnGameEntry
+ * objects back to the entries, so that a PgnGameFilter can be
+ * resolved by intersecting posting lists instead of matching every
+ * entry against the filter.
+ *
+ * Substring queries are answered with a trigram index over the
+ * distinct values in the collection's PgnTagPool. Date and round
+ * ranges are answered with columns that are sorted by the date and
+ * the round number.
+ *
+ * \sa PgnGameEntry, PgnTagPool
+ */
+class LIB_EXPORT PgnTagIndex
+{
+	public:
+		/*! Creates a new empty index. */
+		PgnTagIndex();
+
+		/*! Removes all data from the index. */
+		void clear();
+		/*! Returns the number of entries in the indexed collection. */
+		int entryCount() const;
+
+		/*!
+		 * Builds the index for \a entries whose tag values are
+		 * stored in \a pool.
+		 */
+		void build(const PgnTagPool& pool,
+			   const QVector<PgnGameEntry>& entries);
+
+		/*!
+		 * Returns the indexes of the entries that may match
+		 * \a filter, in ascending order.
+		 *
+		 * The result is a superset of the matching entries: the
+		 * caller must still verify the candidates with
+		 * PgnGameEntry::match(). \a pool must be the pool that
+		 * was used to build the index.
+		 */
+		QVector<int> find(const PgnGameFilter& filter,
+				  const PgnTagPool& pool) const;
+
+		/*!
+		 * Reads the index from a data stream.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool read(QDataStream& in);
+		/*! Writes the index to a data stream. */
+		void write(QDataStream& out) const;
+
+	private:
+		/*! Posting lists of a tag type, indexed by tag ID. */
+		struct TagColumn
+		{
+			QVector<int> offsets;
+			QVector<int> entries;
+		};
+		/*! Entries sorted by a numeric key. */
+		struct SortedColumn
+		{
+			QVector<int> keys;
+			QVector<int> entries;
+		};
+
+		QVector<quint32> matchingTags(const char* pattern,
+					      const PgnTagPool& pool) const;
+		void addPostings(PgnGameEntry::TagType type,
+				 const QVector<quint32>& tags,
+				 QVector<int>& list) const;
+		static void addRange(const SortedColumn& column,
+				     int minKey,
+				     int maxKey,
+				     QVector<int>& list);
+
+		int m_entryCount;
+		QHash< quint32, QVector<quint32> > m_trigrams;
+		TagColumn m_tags[PgnGameEntry::VariantTag + 1];
+		SortedColumn m_dates;
+		SortedColumn m_rounds;
+		QVector<int> m_otherDates;
+};
+
+#endif // PGNTAGINDEX_H
@@ -0,0 +1,176 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "pgntagpool.h"
+#include <cstring>
+#include <QDataStream>
+
+namespace {
+
+const int s_minTableSize = 64;
+
+quint32 s_hash(const char* data, int size)
+{
+	// 32-bit FNV-1a
+	quint32 hash = 2166136261u;
+	for (int i = 0; i < size; i++)
+	{
+		hash ^= quint8(data[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+} // anonymous namespace
+
+PgnTagPool::PgnTagPool()
+{
+	clear();
+}
+
+void PgnTagPool::clear()
+{
+	m_data.clear();
+	m_offsets.clear();
+	m_offsets << 0 << 0;
+	m_table.fill(0, s_minTableSize);
+}
+
+int PgnTagPool::count() const
+{
+	return m_offsets.size() - 1;
+}
+
+quint32 PgnTagPool::intern(const char* data, int size)
+{
+	Q_ASSERT(size >= 0);
+	if (size == 0)
+		return 0;
+
+	const quint32 hash = s_hash(data, size);
+	quint32 id = find(data, size, hash);
+	if (id != 0)
+		return id;
+
+	id = quint32(count());
+	m_data.append(data, size);
+	m_offsets.append(quint32(m_data.size()));
+
+	// Keep the load factor of the hash table below 1/2
+	if (count() * 2 > m_table.size())
+		rehash(m_table.size() * 2);
+	else
+		insert(id, hash);
+
+	return id;
+}
+
+quint32 PgnTagPool::intern(const QByteArray& value)
+{
+	return intern(value.constData(), value.size());
+}
+
+const char* PgnTagPool::data(quint32 id) const
+{
+	Q_ASSERT(int(id) < count());
+	return m_data.constData() + m_offsets.at(id);
+}
+
+int PgnTagPool::size(quint32 id) const
+{
+	Q_ASSERT(int(id) < count());
+	return int(m_offsets.at(id + 1) - m_offsets.at(id));
+}
+
+QByteArray PgnTagPool::value(quint32 id) const
+{
+	return QByteArray(data(id), size(id));
+}
+
+QVector<quint32> PgnTagPool::merge(const PgnTagPool& other)
+{
+	QVector<quint32> ids(other.count());
+	for (int i = 0; i < ids.size(); i++)
+		ids[i] = intern(other.data(i), other.size(i));
+
+	return ids;
+}
+
+bool PgnTagPool::read(QDataStream& in)
+{
+	in >> m_data;
+	in >> m_offsets;
+
+	bool ok = in.status() == QDataStream::Ok
+		&& m_offsets.size() >= 2
+		&& m_offsets.at(0) == 0
+		&& m_offsets.at(1) == 0
+		&& m_offsets.last() == quint32(m_data.size());
+	for (int i = 1; ok && i < m_offsets.size(); i++)
+		ok = m_offsets.at(i) >= m_offsets.at(i - 1);
+
+	if (!ok)
+	{
+		clear();
+		return false;
+	}
+
+	int tableSize = s_minTableSize;
+	while (tableSize < count() * 2)
+		tableSize *= 2;
+	rehash(tableSize);
+
+	return true;
+}
+
+void PgnTagPool::write(QDataStream& out) const
+{
+	out << m_data;
+	out << m_offsets;
+}
+
+quint32 PgnTagPool::find(const char* data, int size, quint32 hash) const
+{
+	const int mask = m_table.size() - 1;
+	for (int i = hash & mask; ; i = (i + 1) & mask)
+	{
+		const quint32 id = m_table.at(i);
+		if (id == 0)
+			return 0;
+		if (this->size(id) == size
+		&&  memcmp(this->data(id), data, size) == 0)
+			return id;
+	}
+}
+
+void PgnTagPool::insert(quint32 id, quint32 hash)
+{
+	const int mask = m_table.size() - 1;
+	int i = hash & mask;
+	while (m_table.at(i) != 0)
+		i = (i + 1) & mask;
+
+	m_table[i] = id;
+}
+
+void PgnTagPool::rehash(int tableSize)
+{
+	m_table.fill(0, tableSize);
+	for (int id = 1; id < count(); id++)
+		insert(id, s_hash(data(id), size(id)));
+}
@@ -0,0 +1,99 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PGNTAGPOOL_H
+#define PGNTAGPOOL_H
+
+#include <QByteArray>
+#include <QVector>
+class QDataStream;
+
+/*!
+ * \brief A pool of interned PGN tag values.
+ *
+ * PgnTagPool stores every distinct tag value only once and maps it
+ * to a small integer ID. Game collections repeat the same player
+ * names, events and sites over and over again, so sharing a single
+ * pool between all the PgnGameEntry objects of a database saves a
+ * lot of memory.
+ *
+ * The values are stored back to back in one contiguous buffer. ID 0
+ * is always the empty string.
+ *
+ * \note Looking up values from several threads is safe as long as no
+ * thread adds new values to the pool.
+ *
+ * \sa PgnGameEntry
+ */
+class LIB_EXPORT PgnTagPool
+{
+	public:
+		/*! Creates a new pool that contains only the empty string. */
+		PgnTagPool();
+
+		/*! Removes all values except the empty string. */
+		void clear();
+		/*! Returns the number of distinct values in the pool. */
+		int count() const;
+
+		/*!
+		 * Adds the value of \a size bytes at \a data to the pool
+		 * if it isn't there yet, and returns the value's ID.
+		 */
+		quint32 intern(const char* data, int size);
+		/*! \overload */
+		quint32 intern(const QByteArray& value);
+
+		/*!
+		 * Returns a pointer to the value with ID \a id.
+		 *
+		 * \note The value is not null-terminated; its length is
+		 * given by size().
+		 */
+		const char* data(quint32 id) const;
+		/*! Returns the length of the value with ID \a id in bytes. */
+		int size(quint32 id) const;
+		/*! Returns a copy of the value with ID \a id. */
+		QByteArray value(quint32 id) const;
+
+		/*!
+		 * Adds all the values of \a other to this pool.
+		 *
+		 * Returns a table that maps the IDs of \a other to the
+		 * IDs of this pool.
+		 */
+		QVector<quint32> merge(const PgnTagPool& other);
+
+		/*!
+		 * Reads the pool from a data stream.
+		 * Returns true if successful; otherwise returns false.
+		 */
+		bool read(QDataStream& in);
+		/*! Writes the pool to a data stream. */
+		void write(QDataStream& out) const;
+
+	private:
+		quint32 find(const char* data, int size, quint32 hash) const;
+		void insert(quint32 id, quint32 hash);
+		void rehash(int tableSize);
+
+		QByteArray m_data;
+		QVector<quint32> m_offsets;
+		QVector<quint32> m_table;
+};
+
+#endif // PGNTAGPOOL_H
@@ -61,6 +61,10 @@ class LIB_EXPORT PlayerBuilder
 		 * \param parent The player's parent object.
 		 * \param error If an error occurs and \a error is not 0, the error
 		 *              description is written here.
+		 *
+		 * The function doesn't wait for the player to start. A player
+		 * that fails to start later is disconnected and its
+		 * errorString() describes the failure.
 		 */
 		virtual ChessPlayer* create(QObject* receiver,
 					    const char* method,
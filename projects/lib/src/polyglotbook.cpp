@@ -18,6 +18,7 @@
 
 #include "polyglotbook.h"
 #include <QDataStream>
+#include <QtEndian>
 
 namespace {
 
@@ -59,6 +60,11 @@ PolyglotBook::PolyglotBook(AccessMode mode)
 {
 }
 
+quint16 PolyglotBook::encodeMove(const Chess::GenericMove& move)
+{
+	return moveToBits(move);
+}
+
 int PolyglotBook::entrySize() const
 {
 	return 16;
@@ -77,13 +83,26 @@ OpeningBook::Entry PolyglotBook::readEntry(QDataStream& in, quint64* key) const
 	return { moveFromBits(pgMove), weight };
 }
 
-void PolyglotBook::writeEntry(const Map::const_iterator& it,
+OpeningBook::Entry PolyglotBook::entryFromData(const uchar* data,
+					       quint64* key) const
+{
+	// Polyglot entries are stored in big-endian byte order:
+	// 8 bytes of key, 2 bytes of move, 2 bytes of weight and
+	// 4 bytes of learning data.
+	*key = qFromBigEndian<quint64>(data);
+	quint16 pgMove = qFromBigEndian<quint16>(data + 8);
+	quint16 weight = qFromBigEndian<quint16>(data + 10);
+
+	return { moveFromBits(pgMove), weight };
+}
+
+void PolyglotBook::writeEntry(quint64 key,
+			      const Entry& entry,
 			      QDataStream& out) const
 {
 	quint32 learn = 0;
-	quint64 key = it.key();
-	quint16 pgMove = moveToBits(it.value().move);
-	quint16 weight = it.value().weight;
+	quint16 pgMove = moveToBits(entry.move);
+	quint16 weight = entry.weight;
 	
 	// Store the data. Again, big-endian is used by default.
 	out << key << pgMove << weight << learn;
@@ -36,11 +36,16 @@ class LIB_EXPORT PolyglotBook: public OpeningBook
 		/*! Creates a new PolyglotBook with access mode \a mode. */
 		PolyglotBook(AccessMode mode = Ram);
 
+		/*! Returns \a move encoded in the Polyglot move format. */
+		static quint16 encodeMove(const Chess::GenericMove& move);
+
 	protected:
 		// Inherited from OpeningBook
 		virtual int entrySize() const;
 		virtual Entry readEntry(QDataStream& in, quint64* key) const;
-		virtual void writeEntry(const Map::const_iterator& it,
+		virtual Entry entryFromData(const uchar* data, quint64* key) const;
+		virtual void writeEntry(quint64 key,
+					const Entry& entry,
 					QDataStream& out) const;
 };
 
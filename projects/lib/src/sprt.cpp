@@ -17,6 +17,7 @@
 */
 
 #include "sprt.h"
+#include <algorithm>
 #include <cmath>
 #include <QtGlobal>
 
@@ -135,10 +136,12 @@ Sprt::Sprt()
 	  m_elo1(0),
 	  m_alpha(0),
 	  m_beta(0),
+	  m_model(Trinomial),
 	  m_wins(0),
 	  m_losses(0),
 	  m_draws(0)
 {
+	std::fill(m_gamePairs, m_gamePairs + 5, 0);
 }
 
 bool Sprt::isNull() const
@@ -147,12 +150,19 @@ bool Sprt::isNull() const
 }
 
 void Sprt::initialize(double elo0, double elo1,
-		      double alpha, double beta)
+		      double alpha, double beta,
+		      Model model)
 {
 	m_elo0 = elo0;
 	m_elo1 = elo1;
 	m_alpha = alpha;
 	m_beta = beta;
+	m_model = model;
+}
+
+Sprt::Model Sprt::model() const
+{
+	return m_model;
 }
 
 Sprt::Status Sprt::status() const
@@ -164,23 +174,31 @@ Sprt::Status Sprt::status() const
 		0.0
 	};
 
-	if (m_wins <= 0 || m_losses <= 0 || m_draws <= 0)
-		return status;
-
-	// Estimate draw_elo out of sample
-	const SprtProbability p(m_wins, m_losses, m_draws);
-	const BayesElo b(p);
-
-	// Probability laws under H0 and H1
-	const double s = b.scale();
-	const BayesElo b0(m_elo0 / s, b.drawElo());
-	const BayesElo b1(m_elo1 / s, b.drawElo());
-	const SprtProbability p0(b0), p1(b1);
-
-	// Log-Likelyhood Ratio
-	status.llr = m_wins * std::log(p1.pWin() / p0.pWin()) +
-		     m_losses * std::log(p1.pLoss() / p0.pLoss()) +
-		     m_draws * std::log(p1.pDraw() / p0.pDraw());
+	if (m_model == Pentanomial)
+	{
+		if (!pentanomialLlr(&status.llr))
+			return status;
+	}
+	else
+	{
+		if (m_wins <= 0 || m_losses <= 0 || m_draws <= 0)
+			return status;
+
+		// Estimate draw_elo out of sample
+		const SprtProbability p(m_wins, m_losses, m_draws);
+		const BayesElo b(p);
+
+		// Probability laws under H0 and H1
+		const double s = b.scale();
+		const BayesElo b0(m_elo0 / s, b.drawElo());
+		const BayesElo b1(m_elo1 / s, b.drawElo());
+		const SprtProbability p0(b0), p1(b1);
+
+		// Log-Likelyhood Ratio
+		status.llr = m_wins * std::log(p1.pWin() / p0.pWin()) +
+			     m_losses * std::log(p1.pLoss() / p0.pLoss()) +
+			     m_draws * std::log(p1.pDraw() / p0.pDraw());
+	}
 
 	// Bounds based on error levels of the test
 	status.lBound = std::log(m_beta / (1.0 - m_alpha));
@@ -203,3 +221,58 @@ void Sprt::addGameResult(GameResult result)
 	else if (result == Loss)
 		m_losses++;
 }
+
+void Sprt::addGamePairResult(GamePairResult result)
+{
+	Q_ASSERT(result >= LossLoss && result <= WinWin);
+	m_gamePairs[result]++;
+}
+
+int Sprt::gamePairCount(GamePairResult result) const
+{
+	Q_ASSERT(result >= LossLoss && result <= WinWin);
+	return m_gamePairs[result];
+}
+
+bool Sprt::pentanomialLlr(double* llr) const
+{
+	int pairCount = 0;
+	for (int count : m_gamePairs)
+		pairCount += count;
+	if (pairCount <= 0)
+		return false;
+
+	// Regularize empty outcomes so that the variance can't be zero
+	const double epsilon = 1e-3;
+	double n = 0.0;
+	for (int count : m_gamePairs)
+		n += std::max(epsilon, double(count));
+
+	// Mean and variance of the game pair score (0, 1/4, ..., 1)
+	double mean = 0.0;
+	double variance = 0.0;
+	for (int i = 0; i < 5; i++)
+	{
+		const double p = std::max(epsilon, double(m_gamePairs[i])) / n;
+		const double score = i / 4.0;
+		mean += p * score;
+		variance += p * score * score;
+	}
+	variance -= mean * mean;
+	if (variance <= 0.0)
+		return false;
+
+	// Normalized Elo is the score's deviation from 0.5 divided by
+	// the standard deviation of a single game, scaled to Elo units.
+	// The expected pair scores under H0 and H1 follow from it.
+	const double nEloScale = 800.0 / std::log(10.0);
+	const double sigma = std::sqrt(2.0 * variance);
+	const double mu0 = 0.5 + m_elo0 / nEloScale * sigma;
+	const double mu1 = 0.5 + m_elo1 / nEloScale * sigma;
+
+	// Generalized log-likelihood ratio of the normal approximation
+	*llr = n / 2.0 * std::log(
+		(variance + (mean - mu0) * (mean - mu0)) /
+		(variance + (mean - mu1) * (mean - mu1)));
+	return true;
+}
@@ -27,6 +27,11 @@
  * players when the Elo difference is known to be outside of the specified
  * interval.
  *
+ * The test can use either a trinomial BayesElo model of single game
+ * results, or a pentanomial normalized Elo model of game pair results.
+ * The pentanomial model accounts for the correlation between the two
+ * games of an opening pair, so it usually needs fewer games.
+ *
  * \sa http://en.wikipedia.org/wiki/Sequential_probability_ratio_test
  */
 class LIB_EXPORT Sprt
@@ -49,6 +54,26 @@ class LIB_EXPORT Sprt
 			Draw		//!< Game was drawn
 		};
 
+		/*!
+		 * The combined result of a game pair, ie. two games played
+		 * with the same opening, for the first player.
+		 */
+		enum GamePairResult
+		{
+			LossLoss,	//!< Two losses
+			LossDraw,	//!< A loss and a draw
+			DrawDraw,	//!< Two draws, or a win and a loss
+			WinDraw,	//!< A win and a draw
+			WinWin		//!< Two wins
+		};
+
+		/*! The statistical model of the test. */
+		enum Model
+		{
+			Trinomial,	//!< BayesElo model of game results
+			Pentanomial	//!< Normalized Elo model of game pairs
+		};
+
 		/*! The status of the test. */
 		struct Status
 		{
@@ -75,9 +100,16 @@ class LIB_EXPORT Sprt
 		 *
 		 * \a alpha is the maximum probability for a type I error and
 		 * \a beta for a type II error outside interval [elo0, elo1].
+		 *
+		 * With the \a Pentanomial \a model the Elo differences are
+		 * normalized Elo and the test uses game pair results, so
+		 * every opening must be played twice with reversed colors.
 		 */
 		void initialize(double elo0, double elo1,
-				double alpha, double beta);
+				double alpha, double beta,
+				Model model = Trinomial);
+		/*! Returns the statistical model of the test. */
+		Model model() const;
 		/*! Returns the current status of the test. */
 		Status status() const;
 		/*!
@@ -87,15 +119,27 @@ class LIB_EXPORT Sprt
 		 * check if H0 or H1 can be accepted.
 		 */
 		void addGameResult(GameResult result);
+		/*!
+		 * Updates the test with game pair result \a result.
+		 *
+		 * Only the \a Pentanomial model uses game pair results.
+		 */
+		void addGamePairResult(GamePairResult result);
+		/*! Returns the number of game pairs that ended in \a result. */
+		int gamePairCount(GamePairResult result) const;
 
 	private:
+		bool pentanomialLlr(double* llr) const;
+
 		double m_elo0;
 		double m_elo1;
 		double m_alpha;
 		double m_beta;
+		Model m_model;
 		int m_wins;
 		int m_losses;
 		int m_draws;
+		int m_gamePairs[5];
 };
 
 #endif // SPRT_H
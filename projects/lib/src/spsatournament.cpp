@@ -0,0 +1,235 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "spsatournament.h"
+#include <QtMath>
+#include "chessgame.h"
+#include "mersenne.h"
+
+namespace {
+
+// Decay exponents of the learning rate and the perturbation size,
+// as recommended by Spall
+const double s_alpha = 0.602;
+const double s_gamma = 0.101;
+
+} // anonymous namespace
+
+SpsaTournament::SpsaTournament(GameManager* gameManager,
+			       QObject *parent)
+	: Tournament(gameManager, parent),
+	  m_iterationCount(1),
+	  m_finishedIterations(0),
+	  m_stability(0.0)
+{
+	connect(this, SIGNAL(gameFinished(ChessGame*, int, int, int)),
+		this, SLOT(onIterationGameFinished(ChessGame*)));
+}
+
+QString SpsaTournament::type() const
+{
+	return "spsa";
+}
+
+void SpsaTournament::addParameter(const QString& name,
+				  double start,
+				  double min,
+				  double max,
+				  double cEnd,
+				  double rEnd)
+{
+	Q_ASSERT(!name.isEmpty());
+	Q_ASSERT(min <= max);
+
+	Parameter param;
+	param.name = name;
+	param.value = qBound(min, start, max);
+	param.min = min;
+	param.max = max;
+	param.cEnd = cEnd;
+	param.rEnd = rEnd;
+	param.c = cEnd;
+	param.a = rEnd * cEnd * cEnd;
+	m_params.append(param);
+}
+
+int SpsaTournament::parameterCount() const
+{
+	return m_params.size();
+}
+
+QVariantMap SpsaTournament::parameterValues() const
+{
+	QVariantMap values;
+	for (const Parameter& param : m_params)
+		values[param.name] = param.value;
+	return values;
+}
+
+void SpsaTournament::initializePairing()
+{
+	m_iterations.clear();
+	m_gameIterations.clear();
+	m_finishedIterations = 0;
+	m_iterationCount = qMax(1, gamesPerEncounter() * roundMultiplier() / 2);
+	m_stability = 0.1 * m_iterationCount;
+
+	// Scale the gains so that the final iteration uses exactly the
+	// perturbation size and learning rate given for each parameter
+	for (Parameter& param : m_params)
+	{
+		param.c = param.cEnd * qPow(m_iterationCount, s_gamma);
+		param.a = param.rEnd * param.cEnd * param.cEnd
+			* qPow(m_stability + m_iterationCount, s_alpha);
+	}
+}
+
+int SpsaTournament::gamesPerCycle() const
+{
+	return 1;
+}
+
+TournamentPair* SpsaTournament::nextPair(int gameNumber)
+{
+	if (gameNumber >= finalGameCount())
+		return nullptr;
+
+	setCurrentRound(gameNumber / gamesPerEncounter() + 1);
+	return pair(0, 1);
+}
+
+double SpsaTournament::perturbation(int index, int k) const
+{
+	return m_params.at(index).c / qPow(k, s_gamma);
+}
+
+double SpsaTournament::learningRate(int index, int k) const
+{
+	return m_params.at(index).a / qPow(m_stability + k, s_alpha);
+}
+
+SpsaTournament::Iteration SpsaTournament::createIteration(int k) const
+{
+	Iteration iteration;
+	iteration.k = k;
+	iteration.finishedGames = 0;
+
+	for (int i = 0; i < m_params.size(); i++)
+	{
+		const Parameter& param = m_params.at(i);
+		const int flip = (Mersenne::random() & 1) ? 1 : -1;
+		const double delta = perturbation(i, k) * flip;
+
+		iteration.flips.append(flip);
+		iteration.plus[param.name] =
+			qRound(qBound(param.min, param.value + delta, param.max));
+		iteration.minus[param.name] =
+			qRound(qBound(param.min, param.value - delta, param.max));
+	}
+
+	return iteration;
+}
+
+void SpsaTournament::onGameAboutToStart(ChessGame* game,
+					const PlayerBuilder* white,
+					const PlayerBuilder* black)
+{
+	Q_UNUSED(white);
+	Q_UNUSED(black);
+
+	// Both games of a game pair belong to the same iteration
+	const int number = (currentPair()->gamesStarted() - 1) / 2;
+	auto it = m_iterations.find(number);
+	if (it == m_iterations.end())
+		it = m_iterations.insert(number, createIteration(number + 1));
+	m_gameIterations[game] = number;
+
+	const bool plusIsWhite = playerIndex(game, Chess::Side::White) == 0;
+	game->setEngineOptions(Chess::Side::White,
+			       plusIsWhite ? it->plus : it->minus);
+	game->setEngineOptions(Chess::Side::Black,
+			       plusIsWhite ? it->minus : it->plus);
+}
+
+void SpsaTournament::onGamePairFinished(TournamentPair* pair,
+					int number,
+					int player,
+					int score)
+{
+	Q_UNUSED(pair);
+
+	auto it = m_iterations.find(number);
+	if (it == m_iterations.end())
+		return;
+	const Iteration iteration(it.value());
+	m_iterations.erase(it);
+
+	// The result of the first (plus) player: wins minus losses
+	const int result = ((player == 0) ? score : 4 - score) - 2;
+
+	step(iteration.k, iteration.flips, result);
+	m_finishedIterations++;
+}
+
+void SpsaTournament::onIterationGameFinished(ChessGame* game)
+{
+	// Complete game pairs are handled by onGamePairFinished(), which
+	// is called before this slot and removes the iteration
+	auto gameIt = m_gameIterations.find(game);
+	if (gameIt == m_gameIterations.end())
+		return;
+	auto it = m_iterations.find(gameIt.value());
+	m_gameIterations.erase(gameIt);
+	if (it == m_iterations.end())
+		return;
+
+	// Both games have finished but at least one of them has no
+	// result, so the pair can't move the parameters
+	if (++it->finishedGames == 2)
+		m_iterations.erase(it);
+}
+
+void SpsaTournament::step(int k, const QVector<int>& flips, int result)
+{
+	Q_ASSERT(flips.size() == m_params.size());
+
+	for (int i = 0; i < m_params.size(); i++)
+	{
+		Parameter& param = m_params[i];
+		const double value = param.value + learningRate(i, k)
+				   * result * flips.at(i) / perturbation(i, k);
+		param.value = qBound(param.min, value, param.max);
+	}
+}
+
+QString SpsaTournament::results() const
+{
+	QString ret(Tournament::results());
+
+	ret += tr("\nSPSA parameters after %1 of %2 iterations:\n")
+		.arg(m_finishedIterations)
+		.arg(m_iterationCount);
+	for (const Parameter& param : m_params)
+	{
+		ret += QString("%1 %2\n")
+			.arg(param.name, -20)
+			.arg(param.value, 0, 'f', 2);
+	}
+
+	return ret;
+}
@@ -0,0 +1,146 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPSATOURNAMENT_H
+#define SPSATOURNAMENT_H
+
+#include "tournament.h"
+#include <QVariant>
+
+/*!
+ * \brief A tournament that tunes engine parameters with SPSA.
+ *
+ * SpsaTournament runs Simultaneous Perturbation Stochastic
+ * Approximation between its first two participants, which are
+ * normally the same engine. Every game pair is one SPSA iteration:
+ * all tuned spin options are perturbed randomly, the first player
+ * plays with the parameters moved in one direction and the second
+ * player with the parameters moved in the other, and the result of
+ * the pair moves the parameters towards the better side.
+ *
+ * The options are sent to the running engines before each game, so
+ * the engines are not restarted between iterations. Iterations of
+ * concurrent game pairs are updated as soon as each pair finishes.
+ *
+ * The number of iterations is half the number of games. Both games
+ * of a pair must use the same opening with the players on opposite
+ * sides, so the tournament needs an even openingRepetitions() and
+ * swapSides() enabled. A pair with a game that ends without a result
+ * is dropped without updating the parameters.
+ */
+class LIB_EXPORT SpsaTournament : public Tournament
+{
+	Q_OBJECT
+
+	public:
+		/*! Creates a new SPSA tuning tournament. */
+		explicit SpsaTournament(GameManager* gameManager,
+					QObject *parent = nullptr);
+
+		/*!
+		 * Adds the engine option \a name to the tuned parameters.
+		 *
+		 * \param start The initial value of the parameter.
+		 * \param min The minimum value of the parameter.
+		 * \param max The maximum value of the parameter.
+		 * \param cEnd The perturbation size at the last iteration.
+		 * \param rEnd The learning rate at the last iteration,
+		 *             relative to \a cEnd squared.
+		 */
+		void addParameter(const QString& name,
+				  double start,
+				  double min,
+				  double max,
+				  double cEnd,
+				  double rEnd = 0.002);
+		/*! Returns the number of tuned parameters. */
+		int parameterCount() const;
+		/*! Returns the current values of the tuned parameters. */
+		QVariantMap parameterValues() const;
+
+		// Inherited from Tournament
+		virtual QString type() const;
+		virtual QString results() const;
+
+	protected:
+		// Inherited from Tournament
+		virtual void initializePairing();
+		virtual int gamesPerCycle() const;
+		virtual TournamentPair* nextPair(int gameNumber);
+		virtual void onGameAboutToStart(ChessGame* game,
+						const PlayerBuilder* white,
+						const PlayerBuilder* black);
+		virtual void onGamePairFinished(TournamentPair* pair,
+						int number,
+						int player,
+						int score);
+
+		/*!
+		 * Returns the perturbation size c_k of parameter \a index
+		 * at iteration \a k, starting from 1.
+		 */
+		double perturbation(int index, int k) const;
+		/*!
+		 * Returns the learning rate a_k of parameter \a index
+		 * at iteration \a k, starting from 1.
+		 */
+		double learningRate(int index, int k) const;
+		/*!
+		 * Moves the parameters by one SPSA step at iteration \a k.
+		 *
+		 * \a flips are the signs of the perturbations of the plus
+		 * player, and \a result is the plus player's wins minus
+		 * losses in the game pair.
+		 */
+		void step(int k, const QVector<int>& flips, int result);
+
+	private slots:
+		void onIterationGameFinished(ChessGame* game);
+
+	private:
+		struct Parameter
+		{
+			QString name;
+			double value;
+			double min;
+			double max;
+			double cEnd;
+			double rEnd;
+			double c;
+			double a;
+		};
+		struct Iteration
+		{
+			int k;
+			QVector<int> flips;
+			QVariantMap plus;
+			QVariantMap minus;
+			int finishedGames;
+		};
+
+		Iteration createIteration(int k) const;
+
+		QVector<Parameter> m_params;
+		QMap<int, Iteration> m_iterations;
+		QMap<ChessGame*, int> m_gameIterations;
+		int m_iterationCount;
+		int m_finishedIterations;
+		double m_stability;
+};
+
+#endif // SPSATOURNAMENT_H
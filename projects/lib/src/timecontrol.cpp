@@ -52,6 +52,10 @@ TimeControl::TimeControl()
 	  m_plyLimit(0),
 	  m_nodeLimit(0),
 	  m_lastMoveTime(0),
+	  m_lastMoveLatency(0),
+	  m_timeRemainder(0),
+	  m_requestStamp(-1),
+	  m_replyStamp(-1),
 	  m_expiryMargin(0),
 	  m_expired(false),
 	  m_infinite(false),
@@ -69,6 +73,10 @@ TimeControl::TimeControl(const QString& str)
 	  m_plyLimit(0),
 	  m_nodeLimit(0),
 	  m_lastMoveTime(0),
+	  m_lastMoveLatency(0),
+	  m_timeRemainder(0),
+	  m_requestStamp(-1),
+	  m_replyStamp(-1),
 	  m_expiryMargin(0),
 	  m_expired(false),
 	  m_infinite(false),
@@ -215,6 +223,10 @@ void TimeControl::initialize()
 {
 	m_expired = false;
 	m_lastMoveTime = 0;
+	m_lastMoveLatency = 0;
+	m_timeRemainder = 0;
+	m_requestStamp = -1;
+	m_replyStamp = -1;
 
 	if (m_timePerTc != 0)
 	{
@@ -346,20 +358,42 @@ void TimeControl::setExpiryMargin(int expiryMargin)
 void TimeControl::startTimer()
 {
 	m_time.start();
+	m_requestStamp = -1;
+	m_replyStamp = -1;
+}
+
+void TimeControl::stampMoveRequest()
+{
+	if (m_time.isValid() && m_requestStamp == -1)
+		m_requestStamp = m_time.nsecsElapsed();
+}
+
+void TimeControl::stampMoveReply()
+{
+	if (m_time.isValid())
+		m_replyStamp = m_time.nsecsElapsed();
 }
 
 void TimeControl::update(bool applyIncrement)
 {
-	/*
-	 * This will overflow after roughly 49 days however it's unlikely
-	 * we'll ever hit that limit.
-	 */
+	qint64 elapsed = 0;
+	qint64 thinkTime = 0;
 	if (m_time.isValid())
-		m_lastMoveTime = (int)m_time.elapsed();
-	else
-		m_lastMoveTime = 0;
+	{
+		elapsed = m_time.nsecsElapsed();
+		const qint64 start = qMax(m_requestStamp, qint64(0));
+		const qint64 end = m_replyStamp >= start ? m_replyStamp : elapsed;
+		thinkTime = end - start;
+	}
+	m_lastMoveLatency = elapsed - thinkTime;
+
+	// Charge whole milliseconds and carry the rest to the next move
+	const qint64 charged = thinkTime + m_timeRemainder;
+	m_lastMoveTime = int(charged / 1000000);
+	m_timeRemainder = charged % 1000000;
 
-	if (!m_infinite && m_lastMoveTime > m_timeLeft + m_expiryMargin)
+	if (!m_infinite
+	&&  thinkTime > qint64(m_timeLeft + m_expiryMargin) * 1000000)
 		m_expired = true;
 
 	if (m_timePerMove != 0)
@@ -390,6 +424,11 @@ int TimeControl::lastMoveTime() const
 	return m_lastMoveTime;
 }
 
+qint64 TimeControl::lastMoveLatency() const
+{
+	return m_lastMoveLatency;
+}
+
 bool TimeControl::expired() const
 {
 	return m_expired;
@@ -397,9 +436,20 @@ bool TimeControl::expired() const
 
 int TimeControl::activeTimeLeft() const
 {
-	if (m_time.isValid())
-		return m_timeLeft - m_time.elapsed();
-	return m_timeLeft;
+	if (!m_time.isValid())
+		return m_timeLeft;
+
+	const qint64 start = qMax(m_requestStamp, qint64(0));
+	return m_timeLeft - int((m_time.nsecsElapsed() - start) / 1000000);
+}
+
+qint64 TimeControl::activeTimeLeftNsecs() const
+{
+	if (!m_time.isValid())
+		return qint64(m_timeLeft) * 1000000;
+
+	const qint64 start = qMax(m_requestStamp, qint64(0));
+	return qint64(m_timeLeft) * 1000000 - (m_time.nsecsElapsed() - start);
 }
 
 void TimeControl::readSettings(QSettings* settings)
@@ -30,7 +30,10 @@ class QSettings;
  * TimeControl is used for telling the chess players how much time
  * they can spend thinking of their moves.
  *
- * \note All time handling is done in milliseconds.
+ * \note All time handling is done in milliseconds. Move times are
+ * measured in nanoseconds with a monotonic clock and the sub-millisecond
+ * remainder is carried over to the next move, so that rounding doesn't
+ * add up over a game.
  */
 class LIB_EXPORT TimeControl
 {
@@ -182,6 +185,25 @@ class LIB_EXPORT TimeControl
 		
 		/*! Start the timer. */
 		void startTimer();
+
+		/*!
+		 * Records the moment the move request reached the player,
+		 * eg. when it was written to the engine's input pipe.
+		 *
+		 * Only the first call after startTimer() counts. The time
+		 * between startTimer() and this stamp is not charged to
+		 * the player.
+		 */
+		void stampMoveRequest();
+
+		/*!
+		 * Records the moment the player's reply arrived, eg. when
+		 * it was read from the engine's output pipe.
+		 *
+		 * The last call before update() counts. The time between
+		 * this stamp and update() is not charged to the player.
+		 */
+		void stampMoveReply();
 		
 		/*!
 		 * Update the time control with the elapsed time.
@@ -195,6 +217,16 @@ class LIB_EXPORT TimeControl
 		/*! Returns the last elapsed move time. */
 		int lastMoveTime() const;
 
+		/*!
+		 * Returns the transport latency of the last move in
+		 * nanoseconds.
+		 *
+		 * This is the part of the elapsed time that was spent
+		 * outside the move request and reply stamps, and which
+		 * wasn't charged to the player.
+		 */
+		qint64 lastMoveLatency() const;
+
 		/*! Returns true if the allotted time has expired. */
 		bool expired() const;
 
@@ -206,6 +238,12 @@ class LIB_EXPORT TimeControl
 		 * state first to verify that it's in the thinking state.
 		 */
 		int activeTimeLeft() const;
+		/*!
+		 * Returns the time left in an active clock in nanoseconds.
+		 *
+		 * \sa activeTimeLeft()
+		 */
+		qint64 activeTimeLeftNsecs() const;
 
 		/*! Reads time control settings from \a settings. */
 		void readSettings(QSettings* settings);
@@ -223,6 +261,10 @@ class LIB_EXPORT TimeControl
 		int m_plyLimit;
 		qint64 m_nodeLimit;
 		int m_lastMoveTime;
+		qint64 m_lastMoveLatency;
+		qint64 m_timeRemainder;
+		qint64 m_requestStamp;
+		qint64 m_replyStamp;
 		int m_expiryMargin;
 		bool m_expired;
 		bool m_infinite;
@@ -29,6 +29,7 @@
 #include "openingsuite.h"
 #include "openingbook.h"
 #include "sprt.h"
+#include "tournamentmetrics.h"
 #include "elo.h"
 
 
@@ -58,6 +59,7 @@ Tournament::Tournament(GameManager* gameManager, QObject *parent)
 	  m_bookOwnership(false),
 	  m_openingSuite(nullptr),
 	  m_sprt(new Sprt),
+	  m_metrics(new TournamentMetrics),
 	  m_repetitionCounter(0),
 	  m_swapSides(true),
 	  m_reverseSides(false),
@@ -128,6 +130,7 @@ Tournament::~Tournament()
 
 	delete m_openingSuite;
 	delete m_sprt;
+	delete m_metrics;
 
 	if (m_pgnFile.isOpen())
 		m_pgnFile.close();
@@ -181,6 +184,16 @@ int Tournament::roundMultiplier() const
 	return m_roundMultiplier;
 }
 
+int Tournament::openingRepetitions() const
+{
+	return m_openingRepetitions;
+}
+
+bool Tournament::swapSides() const
+{
+	return m_swapSides;
+}
+
 int Tournament::finishedGameCount() const
 {
 	return m_finishedGameCount;
@@ -211,6 +224,11 @@ Sprt* Tournament::sprt() const
 	return m_sprt;
 }
 
+TournamentMetrics* Tournament::metrics() const
+{
+	return m_metrics;
+}
+
 bool Tournament::canSetRoundMultiplier() const
 {
 	return true;
@@ -482,6 +500,8 @@ void Tournament::startGame(TournamentPair* pair)
 	data->number = ++m_nextGameNumber;
 	data->whiteIndex = m_pair->firstPlayer();
 	data->blackIndex = m_pair->secondPlayer();
+	data->pair = m_pair;
+	data->pairGame = m_pair->gamesStarted() - 1;
 	m_gameData[game] = data;
 
 	// Some tournament types may require more games than expected
@@ -712,6 +732,17 @@ void Tournament::addOutcome(int iWhite, int iBlack, Chess::Result result)
 	}
 }
 
+void Tournament::onGamePairFinished(TournamentPair* pair,
+				    int number,
+				    int player,
+				    int score)
+{
+	Q_UNUSED(pair);
+	Q_UNUSED(number);
+	Q_UNUSED(player);
+	Q_UNUSED(score);
+}
+
 void Tournament::onGameStarted(ChessGame* game)
 {
 	Q_ASSERT(game != nullptr);
@@ -722,6 +753,7 @@ void Tournament::onGameStarted(ChessGame* game)
 	int iBlack = data->blackIndex;
 	m_players[iWhite].setName(game->player(Chess::Side::White)->name());
 	m_players[iBlack].setName(game->player(Chess::Side::Black)->name());
+	m_metrics->addStartedGame(game);
 
 	emit gameStarted(game, data->number, iWhite, iBlack);
 }
@@ -738,6 +770,7 @@ void Tournament::onGameFinished(ChessGame* game)
 	GameData* data = m_gameData.take(game);
 	int gameNumber = data->number;
 	Sprt::GameResult sprtResult = Sprt::NoResult;
+	int whiteScore = -1;
 
 	int iWhite = data->whiteIndex;
 	int iBlack = data->blackIndex;
@@ -754,11 +787,13 @@ void Tournament::onGameFinished(ChessGame* game)
 		addScore(iWhite, Chess::Side::White, 2);
 		addScore(iBlack, Chess::Side::Black, 0);
 		sprtResult = (iWhite == 0) ? Sprt::Win : Sprt::Loss;
+		whiteScore = 2;
 		break;
 	case Chess::Side::Black:
 		addScore(iBlack, Chess::Side::Black, 2);
 		addScore(iWhite, Chess::Side::White, 0);
 		sprtResult = (iBlack == 0) ? Sprt::Win : Sprt::Loss;
+		whiteScore = 0;
 		break;
 	default:
 		if (game->result().isDraw())
@@ -766,6 +801,7 @@ void Tournament::onGameFinished(ChessGame* game)
 			addScore(iWhite,  Chess::Side::White, 1);
 			addScore(iBlack,  Chess::Side::Black, 1);
 			sprtResult = Sprt::Draw;
+			whiteScore = 1;
 		}
 		break;
 	}
@@ -774,6 +810,7 @@ void Tournament::onGameFinished(ChessGame* game)
 	writePgn(pgn, gameNumber);
 
 	addOutcome(iWhite, iBlack, game->result());
+	m_metrics->addFinishedGame(game);
 	Chess::Result::Type resultType(game->result().type());
 
 	bool crashed = (resultType == Chess::Result::Disconnection ||
@@ -781,9 +818,21 @@ void Tournament::onGameFinished(ChessGame* game)
 	if (!m_recover && crashed)
 		stop();
 
+	// Games with the same opening form a game pair
+	int pairScore = -1;
+	if (whiteScore != -1)
+		pairScore = data->pair->addPairGame(data->pairGame, iWhite, whiteScore);
+	if (pairScore != -1)
+		onGamePairFinished(data->pair, data->pairGame / 2, iWhite, pairScore);
+
 	if (!m_sprt->isNull() && sprtResult != Sprt::NoResult)
 	{
 		m_sprt->addGameResult(sprtResult);
+		if (pairScore != -1)
+		{
+			const int score = (iWhite == 0) ? pairScore : 4 - pairScore;
+			m_sprt->addGamePairResult(Sprt::GamePairResult(score));
+		}
 		if (m_sprt->status().result != Sprt::Continue)
 			QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
 	}
@@ -850,6 +899,7 @@ void Tournament::start()
 	m_pgnGames.clear();
 	m_startFen.clear();
 	m_openingMoves.clear();
+	m_metrics->start(m_gameManager->concurrency());
 
 	connect(m_gameManager, SIGNAL(ready()),
 		this, SLOT(startNextGame()));
@@ -1102,6 +1152,16 @@ QString Tournament::results() const
 		else if (sprtStatus.result == Sprt::AcceptH1)
 			sprtStr.append(" - H1 was accepted");
 
+		if (sprt()->model() == Sprt::Pentanomial)
+		{
+			sprtStr.append(QString("\nPtnml(0-2): %1, %2, %3, %4, %5")
+				.arg(sprt()->gamePairCount(Sprt::LossLoss))
+				.arg(sprt()->gamePairCount(Sprt::LossDraw))
+				.arg(sprt()->gamePairCount(Sprt::DrawDraw))
+				.arg(sprt()->gamePairCount(Sprt::WinDraw))
+				.arg(sprt()->gamePairCount(Sprt::WinWin)));
+		}
+
 		ret += "\n" + sprtStr;
 	}
 
@@ -37,6 +37,7 @@ class ChessGame;
 class OpeningBook;
 class OpeningSuite;
 class Sprt;
+class TournamentMetrics;
 
 /*!
  * \brief Base class for chess tournaments
@@ -128,6 +129,19 @@ class LIB_EXPORT Tournament : public QObject
 		 * The default value is 1.
 		 */
 		int roundMultiplier() const;
+		/*!
+		 * Returns the number of times each opening is played.
+		 *
+		 * \sa setOpeningRepetitions()
+		 */
+		int openingRepetitions() const;
+		/*!
+		 * Returns true if paired engines swap sides for the
+		 * following game; otherwise returns false.
+		 *
+		 * \sa setSwapSides()
+		 */
+		bool swapSides() const;
 		/*! Returns the number of games finished so far. */
 		int finishedGameCount() const;
 		/*! Returns the total number of games that will be played. */
@@ -148,6 +162,13 @@ class LIB_EXPORT Tournament : public QObject
 		 * stopping criterion.
 		 */
 		Sprt* sprt() const;
+		/*!
+		 * Returns the throughput and latency statistics of this
+		 * tournament.
+		 *
+		 * The statistics are reset when the tournament starts.
+		 */
+		TournamentMetrics* metrics() const;
 
 		/*! Sets the tournament's name to \a name. */
 		void setName(const QString& name);
@@ -479,6 +500,18 @@ class LIB_EXPORT Tournament : public QObject
 		virtual void addOutcome(int iWhite,
 					int iBlack,
 					Chess::Result result);
+		/*!
+		 * This member function is called when both games of game
+		 * pair \a number of \a pair have finished with a result.
+		 * \a score is the combined score of player \a player in
+		 * half points (0 to 4).
+		 *
+		 * The default implementation does nothing.
+		 */
+		virtual void onGamePairFinished(TournamentPair* pair,
+						int number,
+						int player,
+						int score);
 		/*!
 		 * Returns true if all games in the tournament have finished;
 		 * otherwise returns false.
@@ -635,6 +668,8 @@ class LIB_EXPORT Tournament : public QObject
 			int number;
 			int whiteIndex;
 			int blackIndex;
+			TournamentPair* pair;
+			int pairGame;
 		};
 		struct RankingData
 		{
@@ -714,6 +749,7 @@ class LIB_EXPORT Tournament : public QObject
 		GameAdjudicator m_adjudicator;
 		OpeningSuite* m_openingSuite;
 		Sprt* m_sprt;
+		TournamentMetrics* m_metrics;
 		QFile m_pgnFile;
 		QTextStream m_pgnOut;
 		QFile m_epdFile;
@@ -21,6 +21,7 @@
 #include "gauntlettournament.h"
 #include "knockouttournament.h"
 #include "pyramidtournament.h"
+#include "spsatournament.h"
 
 Tournament* TournamentFactory::create(const QString& type,
 				      GameManager* manager,
@@ -34,6 +35,8 @@ Tournament* TournamentFactory::create(const QString& type,
 		return new KnockoutTournament(manager, parent);
 	if (type == "pyramid")
 		return new PyramidTournament(manager, parent);
+	if (type == "spsa")
+		return new SpsaTournament(manager, parent);
 
 	return nullptr;
 }
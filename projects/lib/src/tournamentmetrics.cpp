@@ -0,0 +1,333 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tournamentmetrics.h"
+#include <QDateTime>
+#include "chessgame.h"
+#include "pgngame.h"
+
+namespace {
+
+// Upper bounds of the move latency histogram buckets in microseconds
+const int s_latencyBuckets[] = {
+	100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+const int s_latencyBucketCount =
+	int(sizeof(s_latencyBuckets) / sizeof(s_latencyBuckets[0]));
+
+QString s_labelValue(const QString& value)
+{
+	QString str(value);
+	str.replace('\\', "\\\\");
+	str.replace('"', "\\\"");
+	str.replace('\n', "\\n");
+	return str;
+}
+
+void s_addHeader(QString& out,
+		 const QString& name,
+		 const QString& type,
+		 const QString& help)
+{
+	out += QString("# HELP %1 %2\n# TYPE %1 %3\n")
+	       .arg(name, help, type);
+}
+
+void s_addSample(QString& out,
+		 const QString& name,
+		 double value,
+		 const QString& labels = QString())
+{
+	out += name;
+	if (!labels.isEmpty())
+		out += '{' + labels + '}';
+	out += ' ' + QString::number(value, 'g', 12) + '\n';
+}
+
+} // anonymous namespace
+
+TournamentMetrics::EngineData::EngineData()
+	: moves(0),
+	  thinkTime(0),
+	  latencySum(0),
+	  maxLatency(0),
+	  timeForfeits(0),
+	  latencyHistogram(s_latencyBucketCount + 1, 0)
+{
+}
+
+TournamentMetrics::TournamentMetrics()
+	: m_concurrency(1),
+	  m_finishedGames(0),
+	  m_timeForfeits(0),
+	  m_disconnections(0),
+	  m_stalledConnections(0),
+	  m_plies(0),
+	  m_busyTime(0),
+	  m_lastFinishTime(0)
+{
+}
+
+void TournamentMetrics::start(int concurrency)
+{
+	m_clock.start();
+	m_concurrency = qMax(concurrency, 1);
+	m_finishedGames = 0;
+	m_timeForfeits = 0;
+	m_disconnections = 0;
+	m_stalledConnections = 0;
+	m_plies = 0;
+	m_busyTime = 0;
+	m_lastFinishTime = 0;
+	m_startTimes.clear();
+	m_engines.clear();
+}
+
+void TournamentMetrics::addStartedGame(const ChessGame* game)
+{
+	Q_ASSERT(game != nullptr);
+	m_startTimes[game] = m_clock.isValid() ? m_clock.elapsed() : 0;
+}
+
+void TournamentMetrics::addFinishedGame(const ChessGame* game)
+{
+	Q_ASSERT(game != nullptr);
+
+	const qint64 now = m_clock.isValid() ? m_clock.elapsed() : 0;
+	if (m_startTimes.contains(game))
+		m_busyTime += now - m_startTimes.take(game);
+	m_lastFinishTime = now;
+	m_finishedGames++;
+	m_plies += game->moves().size();
+
+	const PgnGame* pgn = game->pgn();
+	for (int i = 0; i < 2; i++)
+	{
+		const Chess::Side side = Chess::Side::Type(i);
+		addMoves(pgn->playerName(side),
+			 game->moveTimes(side),
+			 game->moveLatencies(side));
+	}
+
+	const Chess::Result result(game->result());
+	switch (result.type())
+	{
+	case Chess::Result::Timeout:
+		m_timeForfeits++;
+		if (!result.loser().isNull())
+			m_engines[pgn->playerName(result.loser())].timeForfeits++;
+		break;
+	case Chess::Result::Disconnection:
+		m_disconnections++;
+		break;
+	case Chess::Result::StalledConnection:
+		m_stalledConnections++;
+		break;
+	default:
+		break;
+	}
+}
+
+void TournamentMetrics::addMoves(const QString& name,
+				 const QVector<int>& times,
+				 const QVector<int>& latencies)
+{
+	EngineData& data = m_engines[name];
+	data.moves += times.size();
+
+	for (int time : times)
+		data.thinkTime += time;
+
+	for (int latency : latencies)
+	{
+		data.latencySum += latency;
+		data.maxLatency = qMax(data.maxLatency, latency);
+
+		int bucket = 0;
+		while (bucket < s_latencyBucketCount
+		&&     latency > s_latencyBuckets[bucket])
+			bucket++;
+		data.latencyHistogram[bucket]++;
+	}
+}
+
+int TournamentMetrics::activeGameCount() const
+{
+	return m_startTimes.size();
+}
+
+int TournamentMetrics::finishedGameCount() const
+{
+	return m_finishedGames;
+}
+
+double TournamentMetrics::elapsedSeconds() const
+{
+	if (!m_clock.isValid())
+		return 0.0;
+	return m_clock.elapsed() / 1000.0;
+}
+
+QVariant TournamentMetrics::toVariant() const
+{
+	const double elapsed = elapsedSeconds();
+	const qint64 now = qint64(elapsed * 1000.0);
+
+	// Games in progress keep their slots busy too
+	qint64 busyTime = m_busyTime;
+	for (qint64 startTime : m_startTimes)
+		busyTime += now - startTime;
+
+	QVariantMap map;
+	map.insert("timestamp", QDateTime::currentDateTimeUtc()
+				.toString(Qt::ISODate));
+	map.insert("elapsed", elapsed);
+	map.insert("concurrency", m_concurrency);
+	map.insert("games_active", activeGameCount());
+	map.insert("games_finished", m_finishedGames);
+	map.insert("plies", m_plies);
+	map.insert("time_forfeits", m_timeForfeits);
+	map.insert("disconnections", m_disconnections);
+	map.insert("stalled_connections", m_stalledConnections);
+	map.insert("seconds_since_last_game", (now - m_lastFinishTime) / 1000.0);
+
+	if (elapsed > 0.0)
+	{
+		map.insert("games_per_hour", m_finishedGames * 3600.0 / elapsed);
+		map.insert("moves_per_second", m_plies / elapsed);
+		map.insert("slot_utilization",
+			   busyTime / (elapsed * 1000.0 * m_concurrency));
+	}
+
+	QVariantList buckets;
+	for (int i = 0; i < s_latencyBucketCount; i++)
+		buckets << s_latencyBuckets[i];
+	map.insert("latency_buckets_us", buckets);
+
+	QVariantMap engines;
+	for (auto it = m_engines.constBegin(); it != m_engines.constEnd(); ++it)
+	{
+		const EngineData& data = it.value();
+		QVariantMap engine;
+		engine.insert("moves", data.moves);
+		engine.insert("think_time", data.thinkTime / 1000.0);
+		engine.insert("time_forfeits", data.timeForfeits);
+		engine.insert("max_latency_us", data.maxLatency);
+		if (data.moves > 0)
+			engine.insert("avg_latency_us",
+				      double(data.latencySum) / data.moves);
+
+		QVariantList histogram;
+		for (qint64 count : data.latencyHistogram)
+			histogram << count;
+		engine.insert("latency_histogram", histogram);
+
+		engines.insert(it.key(), engine);
+	}
+	map.insert("engines", engines);
+
+	return map;
+}
+
+QString TournamentMetrics::toPrometheus() const
+{
+	const QVariantMap map(toVariant().toMap());
+	QString out;
+
+	s_addHeader(out, "cutechess_games_finished_total", "counter",
+		    "Number of finished games.");
+	s_addSample(out, "cutechess_games_finished_total", m_finishedGames);
+	s_addHeader(out, "cutechess_games_active", "gauge",
+		    "Number of games in progress.");
+	s_addSample(out, "cutechess_games_active", activeGameCount());
+	s_addHeader(out, "cutechess_concurrency", "gauge",
+		    "Number of game slots.");
+	s_addSample(out, "cutechess_concurrency", m_concurrency);
+	s_addHeader(out, "cutechess_plies_total", "counter",
+		    "Number of half-moves played in finished games.");
+	s_addSample(out, "cutechess_plies_total", m_plies);
+	s_addHeader(out, "cutechess_slot_utilization", "gauge",
+		    "Share of game slot time spent playing games.");
+	s_addSample(out, "cutechess_slot_utilization",
+		    map.value("slot_utilization").toDouble());
+	s_addHeader(out, "cutechess_seconds_since_last_game", "gauge",
+		    "Time since the last game finished.");
+	s_addSample(out, "cutechess_seconds_since_last_game",
+		    map.value("seconds_since_last_game").toDouble());
+	s_addHeader(out, "cutechess_elapsed_seconds", "gauge",
+		    "Time since the tournament started.");
+	s_addSample(out, "cutechess_elapsed_seconds", elapsedSeconds());
+
+	s_addHeader(out, "cutechess_abnormal_results_total", "counter",
+		    "Number of games lost on time or by a crashed engine.");
+	s_addSample(out, "cutechess_abnormal_results_total", m_timeForfeits,
+		    "type=\"timeout\"");
+	s_addSample(out, "cutechess_abnormal_results_total", m_disconnections,
+		    "type=\"disconnection\"");
+	s_addSample(out, "cutechess_abnormal_results_total",
+		    m_stalledConnections, "type=\"stalled_connection\"");
+
+	s_addHeader(out, "cutechess_engine_moves_total", "counter",
+		    "Number of non-book moves made by an engine.");
+	for (auto it = m_engines.constBegin(); it != m_engines.constEnd(); ++it)
+		s_addSample(out, "cutechess_engine_moves_total",
+			    it->moves,
+			    QString("engine=\"%1\"").arg(s_labelValue(it.key())));
+
+	s_addHeader(out, "cutechess_engine_think_seconds_total", "counter",
+		    "Time charged to an engine's clock.");
+	for (auto it = m_engines.constBegin(); it != m_engines.constEnd(); ++it)
+		s_addSample(out, "cutechess_engine_think_seconds_total",
+			    it->thinkTime / 1000.0,
+			    QString("engine=\"%1\"").arg(s_labelValue(it.key())));
+
+	s_addHeader(out, "cutechess_engine_time_forfeits_total", "counter",
+		    "Number of games an engine lost on time.");
+	for (auto it = m_engines.constBegin(); it != m_engines.constEnd(); ++it)
+		s_addSample(out, "cutechess_engine_time_forfeits_total",
+			    it->timeForfeits,
+			    QString("engine=\"%1\"").arg(s_labelValue(it.key())));
+
+	s_addHeader(out, "cutechess_engine_move_latency_seconds", "histogram",
+		    "Transport latency of an engine's moves.");
+	for (auto it = m_engines.constBegin(); it != m_engines.constEnd(); ++it)
+	{
+		const QString engine = s_labelValue(it.key());
+		qint64 count = 0;
+		for (int i = 0; i <= s_latencyBucketCount; i++)
+		{
+			count += it->latencyHistogram.at(i);
+			const QString le = i < s_latencyBucketCount ?
+				QString::number(s_latencyBuckets[i] / 1e6) :
+				QString("+Inf");
+			s_addSample(out,
+				    "cutechess_engine_move_latency_seconds_bucket",
+				    count,
+				    QString("engine=\"%1\",le=\"%2\"")
+				    .arg(engine, le));
+		}
+		s_addSample(out, "cutechess_engine_move_latency_seconds_sum",
+			    it->latencySum / 1e6,
+			    QString("engine=\"%1\"").arg(engine));
+		s_addSample(out, "cutechess_engine_move_latency_seconds_count",
+			    count,
+			    QString("engine=\"%1\"").arg(engine));
+	}
+
+	return out;
+}
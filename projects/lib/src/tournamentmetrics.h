@@ -0,0 +1,103 @@
+/*
+    This file is part of Cute Chess.
+    Copyright (C) 2008-2018 Cute Chess authors
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TOURNAMENTMETRICS_H
+#define TOURNAMENTMETRICS_H
+
+#include <QMap>
+#include <QVector>
+#include <QVariant>
+#include <QElapsedTimer>
+class ChessGame;
+
+/*!
+ * \brief Throughput and latency statistics of a running tournament
+ *
+ * TournamentMetrics collects counters and histograms from the games
+ * of a tournament: games per hour, moves per second, the share of
+ * game slots that were busy, time forfeits and crashes, and each
+ * engine's thinking time and transport latency. The statistics can
+ * be exported as a QVariant tree for JSON or as Prometheus text.
+ *
+ * \sa Tournament::metrics()
+ */
+class LIB_EXPORT TournamentMetrics
+{
+	public:
+		/*! Creates a new empty TournamentMetrics object. */
+		TournamentMetrics();
+
+		/*!
+		 * Clears the statistics and starts measuring the tournament
+		 * time, with \a concurrency game slots available.
+		 */
+		void start(int concurrency);
+		/*! Records that \a game has started. */
+		void addStartedGame(const ChessGame* game);
+		/*!
+		 * Records the moves and the result of \a game.
+		 *
+		 * \a game must have been passed to addStartedGame() before.
+		 */
+		void addFinishedGame(const ChessGame* game);
+
+		/*! Returns the number of games in progress. */
+		int activeGameCount() const;
+		/*! Returns the number of finished games. */
+		int finishedGameCount() const;
+
+		/*! Returns the statistics as a map of variants. */
+		QVariant toVariant() const;
+		/*!
+		 * Returns the statistics in the Prometheus text exposition
+		 * format, with metric names starting with "cutechess_".
+		 */
+		QString toPrometheus() const;
+
+	private:
+		struct EngineData
+		{
+			EngineData();
+
+			qint64 moves;
+			qint64 thinkTime;
+			qint64 latencySum;
+			int maxLatency;
+			int timeForfeits;
+			QVector<qint64> latencyHistogram;
+		};
+
+		void addMoves(const QString& name,
+			      const QVector<int>& times,
+			      const QVector<int>& latencies);
+		double elapsedSeconds() const;
+
+		QElapsedTimer m_clock;
+		int m_concurrency;
+		int m_finishedGames;
+		int m_timeForfeits;
+		int m_disconnections;
+		int m_stalledConnections;
+		qint64 m_plies;
+		qint64 m_busyTime;
+		qint64 m_lastFinishTime;
+		QMap<const ChessGame*, qint64> m_startTimes;
+		QMap<QString, EngineData> m_engines;
+};
+
+#endif // TOURNAMENTMETRICS_H
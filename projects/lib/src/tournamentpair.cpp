@@ -29,6 +29,8 @@ TournamentPair::TournamentPair(int firstPlayer,
 	m_first.score = 0;
 	m_second.index = secondPlayer;
 	m_second.score = 0;
+
+	std::fill(m_gamePairs, m_gamePairs + 5, 0);
 }
 
 bool TournamentPair::hasSamePlayers(const TournamentPair* other) const
@@ -134,3 +136,39 @@ void TournamentPair::swapPlayers()
 	std::swap(m_first, m_second);
 	m_hasOriginalOrder = !m_hasOriginalOrder;
 }
+
+int TournamentPair::originalFirstPlayer() const
+{
+	return m_hasOriginalOrder ? m_first.index : m_second.index;
+}
+
+int TournamentPair::addPairGame(int game, int player, int score)
+{
+	Q_ASSERT(game >= 0);
+	Q_ASSERT(score >= 0 && score <= 2);
+
+	// The pairs are stored from the original first player's perspective
+	const bool isFirst = (player == originalFirstPlayer());
+	if (!isFirst)
+		score = 2 - score;
+
+	const int pair = game / 2;
+	auto it = m_pendingPairs.find(pair);
+	if (it == m_pendingPairs.end())
+	{
+		m_pendingPairs.insert(pair, score);
+		return -1;
+	}
+
+	const int sum = it.value() + score;
+	m_pendingPairs.erase(it);
+	m_gamePairs[sum]++;
+
+	return isFirst ? sum : 4 - sum;
+}
+
+int TournamentPair::gamePairCount(int score) const
+{
+	Q_ASSERT(score >= 0 && score <= 4);
+	return m_gamePairs[score];
+}
@@ -19,6 +19,8 @@
 #ifndef TOURNAMENTPAIR_H
 #define TOURNAMENTPAIR_H
 
+#include <QMap>
+
 /*!
  * \brief A single encounter in a tournament
  *
@@ -112,6 +114,26 @@ class LIB_EXPORT TournamentPair
 		 */
 		void swapPlayers();
 
+		/*!
+		 * Adds a finished game to the game pair it belongs to.
+		 *
+		 * \a game is the number of the game in this encounter,
+		 * starting from 0, and \a score is the score (0, 1 or 2) of
+		 * player \a player in the game. Games 0 and 1 form the first
+		 * game pair, games 2 and 3 the second one, and so on.
+		 *
+		 * Returns the combined score (0 to 4) of \a player in the
+		 * game pair if both of its games have finished; otherwise
+		 * returns -1.
+		 */
+		int addPairGame(int game, int player, int score);
+		/*!
+		 * Returns the number of finished game pairs in which the
+		 * combined score of the original first player is \a score
+		 * (0 to 4), ie. the number of LL, LD, DD/WL, WD or WW pairs.
+		 */
+		int gamePairCount(int score) const;
+
 	private:
 		struct Player
 		{
@@ -119,10 +141,14 @@ class LIB_EXPORT TournamentPair
 			int score;
 		};
 
+		int originalFirstPlayer() const;
+
 		Player m_first;
 		Player m_second;
 		int m_gamesStarted;
 		bool m_hasOriginalOrder;
+		QMap<int, int> m_pendingPairs;
+		int m_gamePairs[5];
 };
 
 #endif // TOURNAMENTPAIR_H
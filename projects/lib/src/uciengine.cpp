@@ -85,6 +85,7 @@ QStringRef joinTokens(const QVarLengthArray<QStringRef>& tokens)
 UciEngine::UciEngine(QObject* parent)
 	: ChessEngine(parent),
 	  m_useDirectPv(false),
+	  m_pvKey(0),
 	  m_sendOpponentsName(false),
 	  m_canPonder(false),
 	  m_ponderState(NotPondering),
@@ -141,6 +142,7 @@ void UciEngine::startGame()
 	m_bmBuffer.clear();
 	m_moveStrings.clear();
 	m_useDirectPv = directPvList.contains(board()->variant());
+	m_pvFen.clear();
 
 	if (board()->isRandomVariant())
 		m_startFen = board()->fenString(Chess::Board::ShredderFen);
@@ -407,7 +409,11 @@ void UciEngine::parseInfo(const QVarLengthArray<QStringRef>& tokens,
 		eval->setPvNumber(tokens[0].toString().toInt());
 		break;
 	case InfoPv:
-		eval->setPv(m_useDirectPv ?  directPv(tokens) : sanPv(tokens));
+		if (m_useDirectPv)
+			eval->setPv(directPv(tokens));
+		else
+			eval->setPv(joinTokens(tokens).toString(),
+				    board()->variant(), pvFen());
 		break;
 	case InfoScore:
 		{
@@ -812,44 +818,27 @@ QString UciEngine::directPv(const QVarLengthArray<QStringRef>& tokens)
 	return pv;
 }
 
-QString UciEngine::sanPv(const QVarLengthArray<QStringRef>& tokens)
+QString UciEngine::pvFen()
 {
 	Chess::Board* board = this->board();
-	QString pv;
-	int movesMade = 0;
-
-	if (pondering() && !m_ponderMove.isNull())
-	{
+	const bool ponderMove = pondering() && !m_ponderMove.isNull();
+	if (ponderMove)
 		board->makeMove(m_ponderMove);
-		movesMade++;
-	}
 
-	for (auto token : tokens)
+	// The position only changes between searches, so the FEN string
+	// is shared by all the PVs of a search
+	if (m_pvFen.isEmpty() || board->key() != m_pvKey)
 	{
-		auto move = board->moveFromString(token.toString());
-		if (move.isNull())
-		{
-			QString tokenString(token.toString());
-			qWarning("Illegal PV move %s from %s (%d)",
-				 qUtf8Printable(tokenString),
-				 qUtf8Printable(name()),
-				 id());
-			qWarning("PV: %s %s",
-				 qUtf8Printable(pv),
-				 qUtf8Printable(tokenString));
-			break;
-		}
-		if (!pv.isEmpty())
-			pv += " ";
-		pv += board->moveString(move, Chess::Board::StandardAlgebraic);
-		board->makeMove(move);
-		movesMade++;
+		m_pvKey = board->key();
+		m_pvFen = board->fenString(board->isRandomVariant() ?
+					   Chess::Board::ShredderFen :
+					   Chess::Board::XFen);
 	}
 
-	for (int i = 0; i < movesMade; i++)
+	if (ponderMove)
 		board->undoMove();
 
-	return pv;
+	return m_pvFen;
 }
 
 void UciEngine::sendOption(const QString& name, const QVariant& value)
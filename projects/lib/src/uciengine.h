@@ -79,12 +79,14 @@ class LIB_EXPORT UciEngine : public ChessEngine
 		void sendPosition();
 		void setPonderMove(const QString& moveString);
 		QString directPv(const QVarLengthArray<QStringRef>& tokens);
-		QString sanPv(const QVarLengthArray<QStringRef>& tokens);
+		QString pvFen();
 		
 		QString m_variantOption;
 		QString m_startFen;
 		QString m_moveStrings;
 		bool m_useDirectPv;
+		quint64 m_pvKey;
+		QString m_pvFen;
 		// Write buffer for messages that will be flushed to the engine
 		// after it sends a "bestmove"
 		QStringList m_bmBuffer;
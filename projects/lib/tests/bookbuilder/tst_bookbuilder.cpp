@@ -0,0 +1,163 @@
+#include <QtTest/QtTest>
+#include <QMap>
+#include <QSet>
+#include <QTemporaryDir>
+#include <bookbuilder.h>
+#include <polyglotbook.h>
+#include <pgngame.h>
+#include <pgnstream.h>
+
+class tst_BookBuilder: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void matchesImport();
+		void multiPassMerge();
+		void buildAfterCancel();
+
+	private:
+		QMap<quint16, quint16> entries(const OpeningBook& book,
+					       quint64 key) const;
+
+		QString m_pgnFile;
+		QTemporaryDir m_dir;
+};
+
+// The number of plies imported from every game
+static const int s_depth = 8;
+
+void tst_BookBuilder::initTestCase()
+{
+	m_pgnFile = QStringLiteral(CUTECHESS_TEST_DATA_DIR).append("/games.pgn");
+	QVERIFY(m_dir.isValid());
+}
+
+QMap<quint16, quint16> tst_BookBuilder::entries(const OpeningBook& book,
+						quint64 key) const
+{
+	QMap<quint16, quint16> ret;
+	for (const auto& entry : book.entries(key))
+		ret[PolyglotBook::encodeMove(entry.move)] = entry.weight;
+	return ret;
+}
+
+void tst_BookBuilder::matchesImport()
+{
+	// The reference book is imported and written by OpeningBook
+	QFile file(m_pgnFile);
+	QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+	{
+		PgnStream in(&file);
+		PolyglotBook book;
+		QVERIFY(book.import(in, s_depth) > 0);
+		QVERIFY(book.write(m_dir.filePath("import.bin")));
+	}
+
+	BookBuilder builder(s_depth);
+	builder.setThreadCount(2);
+	builder.addFile(m_pgnFile);
+	QVERIFY(builder.build(m_dir.filePath("builder.bin")));
+	QCOMPARE(builder.gameCount(), 8);
+
+	PolyglotBook reference;
+	QVERIFY(reference.read(m_dir.filePath("import.bin")));
+	PolyglotBook book;
+	QVERIFY(book.read(m_dir.filePath("builder.bin")));
+	QCOMPARE(QFileInfo(m_dir.filePath("builder.bin")).size(),
+		 QFileInfo(m_dir.filePath("import.bin")).size());
+
+	// Compare the moves of every position in the games
+	QVERIFY(file.seek(0));
+	PgnStream in(&file);
+	QSet<quint64> keys;
+	for (;;)
+	{
+		PgnGame game;
+		if (!game.read(in, s_depth))
+			break;
+		for (const PgnGame::MoveData& md : game.moves())
+			keys.insert(md.key);
+	}
+	QVERIFY(keys.size() > 20);
+
+	for (quint64 key : qAsConst(keys))
+		QCOMPARE(entries(book, key), entries(reference, key));
+
+	// 1.e4 won once and drew twice, 1.d4 won once, and the losing
+	// side's 1.f3 isn't in the book
+	const QMap<quint16, quint16> startPos(
+		entries(book, Q_UINT64_C(0x463b96181691fc9c)));
+	QCOMPARE(startPos.size(), 2);
+	QCOMPARE(startPos.values(), QList<quint16>() << 2 << 4);
+}
+
+void tst_BookBuilder::multiPassMerge()
+{
+	// Every game of the file repeated 16 times
+	const int repeats = 16;
+	QFile file(m_pgnFile);
+	QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+	{
+		PolyglotBook book;
+		for (int i = 0; i < repeats; i++)
+		{
+			QVERIFY(file.seek(0));
+			PgnStream in(&file);
+			QVERIFY(book.import(in, s_depth) > 0);
+		}
+		QVERIFY(book.write(m_dir.filePath("import16.bin")));
+	}
+
+	// A one-byte memory limit writes a run for each of the 128
+	// games, so the runs are merged in more than one pass
+	BookBuilder builder(s_depth);
+	builder.setThreadCount(4);
+	builder.setMemoryLimit(1);
+	for (int i = 0; i < repeats; i++)
+		builder.addFile(m_pgnFile);
+	QVERIFY(builder.build(m_dir.filePath("builder16.bin")));
+	QCOMPARE(builder.gameCount(), 8 * repeats);
+
+	QCOMPARE(QFileInfo(m_dir.filePath("builder16.bin")).size(),
+		 QFileInfo(m_dir.filePath("import16.bin")).size());
+	PolyglotBook reference;
+	QVERIFY(reference.read(m_dir.filePath("import16.bin")));
+	PolyglotBook book;
+	QVERIFY(book.read(m_dir.filePath("builder16.bin")));
+
+	QVERIFY(file.seek(0));
+	PgnStream in(&file);
+	for (;;)
+	{
+		PgnGame game;
+		if (!game.read(in, s_depth))
+			break;
+		for (const PgnGame::MoveData& md : game.moves())
+			QCOMPARE(entries(book, md.key), entries(reference, md.key));
+	}
+
+	const QMap<quint16, quint16> startPos(
+		entries(book, Q_UINT64_C(0x463b96181691fc9c)));
+	QCOMPARE(startPos.values(),
+		 QList<quint16>() << 2 * repeats << 4 * repeats);
+}
+
+void tst_BookBuilder::buildAfterCancel()
+{
+	BookBuilder builder(s_depth);
+	builder.cancel();
+
+	// A cancel before the build doesn't affect it
+	builder.addFile(m_pgnFile);
+	QVERIFY(builder.build(m_dir.filePath("cancel.bin")));
+	QCOMPARE(builder.gameCount(), 8);
+
+	builder.addFile(m_pgnFile);
+	QVERIFY(builder.build(m_dir.filePath("cancel.bin")));
+	QCOMPARE(builder.gameCount(), 8);
+}
+
+QTEST_MAIN(tst_BookBuilder)
+#include "tst_bookbuilder.moc"
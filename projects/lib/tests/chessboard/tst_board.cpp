@@ -21,6 +21,9 @@ class tst_Board: public QObject
 		void results_data() const;
 		void results();
 
+		void repetitions_data() const;
+		void repetitions();
+
 		void perft_data() const;
 		void perft();
 
@@ -1023,6 +1026,64 @@ void tst_Board::results()
 	QCOMPARE(m_board->result().toShortString(), result);
 }
 
+void tst_Board::repetitions_data() const
+{
+	QTest::addColumn<QString>("variant");
+	QTest::addColumn<QString>("fen");
+	QTest::addColumn<QString>("moves");
+	QTest::addColumn<int>("repeatCount");
+
+	QString variant = "standard";
+
+	QTest::newRow("knight shuffle")
+		<< variant
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+		<< "Nf3 Nf6 Ng1 Ng8 Nf3 Nf6 Ng1 Ng8"
+		<< 2;
+	QTest::newRow("knight shuffle after pawn move")
+		<< variant
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+		<< "Nf3 Nf6 Ng1 Ng8 e4 e5 Nf3 Nf6 Ng1 Ng8"
+		<< 1;
+	QTest::newRow("fen reversible count")
+		<< variant
+		<< "4k3/8/8/8/8/8/8/4K2R w - - 40 60"
+		<< "Rh2 Kd8 Rh1 Ke8 Rh2 Kd8 Rh1 Ke8"
+		<< 2;
+	QTest::newRow("lost castling rights")
+		<< variant
+		<< "4k3/8/8/8/8/8/8/4K2R w K - 0 1"
+		<< "Rh2 Kd8 Rh1 Ke8"
+		<< 0;
+
+	variant = "crazyhouse";
+	QTest::newRow("crazyhouse knight shuffle")
+		<< variant
+		<< "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR[-] w KQkq - 0 1"
+		<< "Nf3 Nf6 Ng1 Ng8 Nf3 Nf6 Ng1 Ng8"
+		<< 2;
+}
+
+void tst_Board::repetitions()
+{
+	QFETCH(QString, variant);
+	QFETCH(QString, fen);
+	QFETCH(QString, moves);
+	QFETCH(int, repeatCount);
+
+	setVariant(variant);
+	QVERIFY(m_board->setFenString(fen));
+
+	const auto moveList = moves.split(' ', Qt::SkipEmptyParts);
+	for (const auto& moveStr : moveList)
+	{
+		Chess::Move move = m_board->moveFromString(moveStr);
+		QVERIFY(m_board->isLegalMove(move));
+		m_board->makeMove(move);
+	}
+	QCOMPARE(m_board->repeatCount(), repeatCount);
+}
+
 void tst_Board::perft_data() const
 {
 	QTest::addColumn<QString>("variant");
@@ -1052,6 +1113,16 @@ void tst_Board::perft_data() const
 		<< "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -"
 		<< 6
 		<< Q_UINT64_C(11030083);
+	QTest::newRow("pos5")
+		<< variant
+		<< "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+		<< 3
+		<< Q_UINT64_C(62379);
+	QTest::newRow("pos6")
+		<< variant
+		<< "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1"
+		<< 4
+		<< Q_UINT64_C(422333);
 
 	variant = "capablanca";
 	QTest::newRow("gothic startpos")
@@ -1091,6 +1162,11 @@ void tst_Board::perft_data() const
 		<< "2Rnb1kr/5ppp/8/q3p3/p3P3/4P3/6PP/1Q3BKR b Hh - 0 15"
 		<< 3
 		<< Q_UINT64_C(24750);
+	QTest::newRow("frc5")
+		<< variant
+		<< "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9"
+		<< 4
+		<< Q_UINT64_C(326672);
 
 	variant = "atomic";
 	QTest::newRow("atomic startpos")
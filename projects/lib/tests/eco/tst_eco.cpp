@@ -0,0 +1,90 @@
+#include <QtTest/QtTest>
+#include <econode.h>
+#include <pgngame.h>
+#include <pgnstream.h>
+
+class tst_Eco: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void table();
+		void updateEco_data() const;
+		void updateEco();
+};
+
+void tst_Eco::table()
+{
+	QVERIFY(EcoNode::maxPly() > 0);
+	QVERIFY(EcoNode::find(0) == nullptr);
+
+	// 1.e4 from the starting position
+	const EcoNode* node = EcoNode::find(Q_UINT64_C(0x823c9b50fd114196));
+	QVERIFY(node != nullptr);
+	QCOMPARE(node->ecoCode(), QString("B00"));
+	QCOMPARE(node->opening(), QString("King's pawn Opening"));
+	QVERIFY(node->variation().isEmpty());
+	QCOMPARE(node->ply(), 1);
+}
+
+void tst_Eco::updateEco_data() const
+{
+	QTest::addColumn<QByteArray>("fen");
+	QTest::addColumn<QByteArray>("moves");
+	QTest::addColumn<QString>("eco");
+	QTest::addColumn<QString>("opening");
+	QTest::addColumn<QString>("variation");
+
+	QTest::newRow("1.e4")
+		<< QByteArray() << QByteArray("1. e4 *")
+		<< "B00" << "King's pawn Opening" << "";
+	QTest::newRow("sicilian")
+		<< QByteArray() << QByteArray("1. e4 c5 *")
+		<< "B20" << "Sicilian defense" << "";
+	QTest::newRow("najdorf")
+		<< QByteArray()
+		<< QByteArray("1. e4 c5 2. Nf3 d6 3. d4 cxd4 4. Nxd4 Nf6 5. Nc3 a6 *")
+		<< "B90" << "Sicilian" << "Najdorf";
+	QTest::newRow("nimzo-indian")
+		<< QByteArray() << QByteArray("1. d4 Nf6 2. c4 e6 3. Nc3 Bb4 *")
+		<< "E20" << "Nimzo-Indian defense" << "";
+	QTest::newRow("transposition")
+		<< QByteArray() << QByteArray("1. Nf3 d5 2. d4 *")
+		<< "D02" << "Queen's pawn game" << "";
+	QTest::newRow("out of book")
+		<< QByteArray()
+		<< QByteArray("1. e4 e5 2. Nf3 Nc6 3. Bb5 a6 4. Ba4 Nf6 5. h4 *")
+		<< "C77" << "Ruy Lopez" << "Morphy defense";
+	// Only games from the standard starting position are classified
+	QTest::newRow("fen")
+		<< QByteArray("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1")
+		<< QByteArray("1. e4 *")
+		<< "" << "" << "";
+}
+
+void tst_Eco::updateEco()
+{
+	QFETCH(QByteArray, fen);
+	QFETCH(QByteArray, moves);
+	QFETCH(QString, eco);
+	QFETCH(QString, opening);
+	QFETCH(QString, variation);
+
+	QByteArray pgn("[Event \"?\"]\n");
+	if (!fen.isEmpty())
+		pgn += "[FEN \"" + fen + "\"]\n[SetUp \"1\"]\n";
+	pgn += "\n" + moves;
+
+	// PgnGame::read() classifies the game after each move
+	PgnStream in(&pgn);
+	PgnGame game;
+	QVERIFY(game.read(in));
+	QVERIFY(!game.moves().isEmpty());
+
+	QCOMPARE(game.tagValue("ECO"), eco);
+	QCOMPARE(game.tagValue("Opening"), opening);
+	QCOMPARE(game.tagValue("Variation"), variation);
+}
+
+QTEST_MAIN(tst_Eco)
+#include "tst_eco.moc"
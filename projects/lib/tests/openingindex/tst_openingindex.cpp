@@ -0,0 +1,252 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <openingindex.h>
+
+class tst_OpeningIndex: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void initialValues();
+		void epd();
+		void pgn();
+		void pgnComments();
+		void chunks();
+		void rebuild();
+
+	private:
+		QString writeSuite(const QString& name,
+				   const QByteArray& data,
+				   const QDateTime& modified);
+		void verify(const OpeningIndex& index,
+			    const QByteArray& data,
+			    const QVector<qint64>& lines);
+
+		QTemporaryDir m_dir;
+		QDateTime m_time;
+};
+
+static const QByteArray s_epd(
+	"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - id \"e4\";\n"
+	"\n"
+	"rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq - id \"d4\";\r\n"
+	"  rnbqkbnr/pppppppp/8/8/2P5/8/PP1PPPPP/RNBQKBNR b KQkq - id \"c4\";\n"
+	"rnbqkbnr/pppppppp/8/8/8/5N2/PPPPPPPP/RNBQKB1R b KQkq - id \"Nf3\";");
+
+static const QByteArray s_pgn(
+	"[Event \"One\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 e5 *\n"
+	"\n"
+	"[Event \"Two\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. d4 d5\n"
+	"2. c4 *\n"
+	"\n"
+	"\n"
+	"[Event \"Three\"]\n"
+	"1. c4 *\n"
+	"  [Event \"Four\"]\n"
+	"\n"
+	"1. Nf3 *\n");
+
+// Tags inside comments, variations and escaped lines don't begin games
+static const QByteArray s_commentPgn(
+	"[Event \"One\"]\n"
+	"[Site \"{not a comment\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. e4 {A comment\n"
+	"[Event \"Not a game\"]\n"
+	"that spans lines} e5 (1... c5\n"
+	"[Event \"Not a game either\"] (1... e6\n"
+	"[Event \"Nested\"]) 2. Nf3) *\n"
+	"% An escaped line\n"
+	"%[Event \"Escaped\"]\n"
+	"; [Event \"Commented out\"]\n"
+	"[Event \"Two\"]\n"
+	"[Result \"*\"]\n"
+	"\n"
+	"1. d4 d5 {a { nested\n"
+	"[Event \"Inside\"] }\n"
+	"[Event \"Still inside\"] } *\n"
+	"[Event \"Three\"]\n"
+	"1. c4 *\n");
+
+void tst_OpeningIndex::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_time = QDateTime::currentDateTime().addDays(-1);
+}
+
+QString tst_OpeningIndex::writeSuite(const QString& name,
+				     const QByteArray& data,
+				     const QDateTime& modified)
+{
+	const QString fileName(m_dir.filePath(name));
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+	||  file.write(data) != data.size()
+	||  !file.flush()
+	||  !file.setFileTime(modified, QFileDevice::FileModificationTime))
+		return QString();
+	return fileName;
+}
+
+void tst_OpeningIndex::verify(const OpeningIndex& index,
+			      const QByteArray& data,
+			      const QVector<qint64>& lines)
+{
+	QVERIFY(index.isOpen());
+	QCOMPARE(index.count(), lines.size());
+
+	const QList<QByteArray> dataLines(data.split('\n'));
+	for (int i = 0; i < lines.size(); i++)
+	{
+		QCOMPARE(index.lineNumber(i), lines.at(i));
+
+		const int lineIndex = int(lines.at(i) - 1);
+		int pos = 0;
+		for (int j = 0; j < lineIndex; j++)
+			pos += dataLines.at(j).size() + 1;
+
+		// PGN games begin at the tag, EPD lines at the line start
+		int indent = 0;
+		while (data.at(pos + indent) == ' ')
+			indent++;
+		if (data.at(pos + indent) == '[')
+			pos += indent;
+		QCOMPARE(index.pos(i), qint64(pos));
+	}
+}
+
+void tst_OpeningIndex::initialValues()
+{
+	OpeningIndex index;
+	QVERIFY(!index.isOpen());
+	QCOMPARE(index.count(), 0);
+	QCOMPARE(OpeningIndex::indexFileName("suite.epd"),
+		 QString("suite.epd.cci"));
+	QVERIFY(!index.open(m_dir.filePath("missing.epd"),
+			    OpeningSuite::EpdFormat, 1));
+	QVERIFY(!index.isOpen());
+}
+
+void tst_OpeningIndex::epd()
+{
+	const QString fileName(writeSuite("suite.epd", s_epd, m_time));
+	QVERIFY(!fileName.isEmpty());
+
+	OpeningIndex index;
+	QVERIFY(index.open(fileName, OpeningSuite::EpdFormat, 2));
+	verify(index, s_epd, QVector<qint64>() << 1 << 3 << 4 << 5);
+
+	// The header, and a file position and line number per opening
+	const QString indexFile(OpeningIndex::indexFileName(fileName));
+	QCOMPARE(QFileInfo(indexFile).size(), qint64(40 + 4 * 16));
+
+	index.close();
+	QVERIFY(!index.isOpen());
+	QCOMPARE(index.count(), 0);
+}
+
+void tst_OpeningIndex::pgn()
+{
+	const QString fileName(writeSuite("suite.pgn", s_pgn, m_time));
+	QVERIFY(!fileName.isEmpty());
+
+	OpeningIndex index;
+	QVERIFY(index.open(fileName, OpeningSuite::PgnFormat, 1));
+	verify(index, s_pgn, QVector<qint64>() << 1 << 6 << 13 << 15);
+	QCOMPARE(QFileInfo(OpeningIndex::indexFileName(fileName)).size(),
+		 qint64(40 + 4 * 16));
+}
+
+void tst_OpeningIndex::pgnComments()
+{
+	const QString fileName(writeSuite("comments.pgn", s_commentPgn, m_time));
+	QVERIFY(!fileName.isEmpty());
+
+	OpeningIndex index;
+	QVERIFY(index.open(fileName, OpeningSuite::PgnFormat, 1));
+	verify(index, s_commentPgn, QVector<qint64>() << 1 << 13 << 19);
+}
+
+void tst_OpeningIndex::chunks()
+{
+	struct Suite
+	{
+		QString name;
+		QByteArray data;
+		OpeningSuite::Format format;
+		QVector<qint64> lines;
+	};
+	const QVector<Suite> suites = {
+		{ "chunks.epd", s_epd, OpeningSuite::EpdFormat, { 1, 3, 4, 5 } },
+		{ "chunks.pgn", s_pgn, OpeningSuite::PgnFormat, { 1, 6, 13, 15 } },
+		{ "chunks2.pgn", s_commentPgn, OpeningSuite::PgnFormat, { 1, 13, 19 } }
+	};
+
+	// Chunk boundaries at every line, so that games, tags,
+	// comments and variations are split between chunks
+	for (const Suite& suite : suites)
+	{
+		const QString fileName(writeSuite(suite.name, suite.data, m_time));
+		QVERIFY(!fileName.isEmpty());
+		const QString indexFile(OpeningIndex::indexFileName(fileName));
+
+		for (int size = 1; size <= suite.data.size(); size++)
+		{
+			QFile::remove(indexFile);
+
+			OpeningIndex index;
+			index.setMinChunkSize(size);
+			QVERIFY(index.open(fileName, suite.format, 64));
+			verify(index, suite.data, suite.lines);
+		}
+	}
+}
+
+void tst_OpeningIndex::rebuild()
+{
+	const QString fileName(writeSuite("rebuild.epd", s_epd, m_time));
+	QVERIFY(!fileName.isEmpty());
+	const QString indexFile(OpeningIndex::indexFileName(fileName));
+
+	OpeningIndex index;
+	QVERIFY(index.open(fileName, OpeningSuite::EpdFormat, 1));
+	QCOMPARE(index.count(), 4);
+	index.close();
+
+	// An up-to-date sidecar file is used as is
+	QFile file(indexFile);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.seek(40 + 16 + 8));
+	QVERIFY(file.write(QByteArray(8, '\x7f')) == 8);
+	file.close();
+	QVERIFY(index.open(fileName, OpeningSuite::EpdFormat, 1));
+	QCOMPARE(index.lineNumber(1), Q_INT64_C(0x7f7f7f7f7f7f7f7f));
+	index.close();
+
+	// A new modification time with the same size
+	QByteArray data(s_epd);
+	data.replace("\n\n", "\n ");
+	QVERIFY(!writeSuite("rebuild.epd", data, m_time.addSecs(60)).isEmpty());
+	QVERIFY(index.open(fileName, OpeningSuite::EpdFormat, 1));
+	verify(index, data, QVector<qint64>() << 1 << 2 << 3 << 4);
+	index.close();
+
+	// A new size with the same modification time
+	data.append("\n8/8/8/8/8/8/8/K1k5 w - - id \"kings\";\n");
+	QVERIFY(!writeSuite("rebuild.epd", data,
+			    m_time.addSecs(60)).isEmpty());
+	QVERIFY(index.open(fileName, OpeningSuite::EpdFormat, 1));
+	verify(index, data, QVector<qint64>() << 1 << 2 << 3 << 4 << 5);
+	QCOMPARE(QFileInfo(indexFile).size(), qint64(40 + 5 * 16));
+}
+
+QTEST_MAIN(tst_OpeningIndex)
+#include "tst_openingindex.moc"
@@ -0,0 +1,114 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include <pgnpositionindex.h>
+
+class tst_PgnPositionIndex: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void initialValues();
+		void emptyIndex();
+		void find_data() const;
+		void find();
+
+	private:
+		QTemporaryDir m_dir;
+};
+
+void tst_PgnPositionIndex::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+}
+
+void tst_PgnPositionIndex::initialValues()
+{
+	PgnPositionIndex index;
+	QVERIFY(!index.isOpen());
+	QCOMPARE(index.gameCount(), 0);
+	QCOMPARE(index.maxPlies(), 0);
+	QVERIFY(index.find(1234).isEmpty());
+	QVERIFY(!index.open(m_dir.filePath("missing.cpi")));
+	QVERIFY(!index.isOpen());
+}
+
+void tst_PgnPositionIndex::emptyIndex()
+{
+	const QString fileName(m_dir.filePath("empty.cpi"));
+	PgnPositionIndex::Writer writer(fileName);
+	QVERIFY(writer.finish(5, 20));
+
+	PgnPositionIndex index;
+	QVERIFY(index.open(fileName));
+	QCOMPARE(index.gameCount(), 5);
+	QCOMPARE(index.maxPlies(), 20);
+	QVERIFY(index.find(0).isEmpty());
+}
+
+void tst_PgnPositionIndex::find_data() const
+{
+	QTest::addColumn<qint64>("memoryLimit");
+
+	QTest::newRow("in memory") << qint64(1024 * 1024);
+	// Two positions per run need more than one merge pass
+	QTest::newRow("many runs") << qint64(32);
+}
+
+void tst_PgnPositionIndex::find()
+{
+	QFETCH(qint64, memoryLimit);
+
+	const int gameCount = 200;
+	const quint64 bigKey = Q_UINT64_C(0xfedcba9876543210);
+	const QString fileName(m_dir.filePath("positions.cpi"));
+
+	PgnPositionIndex::Writer writer(fileName);
+	writer.setMemoryLimit(memoryLimit);
+	for (int game = gameCount - 1; game >= 0; game--)
+	{
+		// Every game has one common position that is reached
+		// twice, and one position of its own
+		const quint64 key = quint64(game % 7) + 1;
+		writer.addPosition(key, game);
+		writer.addPosition(1000 + game, game);
+		writer.addPosition(key, game);
+		if (game % 50 == 0)
+			writer.addPosition(bigKey, game);
+	}
+	QVERIFY(writer.finish(gameCount, 3));
+
+	PgnPositionIndex index;
+	QVERIFY(index.open(fileName));
+	QVERIFY(index.isOpen());
+	QCOMPARE(index.fileName(), fileName);
+	QCOMPARE(index.gameCount(), gameCount);
+	QCOMPARE(index.maxPlies(), 3);
+
+	// Header, and a key and game index for each unique position
+	QCOMPARE(QFileInfo(fileName).size(), qint64(24 + (2 * 200 + 4) * 12));
+
+	for (int i = 0; i < 7; i++)
+	{
+		QVector<int> games;
+		for (int game = i; game < gameCount; game += 7)
+			games << game;
+		QCOMPARE(index.find(quint64(i) + 1), games);
+	}
+	QCOMPARE(index.find(1000), QVector<int>() << 0);
+	QCOMPARE(index.find(1000 + gameCount - 1),
+		 QVector<int>() << gameCount - 1);
+	QCOMPARE(index.find(bigKey), QVector<int>() << 0 << 50 << 100 << 150);
+
+	QVERIFY(index.find(0).isEmpty());
+	QVERIFY(index.find(8).isEmpty());
+	QVERIFY(index.find(1000 + gameCount).isEmpty());
+	QVERIFY(index.find(Q_UINT64_C(0xffffffffffffffff)).isEmpty());
+
+	index.close();
+	QVERIFY(!index.isOpen());
+	QVERIFY(index.find(1).isEmpty());
+}
+
+QTEST_MAIN(tst_PgnPositionIndex)
+#include "tst_pgnpositionindex.moc"
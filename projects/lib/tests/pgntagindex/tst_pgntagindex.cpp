@@ -0,0 +1,189 @@
+#include <QtTest/QtTest>
+#include <pgntagindex.h>
+#include <pgntagpool.h>
+#include <pgngameentry.h>
+#include <pgngamefilter.h>
+#include <pgnstream.h>
+
+Q_DECLARE_METATYPE(PgnGameFilter)
+
+class tst_PgnTagIndex: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void initialValues();
+		void find_data() const;
+		void find();
+		void readWrite();
+
+	private:
+		QVector<int> scan(const PgnGameFilter& filter) const;
+		QVector<int> search(const PgnTagIndex& index,
+				    const PgnGameFilter& filter) const;
+
+		PgnTagPool m_pool;
+		QVector<PgnGameEntry> m_entries;
+		PgnTagIndex m_index;
+};
+
+void tst_PgnTagIndex::initTestCase()
+{
+	QFile file(QStringLiteral(CUTECHESS_TEST_DATA_DIR).append("/tags.pgn"));
+	QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+
+	PgnStream in(&file);
+	for (;;)
+	{
+		PgnGameEntry entry(&m_pool);
+		if (!entry.read(in))
+			break;
+		m_entries << entry;
+	}
+	QCOMPARE(m_entries.size(), 12);
+
+	m_index.build(m_pool, m_entries);
+}
+
+QVector<int> tst_PgnTagIndex::scan(const PgnGameFilter& filter) const
+{
+	QVector<int> ret;
+	for (int i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries.at(i).match(filter))
+			ret << i;
+	}
+	return ret;
+}
+
+QVector<int> tst_PgnTagIndex::search(const PgnTagIndex& index,
+				     const PgnGameFilter& filter) const
+{
+	// The candidates are checked just like the game list does
+	QVector<int> ret;
+	for (int i : index.find(filter, m_pool))
+	{
+		if (m_entries.at(i).match(filter))
+			ret << i;
+	}
+	return ret;
+}
+
+void tst_PgnTagIndex::initialValues()
+{
+	PgnTagIndex index;
+	QCOMPARE(index.entryCount(), 0);
+	QVERIFY(index.find(PgnGameFilter(), m_pool).isEmpty());
+
+	QCOMPARE(m_index.entryCount(), m_entries.size());
+	m_index.clear();
+	QCOMPARE(m_index.entryCount(), 0);
+	m_index.build(m_pool, m_entries);
+	QCOMPARE(m_index.entryCount(), m_entries.size());
+}
+
+void tst_PgnTagIndex::find_data() const
+{
+	QTest::addColumn<PgnGameFilter>("filter");
+	QTest::addColumn<int>("count");
+
+	PgnGameFilter filter;
+	QTest::newRow("empty") << filter << 12;
+
+	QTest::newRow("pattern") << PgnGameFilter("alph") << 6;
+	QTest::newRow("short pattern") << PgnGameFilter("Om") << 4;
+	QTest::newRow("variant pattern") << PgnGameFilter("ATOMIC") << 2;
+	QTest::newRow("no match") << PgnGameFilter("Kasparov") << 0;
+
+	filter = PgnGameFilter();
+	filter.setEvent("open");
+	QTest::newRow("event") << filter << 6;
+	filter = PgnGameFilter();
+	filter.setSite("wijk");
+	QTest::newRow("site") << filter << 2;
+	filter.setEvent("zee");
+	QTest::newRow("event and site") << filter << 0;
+
+	filter = PgnGameFilter();
+	filter.setPlayer("alpha", Chess::Side::White);
+	QTest::newRow("white player") << filter << 2;
+	filter.setPlayer("alpha", Chess::Side::Black);
+	QTest::newRow("black player") << filter << 4;
+	filter.setPlayer("alpha", Chess::Side());
+	QTest::newRow("any player") << filter << 5;
+	filter.setOpponent("beta");
+	QTest::newRow("player and opponent") << filter << 1;
+	filter.setPlayer("alpha", Chess::Side::Black);
+	filter.setOpponent("ha");
+	QTest::newRow("short opponent") << filter << 2;
+
+	filter = PgnGameFilter();
+	filter.setMinDate(QDate(2020, 1, 2));
+	QTest::newRow("min date") << filter << 6;
+	filter.setMaxDate(QDate(2021, 5, 1));
+	QTest::newRow("date range") << filter << 4;
+	filter.setMinDate(QDate());
+	QTest::newRow("max date") << filter << 8;
+
+	filter = PgnGameFilter();
+	filter.setMinRound(3);
+	QTest::newRow("min round") << filter << 4;
+	filter.setMaxRound(10);
+	QTest::newRow("round range") << filter << 3;
+	filter.setMinRound(0);
+	QTest::newRow("max round") << filter << 8;
+
+	filter = PgnGameFilter();
+	filter.setEvent("Open");
+	filter.setPlayer("beta", Chess::Side());
+	filter.setMinDate(QDate(2020, 1, 1));
+	filter.setMaxRound(1);
+	QTest::newRow("combined") << filter << 1;
+	filter.setResult(PgnGameFilter::WhiteWins);
+	QTest::newRow("result") << filter << 1;
+}
+
+void tst_PgnTagIndex::find()
+{
+	QFETCH(PgnGameFilter, filter);
+	QFETCH(int, count);
+
+	const QVector<int> expected(scan(filter));
+	QCOMPARE(expected.size(), count);
+	QCOMPARE(search(m_index, filter), expected);
+
+	// The candidates are unique and in ascending order
+	const QVector<int> candidates(m_index.find(filter, m_pool));
+	for (int i = 1; i < candidates.size(); i++)
+		QVERIFY(candidates.at(i) > candidates.at(i - 1));
+}
+
+void tst_PgnTagIndex::readWrite()
+{
+	QByteArray data;
+	{
+		QDataStream out(&data, QIODevice::WriteOnly);
+		m_index.write(out);
+	}
+
+	PgnTagIndex index;
+	QDataStream in(data);
+	QVERIFY(index.read(in));
+	QCOMPARE(index.entryCount(), m_entries.size());
+
+	PgnGameFilter filter;
+	filter.setPlayer("alpha", Chess::Side());
+	filter.setMaxDate(QDate(2021, 12, 31));
+	QCOMPARE(search(index, filter), scan(filter));
+	filter = PgnGameFilter("london");
+	QCOMPARE(search(index, filter), scan(filter));
+
+	// A truncated index is rejected
+	QDataStream truncated(data.left(data.size() / 2));
+	QVERIFY(!index.read(truncated));
+	QCOMPARE(index.entryCount(), 0);
+}
+
+QTEST_MAIN(tst_PgnTagIndex)
+#include "tst_pgntagindex.moc"
@@ -72,6 +72,14 @@ void tst_PolyglotBook::startPos()
 
 	entries = this->entries(&book, &board);
 	QCOMPARE(entries, expect);
+
+	// Same test with a memory-mapped book file
+	book = PolyglotBook(OpeningBook::Mapped);
+	QVERIFY(book.read(QStringLiteral(CUTECHESS_TEST_DATA_DIR).append("/book_small.bin")));
+
+	entries = this->entries(&book, &board);
+	QCOMPARE(entries, expect);
+	QVERIFY(book.entries(1234).isEmpty());
 }
 
 QTEST_MAIN(tst_PolyglotBook)
@@ -9,6 +9,8 @@ class tst_Sprt: public QObject
 	private slots:
 		void sprt_data() const;
 		void sprt();
+		void pentanomial_data() const;
+		void pentanomial();
 
 	private:
 		bool fuzzyCompare(double val1, double val2);
@@ -100,5 +102,74 @@ void tst_Sprt::sprt()
 	QVERIFY(fuzzyCompare(status.uBound, ubound));
 }
 
+void tst_Sprt::pentanomial_data() const
+{
+	QTest::addColumn<double>("elo0");
+	QTest::addColumn<double>("elo1");
+	QTest::addColumn<double>("alpha");
+	QTest::addColumn<double>("beta");
+	QTest::addColumn<QList<int>>("pairs");
+	QTest::addColumn<double>("llr");
+	QTest::addColumn<double>("lbound");
+	QTest::addColumn<double>("ubound");
+
+	QTest::newRow("test1")
+		<< 0.0
+		<< 5.0
+		<< 0.05
+		<< 0.05
+		<< (QList<int>() << 100 << 1000 << 2500 << 1100 << 120)
+		<< 2.63
+		<< -2.94
+		<< 2.94;
+
+	QTest::newRow("test2")
+		<< 0.0
+		<< 5.0
+		<< 0.05
+		<< 0.05
+		<< (QList<int>() << 300 << 1200 << 2400 << 1100 << 100)
+		<< -12.58
+		<< -2.94
+		<< 2.94;
+
+	QTest::newRow("test3")
+		<< 0.0
+		<< 5.0
+		<< 0.05
+		<< 0.05
+		<< (QList<int>() << 10 << 50 << 100 << 50 << 10)
+		<< -0.05
+		<< -2.94
+		<< 2.94;
+}
+
+void tst_Sprt::pentanomial()
+{
+	QFETCH(double, elo0);
+	QFETCH(double, elo1);
+	QFETCH(double, alpha);
+	QFETCH(double, beta);
+	QFETCH(QList<int>, pairs);
+	QFETCH(double, llr);
+	QFETCH(double, lbound);
+	QFETCH(double, ubound);
+
+	Sprt sprt;
+	sprt.initialize(elo0, elo1, alpha, beta, Sprt::Pentanomial);
+
+	for (int i = 0; i < pairs.size(); i++)
+	{
+		for (int j = 0; j < pairs.at(i); j++)
+			sprt.addGamePairResult(Sprt::GamePairResult(i));
+		QCOMPARE(sprt.gamePairCount(Sprt::GamePairResult(i)), pairs.at(i));
+	}
+
+	Sprt::Status status = sprt.status();
+	QVERIFY(fuzzyCompare(status.llr, llr));
+	QVERIFY(fuzzyCompare(status.lBound, lbound));
+	QVERIFY(fuzzyCompare(status.uBound, ubound));
+}
+
 QTEST_MAIN(tst_Sprt)
 #include "tst_sprt.moc"
@@ -0,0 +1,109 @@
+#include <QtTest/QtTest>
+#include <QtMath>
+#include <spsatournament.h>
+#include <gamemanager.h>
+
+class TestSpsaTournament: public SpsaTournament
+{
+	public:
+		TestSpsaTournament(GameManager* gameManager)
+			: SpsaTournament(gameManager)
+		{
+		}
+
+		using SpsaTournament::initializePairing;
+		using SpsaTournament::perturbation;
+		using SpsaTournament::learningRate;
+		using SpsaTournament::step;
+};
+
+class tst_SpsaTournament: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initialValues();
+		void gainSchedule();
+		void step();
+		void stepBounds();
+
+	private:
+		GameManager m_gameManager;
+};
+
+void tst_SpsaTournament::initialValues()
+{
+	TestSpsaTournament spsa(&m_gameManager);
+	spsa.addParameter("Foo", 300, 0, 200, 10);
+	spsa.addParameter("Bar", 50, 0, 200, 10);
+
+	QCOMPARE(spsa.type(), QString("spsa"));
+	QCOMPARE(spsa.parameterCount(), 2);
+	QCOMPARE(spsa.parameterValues().value("Foo").toDouble(), 200.0);
+	QCOMPARE(spsa.parameterValues().value("Bar").toDouble(), 50.0);
+}
+
+void tst_SpsaTournament::gainSchedule()
+{
+	TestSpsaTournament spsa(&m_gameManager);
+	spsa.addParameter("Foo", 100, 0, 200, 10, 0.002);
+	spsa.setGamesPerEncounter(2);
+	spsa.setRoundMultiplier(100);
+	spsa.initializePairing();
+
+	// N = 100 iterations and stability constant A = 0.1 * N
+	const double n = 100.0;
+	const double a = 0.1 * n;
+	const double c = 10.0 * qPow(n, 0.101);
+	const double r = 0.002 * 10.0 * 10.0 * qPow(a + n, 0.602);
+
+	QCOMPARE(spsa.perturbation(0, 1), c);
+	QCOMPARE(spsa.perturbation(0, 50), c / qPow(50, 0.101));
+	QCOMPARE(spsa.learningRate(0, 1), r / qPow(a + 1, 0.602));
+	QCOMPARE(spsa.learningRate(0, 50), r / qPow(a + 50, 0.602));
+
+	// The last iteration uses the given end values
+	QCOMPARE(spsa.perturbation(0, 100), 10.0);
+	QCOMPARE(spsa.learningRate(0, 100), 0.002 * 10.0 * 10.0);
+}
+
+void tst_SpsaTournament::step()
+{
+	TestSpsaTournament spsa(&m_gameManager);
+	spsa.addParameter("Foo", 100, 0, 200, 10);
+	spsa.addParameter("Bar", 100, 0, 200, 10);
+	spsa.setGamesPerEncounter(2);
+	spsa.setRoundMultiplier(100);
+	spsa.initializePairing();
+
+	const double ck = spsa.perturbation(0, 1);
+	const double ak = spsa.learningRate(0, 1);
+	QVERIFY(ck > 0.0);
+	QVERIFY(ak > 0.0);
+
+	// The plus player won the pair 1.5-0.5
+	spsa.step(1, QVector<int>() << 1 << -1, 1);
+	QVariantMap values(spsa.parameterValues());
+	QCOMPARE(values.value("Foo").toDouble(), 100.0 + ak / ck);
+	QCOMPARE(values.value("Bar").toDouble(), 100.0 - ak / ck);
+
+	// A drawn pair keeps the parameters
+	spsa.step(2, QVector<int>() << 1 << 1, 0);
+	QCOMPARE(spsa.parameterValues(), values);
+}
+
+void tst_SpsaTournament::stepBounds()
+{
+	TestSpsaTournament spsa(&m_gameManager);
+	spsa.addParameter("Foo", 100, 90, 110, 10, 1.0);
+	spsa.setGamesPerEncounter(2);
+	spsa.initializePairing();
+
+	spsa.step(1, QVector<int>() << 1, 2);
+	QCOMPARE(spsa.parameterValues().value("Foo").toDouble(), 110.0);
+	spsa.step(1, QVector<int>() << 1, -2);
+	QCOMPARE(spsa.parameterValues().value("Foo").toDouble(), 90.0);
+}
+
+QTEST_MAIN(tst_SpsaTournament)
+#include "tst_spsatournament.moc"
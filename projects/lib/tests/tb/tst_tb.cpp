@@ -113,9 +113,22 @@ void tst_Tb::positions()
 
 	QVERIFY(m_board.setFenString(fen));
 	
+	// Result without distance to zero on a cold cache, read from
+	// the WDL tables
+	const quint64 misses = SyzygyTablebase::cacheMisses();
+	QCOMPARE(m_board.tablebaseResult().toShortString(), result);
+	if (result != "*")
+		QCOMPARE(SyzygyTablebase::cacheMisses(), misses + 1);
+
 	unsigned int tbDtz = 0;
 	QCOMPARE(m_board.tablebaseResult(&tbDtz).toShortString(), result);
 	QCOMPARE(int(tbDtz), dtz);
+
+	// Result without distance to zero, found in the cache
+	const quint64 hits = SyzygyTablebase::cacheHits();
+	QCOMPARE(m_board.tablebaseResult().toShortString(), result);
+	if (result != "*")
+		QCOMPARE(SyzygyTablebase::cacheHits(), hits + 1);
 }
 
 QTEST_MAIN(tst_Tb)
@@ -0,0 +1,199 @@
+#include <QtTest/QtTest>
+#include <tournamentmetrics.h>
+#include <chessgame.h>
+#include <chessplayer.h>
+#include <pgngame.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+class MockPlayer: public ChessPlayer
+{
+	Q_OBJECT
+
+	public:
+		MockPlayer(const QString& name,
+			   const QStringList& moves,
+			   int latency = 0)
+			: m_moves(moves),
+			  m_latency(latency)
+		{
+			setState(Idle);
+			setName(name);
+		}
+
+		virtual void endGame(const Chess::Result& result)
+		{
+			ChessPlayer::endGame(result);
+			setState(Idle);
+		}
+		virtual void makeMove(const Chess::Move& move)
+		{
+			Q_UNUSED(move);
+		}
+		virtual bool supportsVariant(const QString& variant) const
+		{
+			Q_UNUSED(variant);
+			return true;
+		}
+		virtual bool isHuman() const
+		{
+			return false;
+		}
+
+	protected:
+		virtual void startGame()
+		{
+		}
+		virtual void startThinking()
+		{
+			QTimer::singleShot(0, this, SLOT(reply()));
+		}
+
+	private slots:
+		// Plays the next scripted move, or loses on time when
+		// the script runs out
+		void reply()
+		{
+			if (m_moves.isEmpty())
+			{
+				forfeit(Chess::Result::Timeout);
+				return;
+			}
+			if (m_latency > 0)
+			{
+				QTest::qSleep(m_latency);
+				stampMoveRequest();
+				stampMoveReply();
+			}
+			emitMove(board()->moveFromString(m_moves.takeFirst()));
+		}
+
+	private:
+		QStringList m_moves;
+		int m_latency;
+};
+
+class tst_TournamentMetrics: public QObject
+{
+	Q_OBJECT
+
+	private slots:
+		void initTestCase();
+		void prometheus();
+
+	private:
+		void playGame(TournamentMetrics& metrics,
+			      ChessPlayer* white,
+			      ChessPlayer* black);
+};
+
+void tst_TournamentMetrics::initTestCase()
+{
+	qRegisterMetaType<Chess::Result>("Chess::Result");
+}
+
+void tst_TournamentMetrics::playGame(TournamentMetrics& metrics,
+				     ChessPlayer* white,
+				     ChessPlayer* black)
+{
+	PgnGame pgn;
+	ChessGame game(Chess::BoardFactory::create("standard"), &pgn);
+	game.setPlayer(Chess::Side::White, white);
+	game.setPlayer(Chess::Side::Black, black);
+	game.setTimeControl(TimeControl("inf"));
+
+	QSignalSpy spy(&game, SIGNAL(finished(ChessGame*, Chess::Result)));
+	metrics.addStartedGame(&game);
+	game.start();
+	QVERIFY(spy.count() == 1 || spy.wait(5000));
+	metrics.addFinishedGame(&game);
+}
+
+void tst_TournamentMetrics::prometheus()
+{
+	// The engine name needs escaping in label values
+	const QString fast("Fast \"A\"\\");
+	const QString fastLabel("engine=\"Fast \\\"A\\\"\\\\\"");
+	const QString slowLabel("engine=\"Slow\"");
+
+	TournamentMetrics metrics;
+	metrics.start(2);
+
+	// Fool's mate, the slow engine answers 5 ms after the request
+	MockPlayer fast1(fast, QStringList() << "f3" << "g4");
+	MockPlayer slow1("Slow", QStringList() << "e5" << "Qh4", 5);
+	playGame(metrics, &fast1, &slow1);
+
+	// One move each before the other side loses on time
+	MockPlayer slow2("Slow", QStringList() << "e4", 5);
+	MockPlayer fast2(fast, QStringList());
+	playGame(metrics, &slow2, &fast2);
+	MockPlayer fast3(fast, QStringList() << "e4");
+	MockPlayer slow3("Slow", QStringList(), 5);
+	playGame(metrics, &fast3, &slow3);
+
+	QCOMPARE(metrics.finishedGameCount(), 3);
+	QCOMPARE(metrics.activeGameCount(), 0);
+
+	const QStringList lines(metrics.toPrometheus().split('\n',
+							     Qt::SkipEmptyParts));
+	QMap<QString, double> samples;
+	QMap<QString, QVector<double>> buckets;
+	for (const QString& line : lines)
+	{
+		if (line.startsWith('#'))
+			continue;
+		const int i = line.lastIndexOf(' ');
+		QVERIFY(i > 0);
+		const QString name(line.left(i));
+		const double value = line.mid(i + 1).toDouble();
+		samples.insert(name, value);
+
+		const QString prefix("cutechess_engine_move_latency_seconds_bucket{");
+		if (name.startsWith(prefix))
+			buckets[name.mid(prefix.size()).section(",le=", 0, 0)]
+				<< value;
+	}
+
+	QVERIFY(lines.contains("# TYPE cutechess_engine_move_latency_seconds "
+			       "histogram"));
+	QCOMPARE(samples.value("cutechess_games_finished_total"), 3.0);
+	QCOMPARE(samples.value("cutechess_games_active"), 0.0);
+	QCOMPARE(samples.value("cutechess_concurrency"), 2.0);
+	QCOMPARE(samples.value("cutechess_plies_total"), 6.0);
+	QCOMPARE(samples.value(
+		 "cutechess_abnormal_results_total{type=\"timeout\"}"), 2.0);
+	QCOMPARE(samples.value(
+		 "cutechess_abnormal_results_total{type=\"disconnection\"}"), 0.0);
+
+	for (const QString& label : {fastLabel, slowLabel})
+	{
+		const QString engine('{' + label + '}');
+		QCOMPARE(samples.value("cutechess_engine_moves_total" + engine),
+			 3.0);
+		QCOMPARE(samples.value("cutechess_engine_time_forfeits_total"
+				       + engine), 1.0);
+		QCOMPARE(samples.value("cutechess_engine_move_latency_seconds_count"
+				       + engine), 3.0);
+
+		// The buckets are cumulative and end with the "+Inf" bucket
+		const QVector<double> counts(buckets.value(label));
+		QCOMPARE(counts.size(), 11);
+		for (int i = 1; i < counts.size(); i++)
+			QVERIFY(counts.at(i) >= counts.at(i - 1));
+		QCOMPARE(counts.last(), 3.0);
+	}
+
+	// Moves without transport stamps have no latency at all
+	QCOMPARE(samples.value("cutechess_engine_move_latency_seconds_bucket{"
+			       + fastLabel + ",le=\"0.0001\"}"), 3.0);
+	QCOMPARE(samples.value("cutechess_engine_move_latency_seconds_bucket{"
+			       + slowLabel + ",le=\"0.0025\"}"), 0.0);
+	QCOMPARE(samples.value("cutechess_engine_move_latency_seconds_bucket{"
+			       + slowLabel + ",le=\"+Inf\"}"), 3.0);
+	QVERIFY(samples.value("cutechess_engine_move_latency_seconds_sum{"
+			      + slowLabel + '}') >= 0.015);
+}
+
+QTEST_MAIN(tst_TournamentMetrics)
+#include "tst_tournamentmetrics.moc"
@@ -13,6 +13,7 @@ class tst_TournamentPair: public QObject
 		void hasSamePlayers();
 		void gameStats();
 		void swapPlayers();
+		void gamePairs();
 };
 
 void tst_TournamentPair::initialValues()
@@ -119,5 +120,20 @@ void tst_TournamentPair::swapPlayers()
 	QCOMPARE(pair.secondPlayer(), 1);
 }
 
+void tst_TournamentPair::gamePairs()
+{
+	TournamentPair pair(1, 2);
+	QCOMPARE(pair.addPairGame(0, 1, 2), -1);
+	pair.swapPlayers();
+	QCOMPARE(pair.addPairGame(1, 2, 2), 2);
+	QCOMPARE(pair.gamePairCount(2), 1);
+
+	pair.swapPlayers();
+	QCOMPARE(pair.addPairGame(3, 2, 0), -1);
+	QCOMPARE(pair.addPairGame(2, 1, 1), 3);
+	QCOMPARE(pair.gamePairCount(3), 1);
+	QCOMPARE(pair.gamePairCount(4), 0);
+}
+
 QTEST_MAIN(tst_TournamentPair)
 #include "tst_tournamentpair.moc"
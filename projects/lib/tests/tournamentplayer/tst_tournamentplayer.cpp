@@ -13,10 +13,12 @@ class MockOpeningBook: public OpeningBook
 			Entry entry;
 			return entry;
 		}
-		virtual void writeEntry(const Map::const_iterator& it,
+		virtual void writeEntry(quint64 key,
+					const Entry& entry,
 					QDataStream& out) const
 		{
-			Q_UNUSED(it);
+			Q_UNUSED(key);
+			Q_UNUSED(entry);
 			Q_UNUSED(out);
 		}
 		virtual int entrySize() const
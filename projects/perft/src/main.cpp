@@ -0,0 +1,217 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QTime>
+#include <QVariantMap>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+#include <mersenne.h>
+#include <jsonserializer.h>
+#include <board/board.h>
+#include <board/boardfactory.h>
+
+namespace {
+
+quint64 perft(Chess::Board* board, int depth)
+{
+	const auto moves = board->legalMoves();
+	if (depth <= 1 || moves.isEmpty())
+		return moves.size();
+
+	quint64 nodeCount = 0;
+	for (const auto& move : moves)
+	{
+		board->makeMove(move);
+		nodeCount += perft(board, depth - 1);
+		board->undoMove();
+	}
+
+	return nodeCount;
+}
+
+quint64 perftRoot(const Chess::Board* board,
+		  const Chess::Move& move,
+		  int depth)
+{
+	if (depth <= 1)
+		return 1;
+
+	Chess::Board* tmp = board->copy();
+	tmp->makeMove(move);
+	quint64 nodeCount = perft(tmp, depth - 1);
+	delete tmp;
+
+	return nodeCount;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName("cutechess-perft");
+	QCoreApplication::setApplicationVersion(CUTECHESS_VERSION);
+
+	Mersenne::initialize(QTime(0,0,0).msecsTo(QTime::currentTime()));
+
+	QCommandLineParser parser;
+	parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+	parser.setApplicationDescription(
+		"Counts the leaf nodes of the legal move tree of a position.");
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addOptions({
+		{ "variant", "Use chess variant <name>. The default is standard.",
+		  "name", "standard" },
+		{ "fen", "Start from position <fen>. The default is the "
+			 "variant's starting position.", "fen" },
+		{ "depth", "Search to depth <n> plies. The default is 4.",
+		  "n", "4" },
+		{ "threads", "Split the root moves between <n> threads. "
+			     "The default is the number of CPU cores.", "n" },
+		{ "divide", "Print the node count of each root move." },
+		{ "json", "Print the results in JSON format." },
+		{ "variants", "List the supported chess variants and exit." }
+	});
+	parser.process(app);
+
+	QTextStream out(stdout);
+
+	if (parser.isSet("variants"))
+	{
+		const auto variants = Chess::BoardFactory::variants();
+		for (const QString& variant : variants)
+			out << variant << '\n';
+		return 0;
+	}
+
+	const QString variant = parser.value("variant");
+	Chess::Board* board = Chess::BoardFactory::create(variant);
+	if (board == nullptr)
+	{
+		qWarning() << "Unknown chess variant:" << variant;
+		return 1;
+	}
+
+	QString fen = parser.value("fen");
+	if (fen.isEmpty())
+		fen = board->defaultFenString();
+	if (!board->setFenString(fen))
+	{
+		qWarning() << "Invalid FEN string:" << fen;
+		delete board;
+		return 1;
+	}
+
+	bool ok = false;
+	const int depth = parser.value("depth").toInt(&ok);
+	if (!ok || depth < 1)
+	{
+		qWarning() << "Invalid depth:" << parser.value("depth");
+		delete board;
+		return 1;
+	}
+
+	int threads = QThread::idealThreadCount();
+	if (parser.isSet("threads"))
+	{
+		threads = parser.value("threads").toInt(&ok);
+		if (!ok || threads < 1)
+		{
+			qWarning() << "Invalid thread count:"
+				   << parser.value("threads");
+			delete board;
+			return 1;
+		}
+	}
+	QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+	const auto moves = board->legalMoves();
+	QStringList moveStrings;
+	for (const auto& move : moves)
+		moveStrings << board->moveString(move, Chess::Board::LongAlgebraic);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QVector< QFuture<quint64> > futures;
+	for (const auto& move : moves)
+		futures << QtConcurrent::run(perftRoot, board, move, depth);
+
+	quint64 nodeCount = 0;
+	QVariantList divide;
+	for (int i = 0; i < futures.size(); i++)
+	{
+		quint64 nodes = futures[i].result();
+		nodeCount += nodes;
+
+		QVariantMap entry;
+		entry["move"] = moveStrings.at(i);
+		entry["nodes"] = nodes;
+		divide << entry;
+	}
+
+	const qint64 nsecs = qMax(timer.nsecsElapsed(), qint64(1));
+	const quint64 nps = quint64(double(nodeCount) * 1e9 / nsecs);
+	delete board;
+
+	if (parser.isSet("json"))
+	{
+		QVariantMap result;
+		result["variant"] = variant;
+		result["fen"] = fen;
+		result["depth"] = depth;
+		result["threads"] = threads;
+		result["nodes"] = nodeCount;
+		result["time_ms"] = nsecs / 1000000;
+		result["nps"] = nps;
+		if (parser.isSet("divide"))
+			result["divide"] = divide;
+
+		JsonSerializer serializer(result);
+		if (!serializer.serialize(out))
+		{
+			qWarning() << serializer.errorString();
+			return 1;
+		}
+		return 0;
+	}
+
+	if (parser.isSet("divide"))
+	{
+		for (const QVariant& entry : qAsConst(divide))
+		{
+			const QVariantMap map = entry.toMap();
+			out << map["move"].toString() << ": "
+			    << map["nodes"].toULongLong() << '\n';
+		}
+		out << '\n';
+	}
+
+	out << "Nodes: " << nodeCount << '\n'
+	    << "Time: " << QString::number(nsecs / 1e9, 'f', 3) << " s\n"
+	    << "NPS: " << nps << '\n';
+
+	return 0;
+}
@@ -0,0 +1,66 @@
+/*
+    This file is part of Cute Chess.
+
+    Cute Chess is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Cute Chess is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Cute Chess.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+   A command-line tool for generating the ECO table (eco.bin) of the
+   cutechess library from a PGN collection of openings.
+
+   Every game in the collection is one opening: its moves lead to the
+   opening position, and the "ECO", "Opening" and "Variation" tags name
+   it. The source collection is projects/lib/res/eco/eco.pgn, so the
+   table is regenerated with:
+
+     ecogen projects/lib/res/eco/eco.pgn projects/lib/res/eco/eco.bin
+*/
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <econode.h>
+#include <pgnstream.h>
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	const QStringList args(app.arguments());
+	if (args.size() != 3)
+	{
+		QTextStream(stderr) << "Usage: ecogen <input.pgn> <output.bin>\n";
+		return 1;
+	}
+
+	QFile input(args.at(1));
+	if (!input.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning("Could not open file %s", qUtf8Printable(args.at(1)));
+		return 1;
+	}
+
+	PgnStream in(&input);
+	EcoNode::initialize(in);
+
+	// EcoNode::write() leaves the output alone if the table is empty
+	QFile::remove(args.at(2));
+	EcoNode::write(args.at(2));
+	if (!QFile::exists(args.at(2)))
+		return 1;
+
+	return 0;
+}